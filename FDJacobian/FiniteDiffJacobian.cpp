@@ -138,6 +138,85 @@ void FiniteDiffJacobian::calcJacobian(double tres, double alpha,
   copyIndices(jacColPtrs, jacRowIndices);
 }
 
+void FiniteDiffJacobian::calcJacobianBatch(double tres, double alpha,
+  double beta, N_Vector uu, N_Vector up, N_Vector r,
+  BatchResFn rf, void *userData, SparseMat &jac)
+{
+  jac.resize(neq, neq);
+  jac.reserve(nnz);
+  calcJacobianBatch(tres, alpha, beta, uu, up, r, rf, userData,
+    jac.valuePtr(), jac.outerIndexPtr(), jac.innerIndexPtr());
+  jac.resizeNonZeros(nnz);
+}
+
+void FiniteDiffJacobian::calcJacobianBatch(double tres, double alpha,
+  double beta, N_Vector uu, N_Vector up, N_Vector r,
+  BatchResFn rf, void *userData, SparseMap &jac)
+{
+  calcJacobianBatch(tres, alpha, beta, uu, up, r, rf, userData,
+    jac.valuePtr(), jac.outerIndexPtr(), jac.innerIndexPtr());
+}
+
+void FiniteDiffJacobian::calcJacobianBatch(double tres, double alpha,
+  double beta, N_Vector uu, N_Vector up, N_Vector r,
+  BatchResFn rFunc, void *userData, double *jacVals,
+  int *jacColPtrs, int *jacRowIndices)
+{
+  typedef Eigen::Map<Eigen::VectorXd> MapVec;
+  MapVec u0(NV_DATA_S(uu), neq);
+  MapVec up0(NV_DATA_S(up), neq);
+  MapVec resvec(NV_DATA_S(r), neq);
+  MapVec jacData(jacVals, nnz);
+
+  // column zero is the unperturbed state, followed by one column
+  // for each group perturbing u and then one for each perturbing up
+  const int numU = alpha ? maxgrp : 0, numUp = beta ? maxgrp : 0;
+  const int numCols = 1 + numU + numUp;
+  Eigen::MatrixXd U(neq, numCols), UP(neq, numCols), D(neq, numCols);
+  U.colwise() = u0;
+  UP.colwise() = up0;
+  D.setZero();
+  for (int j = 0; j < neq; j++) {
+    int g = ngrp[j];
+    if (numU) {
+      D(j, g) = stepLen(u0[j]);
+      U(j, g) += D(j, g);
+    }
+    if (numUp) {
+      int c = numU + g;
+      D(j, c) = stepLen(up0[j]);
+      UP(j, c) += D(j, c);
+    }
+  }
+
+  Eigen::MatrixXd R(neq, numCols);
+  rFunc(tres, numCols, U.data(), UP.data(), R.data(), userData);
+  resvec = R.col(0);
+
+  Eigen::VectorXd fjacd(neq), fjac(nnz);
+  const int col = 1;
+  jacData.setZero();
+  if (numU) {
+    for (int numgrp = 1; numgrp <= maxgrp; numgrp++) {
+      fjacd = R.col(numgrp) - R.col(0);
+      fdjs_(&neq, &neq, &col, indrow.data(), jpntr.data(), ngrp.data(),
+        &numgrp, D.col(numgrp).data(), fjacd.data(), fjac.data());
+    }
+    jacData = alpha * fjac;
+  }
+  if (numUp) {
+    for (int numgrp = 1; numgrp <= maxgrp; numgrp++) {
+      int c = numU + numgrp;
+      fjacd = R.col(c) - R.col(0);
+      fdjs_(&neq, &neq, &col, indrow.data(), jpntr.data(), ngrp.data(),
+        &numgrp, D.col(c).data(), fjacd.data(), fjac.data());
+    }
+    jacData += beta * fjac;
+  }
+
+  copyIndices(jacColPtrs, jacRowIndices);
+}
+
 void FiniteDiffJacobian::calcJacobianCD(double tres, double alpha,
   double beta, N_Vector uu, N_Vector up, N_Vector r,
   IDAResFn rFunc, void *userData, double *jacVals,
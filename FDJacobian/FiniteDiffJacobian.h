@@ -23,6 +23,9 @@ class FiniteDiffJacobian {
 public:
   typedef Eigen::SparseMatrix<double> SparseMat;
   typedef Eigen::Map<SparseMat> SparseMap;
+  // residual for numCols (u, up) pairs stored column-wise in u and up
+  typedef void (*BatchResFn)(double t, int numCols, const double *u,
+    const double *up, double *r, void *userData);
   FiniteDiffJacobian(SparseMat &jacPattern);
   ~FiniteDiffJacobian();
   void calcJacobian(double tres, double alpha, double beta,
@@ -31,11 +34,23 @@ public:
   void calcJacobian(double tres, double alpha, double beta,
     N_Vector uu, N_Vector up, N_Vector r,
     IDAResFn rf, void *userData, SparseMap &jac, bool useCD = false);
+  // same as calcJacobian but the base and all perturbed residuals
+  // are calculated in a single call to rf
+  void calcJacobianBatch(double tres, double alpha, double beta,
+    N_Vector uu, N_Vector up, N_Vector r,
+    BatchResFn rf, void *userData, SparseMat &Jac);
+  void calcJacobianBatch(double tres, double alpha, double beta,
+    N_Vector uu, N_Vector up, N_Vector r,
+    BatchResFn rf, void *userData, SparseMap &jac);
 private:
   void calcJacobian(double tres, double alpha,
     double beta, N_Vector uu, N_Vector up, N_Vector r,
     IDAResFn rf, void *userData, double *jacData, 
     int *jacColPtrs, int *jacRowIndices);
+  void calcJacobianBatch(double tres, double alpha,
+    double beta, N_Vector uu, N_Vector up, N_Vector r,
+    BatchResFn rf, void *userData, double *jacData,
+    int *jacColPtrs, int *jacRowIndices);
   void calcJacobianCD(double tres, double alpha,
     double beta, N_Vector uu, N_Vector up, N_Vector r,
     IDAResFn rf, void *userData, double *jacData,
@@ -10,6 +10,62 @@
 %                           odeFunc, odeIcFunc,xOde)
 % [solution,odeSolution] = pde1d(m,pdeFunc,icFunc,bcFunc,meshPts,timePts,...
 %                           odeFunc, odeIcFunc,xOde,options)
+% solution = pde1d(m,libPath,meshPts,timePts)
+% solution = pde1d(m,libPath,meshPts,timePts,options)
+% solution = pde1d(m,defnStruct,meshPts,timePts)
+% solution = pde1d(m,defnStruct,meshPts,timePts,options)
+%
+% Compiled problem definitions:
+% When the second argument is the path to a shared library, the PDE, initial
+% conditions, boundary conditions, and optional ODE and events are evaluated
+% by native functions in that library instead of interpreted functions. The
+% library implements the C interface defined in PDE1dPlugin.h; see
+% tests/ExampleHeatCondPlugin.cpp for an example. The outputs are the same
+% as for the standard form.
+%
+% Problems defined by expressions:
+% When the second argument is a struct, the coefficients, boundary conditions,
+% and initial conditions are strings that are compiled and evaluated
+% without calling interpreted functions. Fields c, f, s, ic, pl, ql, pr, and
+% qr are each a cell array with one string per PDE (or a string if there
+% is one PDE). The optional params field is a struct of named scalar
+% values that may be used in the expressions. Coefficient expressions may
+% reference x, t, u1..uN, and dudx1..dudxN (u and dudx when N is one);
+% p may reference x, t, and u1..uN; q, x and t; ic, only x. Operators and
+% functions follow MATLAB syntax: + - * / ^ .* ./ .^ < > <= >= == ~=,
+% sin cos tan asin acos atan sinh cosh tanh exp log log10 sqrt abs floor
+% ceil sign atan2 min max, and the constants pi and e. For example,
+%   defn = struct('c','1','f','k*dudx','s','0','ic','0',...
+%     'pl','u-10','ql','0','pr','0','qr','1','params',struct('k',10));
+%   u = pde1d(0,defn,linspace(0,1,21),linspace(0,.05,5));
+% The optional tables field is a struct of named tables, e.g. a material
+% property measured at a set of temperatures. Each table is a struct with
+% grid vector x and values v; for a table of two variables, also grid
+% vector y with v(i,j) the value at (x(i),y(j)). The optional method field
+% is 'linear' (default) or 'pchip' (monotone piecewise cubic). A table is
+% called like a function with one or two arguments; values outside the
+% grid are those at the nearest end. For example,
+%   defn.tables = struct('k',struct('x',[0 50 100],'v',[10 12 17]));
+%   defn.f = 'k(u)*dudx';
+%
+% Incremental solution (e.g. co-simulation with another model):
+% h = pde1d('init',m,pdeFunc,icFunc,bcFunc,meshPts,timePts,...)
+% [u,uOde,t] = pde1d('advance',h,tNext)
+% [u,uOde,t] = pde1d('advance',h,tNext,stopAtTNext)
+% [u,uOde,t] = pde1d('state',h)
+% pde1d('set',h,funcName,funcHandle)
+% pde1d('reinit',h)
+% pde1d('delete',h)
+% The 'init' command takes the same arguments as the standard form
+% (timePts needs only the start and end times) and returns a handle
+% to a solution that persists between calls. 'advance' integrates from the
+% current time to tNext and returns the Mx x N solution, the ODE solution,
+% and the time reached; t is less than tNext if a terminal event occurred.
+% If stopAtTNext is true, the integrator does not step past tNext.
+% 'set' replaces 'pdeFunc', 'bcFunc', or 'odeFunc'; the integrator is
+% restarted at the current time before the next step. 'reinit' forces
+% such a restart, e.g. after an input to one of the functions changes
+% discontinuously. 'delete' frees the solution.
 %
 % Equations and Boundary Conditions:
 % The PDE to be solved are expressed in the following form:
@@ -104,11 +160,162 @@
 % options- name=value pairs to change default values for the solver.
 %          RelTol=1e-3, relative tolerance for converged solution
 %          AbsTol=1e-6, absolute tolerance for converged solution
-%          Vectorized=false, if set to true, pdeFunc is called with a vector
+%          Vectorized="Off", if set to "On", pdeFunc is called with a vector
 %                     of x-values and is expected to return values of c, f, and s
-%                     for all of these x-values. Setting this option to true
-%                     substantially improves performance.
+%                     for all of these x-values. Setting this option to "On"
+%                     substantially improves performance. With "Auto", pdeFunc
+%                     is called once with a few x-values and once at each
+%                     of them before the solution starts; the vectorized
+%                     calls are used if the results agree. The choice is
+%                     printed when Stats is "On". "Auto" should not be used
+%                     when pdeFunc has side effects.
+%                     "Off" always calls pdeFunc with a single x-value.
+%          BatchJacobian=false, if set to "On" and Vectorized is "On", the
+%                     finite difference Jacobian is calculated with a single
+%                     call to pdeFunc. The unperturbed and all perturbed
+%                     solutions are passed as additional columns of x, u,
+%                     and DuDx. bcFunc is called only for perturbations that
+%                     change the boundary values. Ignored when ODE are
+%                     included.
 %          MaxSteps=10000, maximum number of time steps allowed
+%          MaxOrder=5, maximum order of the BDF time integration method
+%          InitialStep, size of the first time step; by default it is
+%                      chosen by the integrator
+%          MaxStep, maximum time step size; by default there is no limit
+%          MaxNonlinIters=4, maximum number of Newton iterations per step
+%          MaxConvFails=10, maximum number of Newton convergence failures
+%                      allowed in a single step
+%          MaxErrTestFails=10, maximum number of error test failures
+%                      allowed in a single step
+%          AutoTune=false, if set to "On", a short pilot integration over
+%                      the first tenth of timePts is used to choose the
+%                      options above other than MaxStep. Options that are set explicitly are
+%                      not changed. The chosen values are printed so that
+%                      they can be set directly in later runs.
+%          Breakpoints=[], vector of times where pdeFunc, bcFunc, or odeFunc
+%                      are discontinuous, e.g. a boundary condition that
+%                      switches on at t=5. The integrator stops at each
+%                      breakpoint and restarts with a small step rather than
+%                      stepping through the discontinuity. At the
+%                      breakpoint itself the functions should return the
+%                      values from before it, e.g. t > 5 rather than t >= 5.
+%          SteadyState=false, if set to "On", the steady-state solution
+%                      (all time derivatives zero) is calculated directly
+%                      with Newton's method, falling back to pseudo-transient
+%                      continuation if Newton does not converge. The
+%                      coefficients are evaluated at timePts(end) and the
+%                      solution contains only this single time.
+%          Period=0, if greater than zero, the periodic steady-state response
+%                      to forcing with this period is calculated by shooting:
+%                      the initial conditions are adjusted with a Newton-Krylov
+%                      method until the solution after one period equals the
+%                      solution at the start. The result for one period is
+%                      returned at timePts, which must all lie within one
+%                      period of timePts(1).
+%          Profile=false, if set to "On", the number of calls, number of
+%                      points evaluated, and wall time are recorded for each
+%                      user-defined function and for the residual, Jacobian,
+%                      factorization, and linear solve phases. The times are
+%                      inclusive; e.g. the residual time includes the pdeFunc
+%                      time. The solution is then returned in a struct
+%                      with these values in the field "profile", e.g.
+%                        sol = pde1d(...,struct('Profile','on'));
+%                        sol.profile.pdeFunc.time
+%                      When the solution is written to an OutputFile, the
+%                      struct contains only this field. They are also
+%                      printed when Stats is "On".
+%          OutputX=[], vector of points where the solution is returned
+%                      instead of the mesh points, e.g. sensor locations.
+%                      The points must lie within the mesh but need not
+%                      be mesh points or in increasing order. The
+%                      solution is then Mt x numel(OutputX) x N and
+%                      ViewMesh is ignored.
+%          OutputCoefficients=false, if set to "On", the solution is
+%                      returned as a struct with fields x and u (and uOde)
+%                      as usual plus the finite element coefficients at
+%                      each output time. For PolyOrder > 1 these are much
+%                      smaller than the solution on a fine ViewMesh. The
+%                      solution and its derivatives at any points and
+%                      times are then calculated with
+%                        [u,DuDx,flux] = pde1d('eval',sol,xq,tq,pdeFunc)
+%                      which returns Mt x Mx x N arrays for the points xq
+%                      and times tq. Values between output times are
+%                      linearly interpolated. pdeFunc is only needed when
+%                      the flux is requested.
+%          OutputPrecision="Double", precision of the stored solution
+%                      history: "Double", "Single" (about 7 significant
+%                      digits), or "Quantized" (integer multiples of
+%                      2*QuantizationTol so the error is at most
+%                      QuantizationTol). Reduced precision halves the
+%                      memory for the solution or the OutputFile size;
+%                      the returned solution is always double.
+%          QuantizationTol, absolute error allowed in the stored solution
+%                      when OutputPrecision is "Quantized".
+%          OutputCompression=false, if set to "On", each stored solution
+%                      row is compressed as its difference from the
+%                      previous time; most effective with "Quantized"
+%                      precision and slowly varying solutions.
+%          OutputChangeTol=0, if greater than zero, the solution is
+%                      output only where it has changed by this amount
+%                      since the previous output rather than at the
+%                      times in tspan, so successive outputs differ by
+%                      at most this amount; only the first and last times
+%                      are used. The integrator is never stopped to produce
+%                      an output so slowly varying phases cost little
+%                      and fast transients are still resolved. The
+%                      solution is returned as a struct with the output
+%                      times in field t.
+%          OutputChangeNorm="Max", the norm of the change in the finite
+%                      element solution vector compared with
+%                      OutputChangeTol: "Max" or "RMS".
+%          DerivedOutputs={}, quantities calculated from the finite
+%                      element solution at each output time: "DuDx",
+%                      "Flux", or "Integrals", or a cell array of these.
+%                      The solution is then returned as a struct with
+%                      fields dudx and flux, Mt x Mx x N arrays at the
+%                      same points as u, and integrals, Mt x N, the
+%                      integral of x^m*u over the domain for each PDE.
+%                      The flux is calculated from pdeFunc in a single
+%                      call at each time when Vectorized is "On". These
+%                      are not written to the OutputFile.
+%          DenseOutput=false, if set to "On", the interpolating
+%                      polynomial of every integrator step is recorded so
+%                      the solution can be evaluated at any time with the
+%                      accuracy of the integration, not only at the times
+%                      in tspan. The solution is returned as a struct
+%                      with fields mesh, polyOrder, and history, and is
+%                      evaluated with
+%                        [u,DuDx,flux] = pde1d('eval',sol,xq,tq,pdeFunc)
+%                      as described for OutputCoefficients.
+%          DenseOutputFile="", name of a binary file where the history
+%                      is written as it is calculated instead of being
+%                      held in memory; sets DenseOutput. The history
+%                      field is then the file name.
+%          OutputThread=false, if set to "On", the interpolation,
+%                      derived outputs, encoding, and file writing are
+%                      done in a separate thread while the integration
+%                      continues. The results are identical. It has no
+%                      effect when the "Flux" derived output is requested.
+%          EventsMeshPoints=[], indices into xmesh of the points where
+%                      the events function depends on the solution. Only
+%                      these x-values and the solution at these points
+%                      are passed to the events function, which is much
+%                      cheaper on large meshes. By default all mesh points
+%                      are passed. It is an error to set this option for
+%                      a problem without events.
+%          OutputFile="", name of a binary file where the solution is
+%                      written as it is calculated instead of being held
+%                      in memory; useful when the solution at all times
+%                      does not fit in memory. The solution outputs are
+%                      then empty and the file is read with
+%                        info = pde1d('read',fileName)
+%                        [u,uOde] = pde1d('read',fileName,timeIndices)
+%                      info contains the mesh, x, the output times, t,
+%                      numPDE, numODE, and the events found, te, ue, and
+%                      ie. u is the solution at the times with indices
+%                      timeIndices, in the same form as the solution
+%                      below. Only the requested times are read from
+%                      the file.
 %
 % solution- pde1d returns the solution of the system of PDE in a Mt x Mx x N
 %           dimensioned matrix where Mt is the number of time points in the
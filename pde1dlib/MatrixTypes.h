@@ -29,6 +29,8 @@ typedef Eigen::VectorXd RealVector;
 typedef Eigen::MatrixXd RealMatrix;
 typedef Eigen::Map<Eigen::VectorXd> MapVec;
 typedef Eigen::Map<Eigen::MatrixXd> MapMat;
+typedef Eigen::Map<const Eigen::VectorXd> ConstMapVec;
+typedef Eigen::Map<const Eigen::MatrixXd> ConstMapMat;
 typedef Eigen::VectorXi IntVector;
 
 #endif /* PDE1DLIB_MATRIXTYPES_H_ */
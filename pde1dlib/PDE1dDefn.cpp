@@ -13,14 +13,37 @@
 // You should have received a copy of the GNU General Public License along with
 // this program; if not, see <http://www.gnu.org/licenses/>.
 
+#include <stdio.h>
+
 #include "PDE1dDefn.h"
+#include "PDE1dException.h"
 #include "PDE1dImpl.h"
 #include "PDE1dOptions.h"
 #include "PDESolution.h"
 
 
-PDE1dDefn::PDE1dDefn()
+PDE1dDefn::PDE1dDefn() : profiler(0)
+{
+}
+
+void PDE1dDefn::setEventsMeshPoints(const std::vector<int> &pts)
+{
+  const int nn = (int)getMesh().size();
+  for (int p : pts) {
+    if (p < 0 || p >= nn) {
+      char msg[1024];
+      sprintf(msg, "Events mesh point %d is not between 1 and the number "
+        "of mesh points, %d.", p + 1, nn);
+      throw PDE1dException("pde1d:invalid_events_points", msg);
+    }
+  }
+  eventsMeshPts = pts;
+}
+
+void PDE1dDefn::applyEventsMeshPoints(const PDE1dOptions &opts)
 {
+  if (!opts.getEventsMeshPoints().empty())
+    setEventsMeshPoints(opts.getEventsMeshPoints());
 }
 
 PDESolution pde1d(PDE1dDefn &pde)
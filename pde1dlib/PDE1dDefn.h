@@ -15,14 +15,19 @@
 
 #pragma once
 
+#include <vector>
+
 #include <MatrixTypes.h>
 
 class PDESolution;
+class PDE1dProfiler;
+class PDE1dOptions;
 
 class PDE1dDefn
 {
 public:
   PDE1dDefn();
+  virtual ~PDE1dDefn() {}
   virtual int getNumPDE() const = 0;
   virtual int getCoordSystem() const { return 0; }
   virtual void evalIC(double x, RealVector &ic) = 0;
@@ -46,6 +51,23 @@ public:
     const RealMatrix &u, const RealMatrix &DuDx,
     const RealVector &v, const RealVector &vDot, PDECoeff &pde) { 
   };
+  /*
+   * Optional interface for the vectorized pde evaluation without copying
+   * the arguments or results. getPDEArgBuffers returns false or arrays
+   * for numPts x-values and the numPDE x numPts u and DuDx matrices.
+   * The caller fills these and calls evalPDEBuffers which returns
+   * pointers to the numPDE x numPts c, f, and s coefficients; these
+   * are valid until the next call.
+   */
+  virtual bool getPDEArgBuffers(size_t numPts, double *&x, double *&u,
+    double *&DuDx) {
+    return false;
+  }
+  struct PDECoeffView {
+    const double *c, *f, *s;
+  };
+  virtual void evalPDEBuffers(double t, const RealVector &v,
+    const RealVector &vDot, PDECoeffView &pde) { }
   virtual int getNumODE() const { return 0; }
   struct ODE {
     RealVector c, f;
@@ -60,6 +82,24 @@ public:
   virtual void evalEvents(double t, const RealMatrix &u,
     RealVector &eventsVal, RealVector &eventsIsTerminal,
     RealVector &eventsDirection) { };
+  /*
+   * Mesh points, as zero-based indices into getMesh(), where the events
+   * depend on the solution. Only the solution at these points is passed
+   * to evalEvents, as a numPDE x numPts matrix; when empty, the solution
+   * at all mesh points is passed.
+   */
+  virtual void setEventsMeshPoints(const std::vector<int> &pts);
+  // from the EventsMeshPoints option, which replaces any points set
+  // with the problem definition unless it is empty
+  void applyEventsMeshPoints(const PDE1dOptions &opts);
+  const std::vector<int> &getEventsMeshPoints() const {
+    return eventsMeshPts;
+  }
+  // counters for the user-defined functions; set by the solver
+  void setProfiler(PDE1dProfiler *prof) { profiler = prof; }
+protected:
+  std::vector<int> eventsMeshPts;
+  PDE1dProfiler *profiler;
 };
 
 PDESolution pde1d(PDE1dDefn &pde);
@@ -0,0 +1,71 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include "PDE1dDriver.h"
+#include "PDE1dDefn.h"
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDESolutionFile.h"
+#include "PDEDenseOutput.h"
+
+PDE1dDriver::PDE1dDriver(PDE1dDefn &pde, PDE1dOptions &opts) : opts(opts)
+{
+  impl.reset(new PDE1dImpl(pde, opts));
+  sol.reset(new PDESolution(pde, impl->getModel(), opts.getViewMesh(),
+    opts.getOutputX()));
+  // the solution is appended to the output file as it is calculated
+  if (!opts.getOutputFile().empty()) {
+    solFile.reset(new PDESolutionFile(opts.getOutputFile(), sol->getX(),
+      pde.getNumPDE(), pde.getNumODE(), PDESolutionCodec(0, opts)));
+    sol->setOutputFile(solFile.get());
+  }
+  if (opts.getDenseOutput()) {
+    dense.reset(new PDEDenseOutput);
+    impl->setDenseOutput(dense.get());
+    if (!opts.getDenseOutputFile().empty())
+      dense->setOutputFile(opts.getDenseOutputFile());
+  }
+  sol->setStorageOptions(opts);
+  sol->setStoreCoefficients(opts.getOutputCoefficients());
+  sol->setDerivedOutputs(opts.getDerivedOutputs());
+}
+
+PDE1dDriver::~PDE1dDriver()
+{
+}
+
+bool PDE1dDriver::canUseOutputBuffer() const
+{
+  // the number of output times is not known in advance when they are
+  // chosen from the solution changes
+  return !solFile && !sol->isEncoded() && !opts.getOutputChangeTol();
+}
+
+int PDE1dDriver::solve()
+{
+  // started last since the output thread reads the storage settings
+  sol->setOutputThread(opts.getOutputThread());
+  int err;
+  if (opts.getSteadyState())
+    err = impl->solveSteadyState(*sol);
+  else if (opts.getPeriod() > 0)
+    err = impl->solvePeriodic(*sol);
+  else
+    err = impl->solveTransient(*sol);
+  if (!err && dense)
+    dense->close();
+  return err;
+}
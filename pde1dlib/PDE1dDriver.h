@@ -0,0 +1,63 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dDriver_h
+#define PDE1dDriver_h
+
+#include <memory>
+
+class PDE1dDefn;
+class PDE1dOptions;
+class PDE1dImpl;
+class PDESolution;
+class PDESolutionFile;
+class PDEDenseOutput;
+
+/*
+ * The steps shared by all front ends to solve a problem with a set of
+ * options. The constructor creates the solver and the solution with
+ * the output file, integrator history, and storage the options select.
+ * A front end may then direct the solution into its own array with
+ * PDESolution::setOutputBuffer before calling solve, and builds its
+ * outputs from the solution afterwards.
+ */
+class PDE1dDriver
+{
+public:
+  PDE1dDriver(PDE1dDefn &pde, PDE1dOptions &opts);
+  ~PDE1dDriver();
+  PDE1dImpl &getImpl() { return *impl; }
+  PDESolution &getSolution() { return *sol; }
+  // null unless the DenseOutput option is set
+  const PDEDenseOutput *getDenseOutput() const { return dense.get(); }
+  // the solution is written to the OutputFile as it is calculated
+  bool hasOutputFile() const { return solFile != nullptr; }
+  // the solution at all of the requested times can be written directly
+  // into an array supplied with PDESolution::setOutputBuffer
+  bool canUseOutputBuffer() const;
+  // transient, steady-state, or periodic solution depending on the
+  // options; returns nonzero if the integrator failed
+  int solve();
+private:
+  PDE1dOptions &opts;
+  // the solution, which may still be writing to the file from its
+  // output thread, is destroyed first
+  std::unique_ptr<PDESolutionFile> solFile;
+  std::unique_ptr<PDEDenseOutput> dense;
+  std::unique_ptr<PDE1dImpl> impl;
+  std::unique_ptr<PDESolution> sol;
+};
+
+#endif
@@ -0,0 +1,146 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+
+#include "PDE1dExprDefn.h"
+#include "PDE1dException.h"
+
+namespace {
+
+  // order of the variables passed to the expressions
+  enum { XVar, TVar, UVar };
+
+}
+
+PDE1dExprDefn::PDE1dExprDefn(int m, const RealVector &mesh,
+  const RealVector &tspan, const Expressions &exprs,
+  const PDEExpression::ParamMap &params, const PDETable::TableMap &tables) :
+  mCoord(m), mesh(mesh), tspan(tspan), params(params), tables(tables)
+{
+  numPDE = (int)exprs.c.size();
+  if (numPDE < 1)
+    throw PDE1dException("pde1d:expression_defn",
+      "At least one PDE must be defined.");
+  PDEExpression::VarMap xVars, xtVars, btVars, allVars;
+  xVars["x"] = XVar;
+  xtVars = xVars;
+  xtVars["t"] = TVar;
+  btVars = xtVars;
+  allVars = xtVars;
+  char name[32];
+  for (int i = 0; i < numPDE; i++) {
+    sprintf(name, "u%d", i + 1);
+    btVars[name] = allVars[name] = UVar + i;
+    sprintf(name, "dudx%d", i + 1);
+    allVars[name] = UVar + numPDE + i;
+  }
+  if (numPDE == 1) {
+    btVars["u"] = allVars["u"] = UVar;
+    allVars["dudx"] = UVar + 1;
+  }
+  compile(exprs.c, "c", allVars, c);
+  compile(exprs.f, "f", allVars, f);
+  compile(exprs.s, "s", allVars, s);
+  compile(exprs.ic, "ic", xVars, ic);
+  compile(exprs.pl, "pl", btVars, pl);
+  compile(exprs.ql, "ql", xtVars, ql);
+  compile(exprs.pr, "pr", btVars, pr);
+  compile(exprs.qr, "qr", xtVars, qr);
+  vars.resize(UVar + 2 * numPDE);
+  xTmp.resize(1);
+}
+
+void PDE1dExprDefn::compile(const std::vector<std::string> &text,
+  const char *name, const PDEExpression::VarMap &vars, ExprList &exprs)
+{
+  if (text.size() != numPDE) {
+    char msg[1024];
+    sprintf(msg, "The number of \"%s\" expressions, %d, must equal the number "
+      "of PDE, %d.", name, (int)text.size(), numPDE);
+    throw PDE1dException("pde1d:expression_defn", msg);
+  }
+  for (const std::string &t : text)
+    exprs.emplace_back(new PDEExpression(t, vars, params, tables));
+}
+
+void PDE1dExprDefn::evalIC(double x, RealVector &icv)
+{
+  icv.resize(numPDE);
+  vars[XVar].p = &x;
+  vars[XVar].stride = 0;
+  for (int i = 0; i < numPDE; i++)
+    ic[i]->eval(vars.data(), 1, &icv(i));
+}
+
+void PDE1dExprDefn::evalBCEnd(ExprList &p, ExprList &q, double x,
+  const RealVector &u, double t, RealVector &pv, RealVector &qv)
+{
+  pv.resize(numPDE);
+  qv.resize(numPDE);
+  vars[XVar].p = &x;
+  vars[XVar].stride = 0;
+  vars[TVar].p = &t;
+  vars[TVar].stride = 0;
+  for (int i = 0; i < numPDE; i++) {
+    vars[UVar + i].p = &u(i);
+    vars[UVar + i].stride = 0;
+  }
+  for (int i = 0; i < numPDE; i++) {
+    p[i]->eval(vars.data(), 1, &pv(i));
+    q[i]->eval(vars.data(), 1, &qv(i));
+  }
+}
+
+void PDE1dExprDefn::evalBC(double xl, const RealVector &ul,
+  double xr, const RealVector &ur, double t,
+  const RealVector &v, const RealVector &vDot, BC &bc)
+{
+  evalBCEnd(pl, ql, xl, ul, t, bc.pl, bc.ql);
+  evalBCEnd(pr, qr, xr, ur, t, bc.pr, bc.qr);
+}
+
+void PDE1dExprDefn::evalPDE(double x, double t,
+  const RealVector &u, const RealVector &DuDx,
+  const RealVector &v, const RealVector &vDot, PDECoeff &pde)
+{
+  xTmp(0) = x;
+  evalPDE(xTmp, t, u, DuDx, v, vDot, pde);
+}
+
+void PDE1dExprDefn::evalPDE(const RealVector &x, double t,
+  const RealMatrix &u, const RealMatrix &DuDx,
+  const RealVector &v, const RealVector &vDot, PDECoeff &pde)
+{
+  const size_t numPts = x.size();
+  pde.c.resize(numPDE, numPts);
+  pde.f.resize(numPDE, numPts);
+  pde.s.resize(numPDE, numPts);
+  vars[XVar].p = x.data();
+  vars[XVar].stride = 1;
+  vars[TVar].p = &t;
+  vars[TVar].stride = 0;
+  for (int i = 0; i < numPDE; i++) {
+    vars[UVar + i].p = u.data() + i;
+    vars[UVar + i].stride = numPDE;
+    vars[UVar + numPDE + i].p = DuDx.data() + i;
+    vars[UVar + numPDE + i].stride = numPDE;
+  }
+  for (int i = 0; i < numPDE; i++) {
+    c[i]->eval(vars.data(), numPts, pde.c.data() + i, numPDE);
+    f[i]->eval(vars.data(), numPts, pde.f.data() + i, numPDE);
+    s[i]->eval(vars.data(), numPts, pde.s.data() + i, numPDE);
+  }
+}
@@ -0,0 +1,75 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dExprDefn_h
+#define PDE1dExprDefn_h
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "PDE1dDefn.h"
+#include "PDEExpression.h"
+
+/*
+ * Problem definition where the coefficients, boundary conditions, and
+ * initial conditions are given as expressions, one per PDE.
+ * The coefficients are functions of x, t, u1..uN, and dudx1..dudxN (u and
+ * dudx when there is a single PDE). Boundary condition p may depend on
+ * x, t, and u; q on x and t. Initial conditions are functions of x.
+ * Any of the expressions may call the named tables.
+ */
+class PDE1dExprDefn : public PDE1dDefn
+{
+public:
+  struct Expressions {
+    std::vector<std::string> c, f, s, ic, pl, ql, pr, qr;
+  };
+  PDE1dExprDefn(int m, const RealVector &mesh, const RealVector &tspan,
+    const Expressions &exprs, const PDEExpression::ParamMap &params,
+    const PDETable::TableMap &tables = PDETable::TableMap());
+  virtual int getNumPDE() const { return numPDE; }
+  virtual int getCoordSystem() const { return mCoord; }
+  virtual void evalIC(double x, RealVector &ic);
+  virtual void evalODEIC(RealVector &ic) {}
+  virtual void evalBC(double xl, const RealVector &ul,
+    double xr, const RealVector &ur, double t,
+    const RealVector &v, const RealVector &vDot, BC &bc);
+  virtual void evalPDE(double x, double t,
+    const RealVector &u, const RealVector &DuDx,
+    const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual bool hasVectorPDEEval() const { return true; }
+  virtual void evalPDE(const RealVector &x, double t,
+    const RealMatrix &u, const RealMatrix &DuDx,
+    const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual const RealVector &getMesh() const { return mesh; }
+  virtual const RealVector &getTimeSpan() const { return tspan; }
+  virtual const RealVector &getODEMesh() { return odeMesh; }
+private:
+  typedef std::vector<std::unique_ptr<PDEExpression>> ExprList;
+  void compile(const std::vector<std::string> &text, const char *name,
+    const PDEExpression::VarMap &vars, ExprList &exprs);
+  void evalBCEnd(ExprList &p, ExprList &q, double x, const RealVector &u,
+    double t, RealVector &pv, RealVector &qv);
+  int mCoord, numPDE;
+  RealVector mesh, tspan, odeMesh;
+  const PDEExpression::ParamMap params;
+  const PDETable::TableMap tables;
+  ExprList c, f, s, ic, pl, ql, pr, qr;
+  RealVector xTmp;
+  std::vector<PDEExpression::Var> vars;
+};
+
+#endif
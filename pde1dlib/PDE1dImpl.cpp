@@ -28,8 +28,6 @@ using std::endl;
 #define BAND_SOLVER 0
 #define TEST_IC_CALC 0
 
-#include <mex.h>
-
 #include <ida/ida.h>
 #include <ida/ida_direct.h> 
 #define SUN_USING_SPARSE 1
@@ -57,14 +55,17 @@ using std::endl;
 #include "PDE1dException.h"
 #include "PDE1dWarningMsg.h"
 #include "SunVector.h"
+#include "PDEDenseOutput.h"
 #include "FiniteDiffJacobian.h"
 #include "ShapeFunction.h"
 #include "ShapeFunctionManager.h"
 #include "PDEInitConditions.h"
+#include "PDEShootingSolver.h"
 #include "PDEMeshMapper.h"
 #include "PDEModel.h"
 #include "PDESolution.h"
 #include "PDEEvents.h"
+#include "PDE1dProfiler.h"
 #include <util.h>
 #include "EigenSUNSparseSolver.h"
 
@@ -82,9 +83,36 @@ public:
 };
 #endif
 
+// sundials linear solver objects owned by the integrator
+struct PDE1dImpl::IDALinSys {
+  IDALinSys() {
+#if SUNDIALS_3
+    A = 0;
+    LS = 0;
+#endif
+  }
+  ~IDALinSys() {
+#if SUNDIALS_3
+#if ! USE_EIGEN_LU
+    if (LS) SUNLinSolFree(LS);
+#endif
+    if (A) SUNMatDestroy(A);
+#endif
+  }
+#if SUNDIALS_3
+  SUNMatrix A;
+  SUNLinearSolver LS;
+#if USE_EIGEN_LU
+  std::unique_ptr<EigenSUNSparseSolver> eigenSolver;
+#endif
+#endif
+};
+
 PDE1dImpl::PDE1dImpl(PDE1dDefn &pde, PDE1dOptions &options) : 
-pde(pde), options(options)
+pde(pde), options(options), xVals(0, 0), uVals(0, 0, 0), duVals(0, 0, 0),
+cVals(0, 0, 0), fVals(0, 0, 0), sVals(0, 0, 0)
 {
+  useArgBuffers = false;
 #if _cpp_lib_make_unique
   // C++14
   sf = std::make_unique<ShapeFunction2>();
@@ -93,6 +121,11 @@ pde(pde), options(options)
 #endif
   sfm = std::unique_ptr<ShapeFunctionManager>(new ShapeFunctionManager);
   ida = 0;
+  tCurrent = 0;
+  tStop = std::numeric_limits<double>::infinity();
+  nextBreakpoint = 0;
+  denseOutput = 0;
+  profiler.enable(options.getProfile());
   polyOrder = options.getPolyOrder();
   numIntPts = GausLegendreIntRule::getNumPtsForPolyOrder(2 * polyOrder);
   //cout << "numIntPts=" << numIntPts << endl;
@@ -101,6 +134,15 @@ pde(pde), options(options)
   tspan = pde.getTimeSpan();
   checkIncreasing(tspan, 6, "timePts");
   numTimes = tspan.size();
+  checkIntegratorControls();
+  // only breakpoints inside the time span affect the integration
+  for (double tb : options.getBreakpoints()) {
+    if (tb > tspan(0) && tb < tspan(numTimes - 1))
+      breakpoints.push_back(tb);
+  }
+  std::sort(breakpoints.begin(), breakpoints.end());
+  breakpoints.erase(std::unique(breakpoints.begin(), breakpoints.end()),
+    breakpoints.end());
   numODE = pde.getNumODE();
   numDepVars = pde.getNumPDE();
   pdeModel = std::unique_ptr<PDEModel>(
@@ -132,6 +174,17 @@ pde(pde), options(options)
   bc.ql.resize(numDepVars);
   bc.qr.resize(numDepVars);
 
+  autoVectorized = 0;
+  if (options.isVectorizedAuto() && pde.hasVectorPDEEval()) {
+    bool isVec = probeVectorized();
+    options.setVectorized(isVec);
+    autoVectorized = isVec ? 1 : -1;
+    // reported here since not every solver prints the integrator stats
+    if (options.printStats())
+      pdePrintf("Vectorized evaluation of pdeFunc was automatically %s\n",
+        isVec ? "enabled" : "disabled");
+  }
+
   size_t numXPts = 1;
   if (options.isVectorized()) {
     numXPts = numIntPts*pdeModel->numElements();
@@ -166,11 +219,19 @@ pde(pde), options(options)
     pdeEvents =
       std::unique_ptr<PDEEvents>(new PDEEvents(pde, *pdeModel));
   }
+  else if (!options.getEventsMeshPoints().empty()) {
+    throw PDE1dException("pde1d:invalid_events_points",
+      "The \"EventsMeshPoints\" option can only be used with events.");
+  }
+  // last, since the destructor that resets it isn't called if the
+  // constructor throws
+  pde.setProfiler(&profiler);
 }
 
 PDE1dImpl::~PDE1dImpl()
 {
   if(ida) IDAFree(&ida);
+  pde.setProfiler(0);
 }
 
 namespace {
@@ -221,6 +282,35 @@ namespace {
   }
 #endif
 
+#if SUNDIALS_3
+  // The setup and solve of every linear solver of a type are the same
+  // functions. The linear solver has no user data so the calls are
+  // counted by the profiler of the solver that last evaluated the
+  // residual or Jacobian on this thread; IDA always does so before
+  // a setup or solve.
+  int (*linSolSetup)(SUNLinearSolver, SUNMatrix);
+  int (*linSolSolve)(SUNLinearSolver, SUNMatrix, N_Vector, N_Vector,
+    realtype);
+  thread_local PDE1dProfiler *linSolProfiler = 0;
+
+  int profiledLinSolSetup(SUNLinearSolver S, SUNMatrix A) {
+    PDE1dProfiler::Scope prof(linSolProfiler, PDE1dProfiler::Factorization);
+    return linSolSetup(S, A);
+  }
+
+  int profiledLinSolSolve(SUNLinearSolver S, SUNMatrix A, N_Vector x,
+    N_Vector b, realtype tol) {
+    PDE1dProfiler::Scope prof(linSolProfiler, PDE1dProfiler::LinearSolve);
+    return linSolSolve(S, A, x, b, tol);
+  }
+#endif
+
+  void batchResFunc(double t, int numCols, const double *u,
+    const double *up, double *r, void *user_data) {
+    PDE1dImpl *pde = (PDE1dImpl*)user_data;
+    pde->calcRHSODEBatch(t, numCols, u, up, r);
+  }
+
   int rootFunc(realtype t, N_Vector y, N_Vector yp,
     realtype *gout, void *user_data) {
     SunVector u(y);
@@ -255,9 +345,8 @@ namespace {
 
 }
 
-int PDE1dImpl::solveTransient(PDESolution &sol)
+void PDE1dImpl::getInitConditions(RealVector &y0)
 {
-  RealVector y0(totalNumEqns);
   size_t nnfe = pdeModel->numNodesFEEqns();
   getFEInitConditions(y0);
   MapMat y0FE(y0.data(), numDepVars, nnfe);
@@ -272,39 +361,34 @@ int PDE1dImpl::solveTransient(PDESolution &sol)
     dirConsFlagsLeft[i] = bc.ql[i] == 0;
     dirConsFlagsRight[i] = bc.qr[i] == 0;
   }
+}
 
-  if (options.getEqnDiagnostics()) {
-    testMats(y0);
-    //sol.setSolutionVector(0, 0, y0);
-    return 0;
-  }
-#if 0
-  testODEJacobian(y0);
-#endif
-
+void PDE1dImpl::createIntegrator(const RealVector &y0)
+{
   const size_t neqImpl = totalNumEqns;
   /* Create vectors uu, up, res, constraints, id. */
-  SunVector uu(neqImpl), up(neqImpl), res(neqImpl), id(neqImpl);
-  double *udata = &uu[0];
-  MapVec u(udata, neqImpl);
-  std::copy_n(y0.data(), totalNumEqns, udata);
-  up.setConstant(0);
+  uu = std::unique_ptr<SunVector>(new SunVector(neqImpl));
+  up = std::unique_ptr<SunVector>(new SunVector(neqImpl));
+  SunVector res(neqImpl), id(neqImpl);
+  *uu = y0;
+  up->setConstant(0);
 #if 0
   // test for consistent initial conditions
-  resFunc(0, uu(), up(), res(), this);
+  resFunc(0, uu->getNV(), up->getNV(), res.getNV(), this);
   MapVec resVec(&res[0], neqImpl);
   double initResNorm = resVec.dot(resVec);
   pdePrintf("initResNorm=%12.3e\n", sqrt(initResNorm));
 #endif
 
   /* Call IDACreate and IDAMalloc to initialize solution */
+  if (ida) IDAFree(&ida);
   ida = IDACreate();
   check_flag(ida, "IDACreate", 0);
 
   int ier = IDASetUserData(ida, this);
   check_flag(&ier, "IDASetUserData", 1);
   if (!options.getICMethod() || numODE) {
-    setAlgVarFlags(uu, up, id);
+    setAlgVarFlags(*uu, *up, id);
     ier = IDASetId(ida, id.getNV());
     check_flag(&ier, "IDASetId", 1);
   }
@@ -314,8 +398,8 @@ int PDE1dImpl::solveTransient(PDESolution &sol)
     check_flag(&ier, "IDASetSuppressAlg", 1);
   }
   double t0 = tspan(0);
-  PDEInitConditions initCond(ida, *this, uu, up);
-  PDEInitConditions::ICPair icPair = initCond.init();
+  PDEInitConditions initCond(ida, *this, *uu, *up);
+  PDEInitConditions::ICPair icPair = initCond.init(t0);
   ier = IDAInit(ida, resFunc, t0, icPair.first->getNV(),
     icPair.second->getNV());
   check_flag(&ier, "IDAInit", 1);
@@ -324,21 +408,12 @@ int PDE1dImpl::solveTransient(PDESolution &sol)
   check_flag(&ier, "IDASStolerances", 1);
   ier = IDASetMaxNumSteps(ida, options.getMaxSteps());
   check_flag(&ier, "IDASetMaxNumSteps", 1);
+  setIntegratorControls();
 #if SUN_USING_SPARSE
   //printf("Using sparse solver.\n");
 #if SUNDIALS_3
-  SUNMatrix A = SUNSparseMatrix((sunindextype)totalNumEqns,
-    (sunindextype)totalNumEqns, (sunindextype)numNonZerosJacMax, CSC_MAT);
-  check_flag(A, "SUNSparseMatrix", 0);
-#if USE_EIGEN_LU
-  //cout << "Using Eigen Sparse LU" << endl;
-  EigenSUNSparseSolver linearSolver(uu.getNV(), A);
-  SUNLinearSolver LS = &linearSolver;
-#else
-  SUNLinearSolver LS = SUNKLU(uu.getNV(), A);
-  check_flag(LS, "SUNKLU", 0);
-#endif
-  ier = IDADlsSetLinearSolver(ida, LS, A);
+  createLinearSolver();
+  ier = IDADlsSetLinearSolver(ida, idaLinSys->LS, idaLinSys->A);
   check_flag(&ier, "IDADlsSetLinearSolver", 1);
   ier = IDADlsSetJacFn(ida, jacFunc);
   check_flag(&ier, "IDADlsSetJacFn", 1);
@@ -359,10 +434,10 @@ int PDE1dImpl::solveTransient(PDESolution &sol)
 #endif
 
   // second stage of initial conditions calculation
-  initCond.update();
+  initCond.update(tspan.tail<1>()[0]);
   //initCond.print();
-  uu = initCond.getU0();
-  up = initCond.getUp0();
+  *uu = initCond.getU0();
+  *up = initCond.getUp0();
 
 #if TEST_IC_CALC
   // testing only
@@ -376,47 +451,193 @@ int PDE1dImpl::solveTransient(PDESolution &sol)
     ier = IDARootInit(ida, numEvents, rootFunc);
     check_flag(&ier, "IDARootInit", 1);
   }
-  
-  //sol.time(0) = tspan(0);
-  sol.setSolutionVector(0, 0, initCond.getU0().topRows(numFEEqns));
-  if (numODE) {
-    sol.uOde.resize(numTimes, numODE);
-    sol.uOde.row(0) = initCond.getU0().bottomRows(numODE);
+  tCurrent = t0;
+  nextBreakpoint = 0;
+}
+
+void PDE1dImpl::setIntegratorControls()
+{
+  int ier;
+  if (options.getMaxOrder()) {
+    ier = IDASetMaxOrd(ida, options.getMaxOrder());
+    check_flag(&ier, "IDASetMaxOrd", 1);
+  }
+  if (options.getInitialStep()) {
+    ier = IDASetInitStep(ida, options.getInitialStep());
+    check_flag(&ier, "IDASetInitStep", 1);
   }
+  if (options.getMaxStep()) {
+    ier = IDASetMaxStep(ida, options.getMaxStep());
+    check_flag(&ier, "IDASetMaxStep", 1);
+  }
+  if (options.getMaxNonlinIters()) {
+    ier = IDASetMaxNonlinIters(ida, options.getMaxNonlinIters());
+    check_flag(&ier, "IDASetMaxNonlinIters", 1);
+  }
+  if (options.getMaxConvFails()) {
+    ier = IDASetMaxConvFails(ida, options.getMaxConvFails());
+    check_flag(&ier, "IDASetMaxConvFails", 1);
+  }
+  if (options.getMaxErrTestFails()) {
+    ier = IDASetMaxErrTestFails(ida, options.getMaxErrTestFails());
+    check_flag(&ier, "IDASetMaxErrTestFails", 1);
+  }
+}
+
+void PDE1dImpl::autoTune(const RealVector &y0)
+{
+  // Pilot integration over the first part of the time span. The step
+  // history and solver statistics are used to pick integrator controls
+  // for the production run.
+  createIntegrator(y0);
+  double t0 = tspan(0), tf = tspan(numTimes - 1);
+  double tPilot = t0 + .1*(tf - t0);
+  if (!breakpoints.empty())
+    tPilot = std::min(tPilot, breakpoints[0]);
+  int ier = IDASetStopTime(ida, tPilot);
+  check_flag(&ier, "IDASetStopTime", 1);
+  std::vector<double> hist;
+  bool pilotFailed = false;
+  double tret = t0;
+  while (tret < tPilot) {
+    ier = IDASolve(ida, tPilot, &tret, uu->getNV(), up->getNV(), IDA_ONE_STEP);
+    if (ier < 0) {
+      pilotFailed = true;
+      break;
+    }
+    double h;
+    IDAGetLastStep(ida, &h);
+    hist.push_back(h);
+  }
+  long nsteps = 0, nrevals, nlinsetups, netfails = 0, nniters = 0, nncfails = 0;
+  int klast, kcur;
+  double hinused = 0, hlast, hcur, tcur;
+  IDAGetIntegratorStats(ida, &nsteps, &nrevals, &nlinsetups, &netfails,
+    &klast, &kcur, &hinused, &hlast, &hcur, &tcur);
+  IDAGetNonlinSolvStats(ida, &nniters, &nncfails);
+
+  // abrupt step size reductions indicate a rough solution
+  size_t numCuts = 0;
+  for (size_t i = 1; i < hist.size(); i++)
+    if (hist[i] < .5*hist[i - 1]) numCuts++;
+  double ns = (double)std::max(nsteps, 1L);
+  bool rough = pilotFailed || (netfails + numCuts) > .2*ns;
+  bool nonlinear = pilotFailed || nncfails > .05*ns || nniters > 2.5*ns;
+
+  if (!options.getInitialStep() && hinused > 0 && !pilotFailed)
+    options.setInitialStep(hinused);
+  // The pilot usually covers the start-up transient so its step sizes
+  // are not used to limit the step for the rest of the run.
+  if (rough) {
+    // low order BDF is more robust for solutions that are not smooth
+    if (!options.getMaxOrder()) options.setMaxOrder(2);
+  }
+  if (nonlinear) {
+    if (!options.getMaxNonlinIters()) options.setMaxNonlinIters(6);
+    if (!options.getMaxConvFails()) options.setMaxConvFails(20);
+  }
+  if (rough && !options.getMaxErrTestFails())
+    options.setMaxErrTestFails(20);
+
+  autoTuneProfile = rough ? (nonlinear ? "rough, nonlinear" : "rough") :
+    (nonlinear ? "nonlinear" : "smooth");
+  pdePrintf("AutoTune: pilot run to t=%g took %ld steps "
+    "(%ld error test failures, %ld convergence failures).\n",
+    tret, nsteps, netfails, nncfails);
+  pdePrintf("AutoTune: profile=%s, MaxOrder=%d, InitialStep=%g, MaxStep=%g,\n"
+    "  MaxNonlinIters=%d, MaxConvFails=%d, MaxErrTestFails=%d\n",
+    autoTuneProfile.c_str(),
+    options.getMaxOrder(), options.getInitialStep(), options.getMaxStep(),
+    options.getMaxNonlinIters(), options.getMaxConvFails(),
+    options.getMaxErrTestFails());
+}
+
+void PDE1dImpl::createLinearSolver()
+{
+  idaLinSys = std::unique_ptr<IDALinSys>(new IDALinSys);
+#if SUNDIALS_3
+  SUNMatrix A = SUNSparseMatrix((sunindextype)totalNumEqns,
+    (sunindextype)totalNumEqns, (sunindextype)numNonZerosJacMax, CSC_MAT);
+  check_flag(A, "SUNSparseMatrix", 0);
+  idaLinSys->A = A;
+#if USE_EIGEN_LU
+  //cout << "Using Eigen Sparse LU" << endl;
+  idaLinSys->eigenSolver = std::unique_ptr<EigenSUNSparseSolver>(
+    new EigenSUNSparseSolver(uu->getNV(), A));
+  idaLinSys->LS = idaLinSys->eigenSolver.get();
+#else
+  idaLinSys->LS = SUNKLU(uu->getNV(), A);
+  check_flag(idaLinSys->LS, "SUNKLU", 0);
+#endif
+  // route the factorization and solve through the profiler
+  SUNLinearSolver_Ops ops = idaLinSys->LS->ops;
+  if (ops->setup != profiledLinSolSetup) {
+    linSolSetup = ops->setup;
+    linSolSolve = ops->solve;
+    ops->setup = profiledLinSolSetup;
+    ops->solve = profiledLinSolSolve;
+  }
+  int ier = SUNLinSolInitialize(idaLinSys->LS);
+  check_flag(&ier, "SUNLinSolInitialize", 1);
+#endif
+}
+
+int PDE1dImpl::solveTransient(PDESolution &sol)
+{
+  RealVector y0(totalNumEqns);
+  getInitConditions(y0);
+
+  if (options.getEqnDiagnostics()) {
+    testMats(y0);
+    //sol.setSolutionVector(0, 0, y0);
+    return 0;
+  }
+#if 0
+  testODEJacobian(y0);
+#endif
+
+  if (options.getAutoTune())
+    autoTune(y0);
+  createIntegrator(y0);
+  return integrateToOutputTimes(sol);
+}
+
+int PDE1dImpl::integrateToOutputTimes(PDESolution &sol)
+{
+  MapVec u(uu->data(), totalNumEqns);
+
+  //sol.time(0) = tspan(0);
+  setOutputSolution(sol, 0, tCurrent, *uu, *up);
 
   // optionally, calc and print jacobian matrices
-  if(options.getJacDiagnostics())
-     jacobianDiagnostics(tspan(0), uu, up, res);
+  if (options.getJacDiagnostics()) {
+    SunVector res(totalNumEqns);
+    jacobianDiagnostics(tspan(0), *uu, *up, res);
+  }
 
+  if (options.getOutputChangeTol() > 0) {
+    integrateToSolutionChanges(sol);
+    printStats();
+    sol.close();
+    return 0;
+  }
+
+  int numEvents = pde.getNumEvents();
   bool doTerm = false;
   int i = 1;
   while (i< numTimes && ! doTerm) {
-    double tout=tspan(i), tret;
-    ier = IDASolve(ida, tout, &tret, uu.getNV(), up.getNV(), IDA_NORMAL);
-    if (ier < 0) {
-      pdePrintf("Error returned from IDASolve=%d\n", ier);
-      printStats();
-      char msg[1024];
-      sprintf(msg, "Time integration failed at t=%15.6e before reaching final time.\n"
-        "Often this is caused by one or more dependent variables becoming unbounded.",
-        tret);
-      throw PDE1dException("pde1d:integ_failure", msg);
-    }
-    //cout << "tret=" << tret << endl;
+    int ier = integrateTo(tspan(i));
+    //cout << "tret=" << tCurrent << endl;
     // events
     bool eventSatisfied = false;
     if (ier == IDA_ROOT_RETURN) {
       eventSatisfied = true;
       IntVector eventsFound(numEvents);
-      ier = IDAGetRootInfo(ida, eventsFound.data());
-      check_flag(&ier, "IDAGetRootInfo", 1);
-      doTerm = pdeEvents->isTerminalEvent(tret, u, eventsFound);
-      sol.setEventsSolution(i, tret, u.topRows(numFEEqns), eventsFound);
+      doTerm = isTerminalEvent(eventsFound);
+      sol.setEventsSolution(i, tCurrent, u.topRows(numFEEqns), eventsFound);
     }
     if (!eventSatisfied || doTerm) {
-      sol.setSolutionVector(i, tret, u.topRows(numFEEqns));
-      if (numODE)
-        sol.uOde.row(i) = u.bottomRows(numODE);
+      setOutputSolution(sol, i, tCurrent, *uu, *up);
       ++i;
     }
   }
@@ -426,6 +647,533 @@ int PDE1dImpl::solveTransient(PDESolution &sol)
   return 0;
 }
 
+void PDE1dImpl::setOutputSolution(PDESolution &sol, int timeStep, double t,
+  SunVector &y, SunVector &yp)
+{
+  MapVec u(y.data(), totalNumEqns), uDot(yp.data(), totalNumEqns);
+  sol.setSolutionVector(timeStep, t, u.topRows(numFEEqns),
+    u.bottomRows(numODE));
+  if (!sol.needsFlux())
+    return;
+  // flux at the output points from the pde coefficients
+  const RealVector &x = sol.getX();
+  const size_t n = x.size();
+  ConstMapMat uOut(sol.getLastU().data(), numDepVars, n);
+  ConstMapMat duOut(sol.getLastDuDx().data(), numDepVars, n);
+  RealVector vOut = u.bottomRows(numODE), vDotOut = uDot.bottomRows(numODE);
+  PDE1dDefn::PDECoeff coeffs;
+  if (options.isVectorized() && pde.hasVectorPDEEval()) {
+    RealMatrix uPt = uOut, duPt = duOut;
+    coeffs.c.resize(numDepVars, n);
+    coeffs.f.resize(numDepVars, n);
+    coeffs.s.resize(numDepVars, n);
+    pde.evalPDE(x, t, uPt, duPt, vOut, vDotOut, coeffs);
+  }
+  else {
+    RealMatrix f(numDepVars, n);
+    RealVector ui, dUiDx;
+    for (size_t i = 0; i < n; i++) {
+      coeffs.c.resize(numDepVars, 1);
+      coeffs.f.resize(numDepVars, 1);
+      coeffs.s.resize(numDepVars, 1);
+      ui = uOut.col(i);
+      dUiDx = duOut.col(i);
+      pde.evalPDE(x(i), t, ui, dUiDx, vOut, vDotOut, coeffs);
+      f.col(i) = coeffs.f.col(0);
+    }
+    coeffs.f.swap(f);
+  }
+  sol.setFlux(timeStep, coeffs.f);
+}
+
+namespace {
+
+  double changeNorm(const double *u, const RealVector &uLast,
+    PDE1dOptions::ChangeNorm norm)
+  {
+    ConstMapVec uc(u, uLast.size());
+    if (norm == PDE1dOptions::RMSChangeNorm)
+      return (uc - uLast).norm() / std::sqrt((double)uLast.size());
+    return (uc - uLast).lpNorm<Eigen::Infinity>();
+  }
+
+}
+
+int PDE1dImpl::integrateToSolutionChanges(PDESolution &sol)
+{
+  // The integrator takes internal steps to the final time without
+  // stopping at the requested output times. An output is placed, using
+  // the interpolant for the step, wherever the solution has changed by
+  // the tolerance since the previous output.
+  const double tf = tspan(numTimes - 1);
+  const double tol = options.getOutputChangeTol();
+  const PDE1dOptions::ChangeNorm norm = options.getOutputChangeNorm();
+  const double tStopSave = tStop;
+  tStop = tf;
+  MapVec u(uu->data(), totalNumEqns);
+  SunVector uc(totalNumEqns), upc(totalNumEqns);
+  RealVector uLast = u;
+  double tLast = tCurrent;
+  int numEvents = pde.getNumEvents();
+  bool doTerm = false;
+  int i = 1;
+  while (tCurrent < tf && !doTerm) {
+    double tLo = tCurrent;
+    int ier = integrateTo(tf, true);
+    while (changeNorm(uu->data(), uLast, norm) > tol) {
+      // The change need not increase monotonically over the step so the
+      // interpolant is first sampled at a few points to find the first
+      // subinterval where it exceeds the tolerance; that subinterval is
+      // then bisected. A crossing that is undone between two samples is
+      // missed. The change at tLo is never greater than tol and the
+      // output is placed at the last time where it isn't, so successive
+      // outputs differ by at most tol.
+      const int numSamples = 8;
+      double a = tLo, b = tCurrent;
+      for (int k = 1; k < numSamples; k++) {
+        double tk = tLo + k*(tCurrent - tLo) / numSamples;
+        int flag = IDAGetDky(ida, tk, 0, uc.getNV());
+        check_flag(&flag, "IDAGetDky", 1);
+        if (changeNorm(uc.data(), uLast, norm) > tol) {
+          b = tk;
+          break;
+        }
+        a = tk;
+      }
+      for (int k = 0; k < 30; k++) {
+        double tm = (a + b) / 2;
+        int flag = IDAGetDky(ida, tm, 0, uc.getNV());
+        check_flag(&flag, "IDAGetDky", 1);
+        if (changeNorm(uc.data(), uLast, norm) > tol)
+          b = tm;
+        else
+          a = tm;
+      }
+      // only when the crossing is too close to tLo to resolve is the
+      // output placed just past it
+      const double tOut = a > tLo ? a : b;
+      if (tOut >= tCurrent) {
+        setOutputSolution(sol, i++, tCurrent, *uu, *up);
+        uLast = u;
+        tLast = tCurrent;
+        break;
+      }
+      int flag = IDAGetDky(ida, tOut, 0, uc.getNV());
+      check_flag(&flag, "IDAGetDky", 1);
+      flag = IDAGetDky(ida, tOut, 1, upc.getNV());
+      check_flag(&flag, "IDAGetDky", 1);
+      setOutputSolution(sol, i++, tOut, uc, upc);
+      uLast = uc;
+      tLast = tLo = tOut;
+    }
+    if (ier == IDA_ROOT_RETURN) {
+      IntVector eventsFound(numEvents);
+      doTerm = isTerminalEvent(eventsFound);
+      sol.setEventsSolution(i, tCurrent, u.topRows(numFEEqns), eventsFound);
+    }
+    else if (ier == IDA_TSTOP_RETURN && tCurrent < tf)
+      restartAtBreakpoint();
+  }
+  // the final state is always output
+  if (tLast < tCurrent)
+    setOutputSolution(sol, i++, tCurrent, *uu, *up);
+  tStop = tStopSave;
+  return 0;
+}
+
+double PDE1dImpl::wrmsNorm(const Eigen::Ref<const RealVector> &du,
+  const Eigen::Ref<const RealVector> &u, double relTol, double absTol)
+{
+  size_t n = du.size();
+  double sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    double ei = du(i) / (relTol*std::abs(u(i)) + absTol);
+    sum += ei*ei;
+  }
+  return std::sqrt(sum / (double)n);
+}
+
+int PDE1dImpl::solveSteadyState(PDESolution &sol)
+{
+#if SUNDIALS_3
+  RealVector y0(totalNumEqns);
+  getInitConditions(y0);
+  uu = std::unique_ptr<SunVector>(new SunVector(totalNumEqns));
+  up = std::unique_ptr<SunVector>(new SunVector(totalNumEqns));
+  *uu = y0;
+  up->setZero();
+  createLinearSolver();
+
+  // time appears explicitly in the equations only through the
+  // coefficients; they are evaluated at the final time
+  const double tf = tspan(numTimes - 1);
+  bool converged = steadyStateNewton(tf, 50);
+  if (!converged) {
+    if (options.printStats())
+      pdePrintf("Newton iteration for the steady-state solution failed to "
+        "converge; switching to pseudo-transient continuation.\n");
+    *uu = y0;
+    converged = steadyStatePseudoTransient(tf);
+  }
+  if (!converged)
+    throw PDE1dException("pde1d:steady_state_failure",
+      "Unable to calculate a steady-state solution.\n"
+      "The system may not have a steady state or the initial conditions\n"
+      "may be too far from it.");
+  tCurrent = tf;
+
+  setOutputSolution(sol, 0, tCurrent, *uu, *up);
+  sol.close();
+  return 0;
+#else
+  throw PDE1dException("pde1d:steady_state_unavailable",
+    "The steady-state solver requires SUNDIALS version 3 or later.");
+#endif
+}
+
+bool PDE1dImpl::steadyStateLinearSolve(double t, double cj, SunVector &res,
+  SunVector &du)
+{
+#if SUNDIALS_3
+  // solve J*du = -res where J = dR/du + cj*dR/dup
+  calcJacobianODE(t, cj, *uu, *up, res, idaLinSys->A);
+  if (SUNLinSolSetup(idaLinSys->LS, idaLinSys->A))
+    return false;
+  SunVector b(totalNumEqns);
+  b = -res;
+  return SUNLinSolSolve(idaLinSys->LS, idaLinSys->A, du.getNV(),
+    b.getNV(), 0) == 0;
+#else
+  return false;
+#endif
+}
+
+bool PDE1dImpl::steadyStateNewton(double t, int maxIter)
+{
+  const double relTol = options.getRelTol(), absTol = options.getAbsTol();
+  const bool prt = options.printStats();
+  SunVector res(totalNumEqns), du(totalNumEqns), uPrev(totalNumEqns);
+  up->setZero();
+  double resNorm = calcResidualNorm(t, *uu, *up, res);
+  for (int it = 0; it < maxIter; it++) {
+    if (!steadyStateLinearSolve(t, 0, res, du))
+      return false;
+    double duNorm = wrmsNorm(du, *uu, relTol, absTol);
+    // backtracking line search on the residual norm
+    uPrev = *uu;
+    double lambda = 1, newResNorm;
+    while (true) {
+      *uu = uPrev + lambda*du;
+      newResNorm = calcResidualNorm(t, *uu, *up, res);
+      if (std::isfinite(newResNorm) &&
+        newResNorm <= (1 - 1e-4*lambda)*resNorm)
+        break;
+      lambda /= 2;
+      if (lambda < 1. / 64) {
+        *uu = uPrev;
+        return false;
+      }
+    }
+    if (prt)
+      pdePrintf("SteadyState: iter=%d, resNorm=%12.3e, step=%12.3e, "
+        "lambda=%g\n", it + 1, newResNorm, duNorm, lambda);
+    resNorm = newResNorm;
+    if (lambda == 1 && duNorm < 1)
+      return true;
+  }
+  return false;
+}
+
+bool PDE1dImpl::steadyStatePseudoTransient(double t)
+{
+  // Backward Euler steps with a time step that grows as the
+  // steady-state residual decreases (switched evolution relaxation).
+  // Once the residual is small, Newton's method is used to finish.
+  const double relTol = options.getRelTol(), absTol = options.getAbsTol();
+  const bool prt = options.printStats();
+  const int maxSteps = options.getMaxSteps();
+  SunVector res(totalNumEqns), du(totalNumEqns), uOld(totalNumEqns);
+  SunVector upZero(totalNumEqns);
+  upZero.setZero();
+  double dt = 1e-3*(tspan(numTimes - 1) - tspan(0));
+  double ssNorm0 = calcResidualNorm(t, *uu, upZero, res);
+  double ssNorm = ssNorm0;
+  for (int step = 0; step < maxSteps; step++) {
+    uOld = *uu;
+    bool stepConverged = false;
+    for (int it = 0; it < 4 && !stepConverged; it++) {
+      *up = (*uu - uOld) / dt;
+      calcResidualNorm(t, *uu, *up, res);
+      if (!steadyStateLinearSolve(t, 1 / dt, res, du))
+        break;
+      *uu += du;
+      stepConverged = wrmsNorm(du, *uu, relTol, absTol) < 1;
+    }
+    if (!stepConverged) {
+      *uu = uOld;
+      dt /= 4;
+      if (dt < 1e-12*(tspan(numTimes - 1) - tspan(0)))
+        return false;
+      continue;
+    }
+    double ssNormPrev = ssNorm;
+    ssNorm = calcResidualNorm(t, *uu, upZero, res);
+    if (prt)
+      pdePrintf("SteadyState: pseudo-time step=%d, dt=%12.3e, "
+        "resNorm=%12.3e\n", step + 1, dt, ssNorm);
+    if (ssNorm < 1e-3*ssNorm0 || dt > 1e10) {
+      uOld = *uu;
+      if (steadyStateNewton(t, 10))
+        return true;
+      *uu = uOld;
+    }
+    dt *= std::min(10., std::max(.5, ssNormPrev / ssNorm));
+  }
+  return false;
+}
+
+int PDE1dImpl::solvePeriodic(PDESolution &sol)
+{
+  const double period = options.getPeriod(), t0 = tspan(0);
+  if (tspan(numTimes - 1) - t0 > period*(1 + 1e-10)) {
+    char msg[1024];
+    sprintf(msg, "All entries in \"timePts\" must lie within one period, %g,\n"
+      "of the first entry.", period);
+    throw PDE1dException("pde1d:period_time_span", msg);
+  }
+  initTransient();
+  RealVector u0 = *uu;
+  // only the steps of the final periodic solution are recorded
+  PDEDenseOutput *dense = denseOutput;
+  denseOutput = 0;
+  PDEShootingSolver shooting(*this, period);
+  if (!shooting.solve(t0, u0))
+    throw PDE1dException("pde1d:periodic_failure",
+      "Unable to calculate a periodic solution.\n"
+      "The system may not have a stable periodic response with the "
+      "specified period.");
+  denseOutput = dense;
+  resetTransient(t0, u0);
+  return integrateToOutputTimes(sol);
+}
+
+void PDE1dImpl::setDenseOutput(PDEDenseOutput *history)
+{
+  denseOutput = history;
+  if (history)
+    history->reset(totalNumEqns);
+}
+
+void PDE1dImpl::initTransient()
+{
+  RealVector y0(totalNumEqns);
+  getInitConditions(y0);
+  createIntegrator(y0);
+}
+
+bool PDE1dImpl::advance(double tNext, bool stopAtTNext)
+{
+  if (!ida)
+    throw PDE1dException("pde1d:not_initialized",
+      "The time integration must be initialized before it can be advanced.");
+  if (tNext <= tCurrent) {
+    char msg[1024];
+    sprintf(msg, "The requested time, %g, must be greater than the current "
+      "solution time, %g.", tNext, tCurrent);
+    throw PDE1dException("pde1d:decreasing_indep_var", msg);
+  }
+  // when requested, don't let the integrator step past tNext, e.g.
+  // because the equations will be changed at that time
+  if (stopAtTNext)
+    tStop = tNext;
+  int numEvents = pde.getNumEvents();
+  bool doTerm = false;
+  while (tCurrent < tNext && !doTerm) {
+    int ier = integrateTo(tNext);
+    if (ier == IDA_ROOT_RETURN) {
+      IntVector eventsFound(numEvents);
+      doTerm = isTerminalEvent(eventsFound);
+    }
+  }
+  tStop = std::numeric_limits<double>::infinity();
+  return !doTerm;
+}
+
+void PDE1dImpl::reinitTransient()
+{
+  if (!ida)
+    throw PDE1dException("pde1d:not_initialized",
+      "The time integration must be initialized before it can be restarted.");
+  // The algebraic variables and the time derivatives may be discontinuous
+  // so a new consistent set of initial conditions is calculated.
+  PDEInitConditions initCond(ida, *this, *uu, *up);
+  PDEInitConditions::ICPair icPair = initCond.init(tCurrent);
+  int ier = IDAReInit(ida, tCurrent, icPair.first->getNV(),
+    icPair.second->getNV());
+  check_flag(&ier, "IDAReInit", 1);
+  double tf = tspan.tail<1>()[0];
+  if (tf <= tCurrent)
+    tf = tCurrent + (tf - tspan(0));
+  initCond.update(tf);
+  *uu = initCond.getU0();
+  *up = initCond.getUp0();
+}
+
+void PDE1dImpl::resetTransient(double t, const RealVector &u)
+{
+  tCurrent = t;
+  *uu = u;
+  up->setZero();
+  nextBreakpoint = 0;
+  reinitTransient();
+}
+
+int PDE1dImpl::integrateTo(double tout, bool oneStep)
+{
+  while (nextBreakpoint < breakpoints.size() &&
+    breakpoints[nextBreakpoint] <= tCurrent)
+    nextBreakpoint++;
+  while (true) {
+    // the integrator must not step over a breakpoint
+    double ts = tStop;
+    bool stopAtBreakpoint = false;
+    if (nextBreakpoint < breakpoints.size() &&
+      breakpoints[nextBreakpoint] <= ts) {
+      ts = breakpoints[nextBreakpoint];
+      stopAtBreakpoint = true;
+    }
+    // when the steps are recorded one at a time, a step past tout could
+    // return a root beyond it before the solution at tout is output
+    if (denseOutput && !oneStep && tout < ts) {
+      ts = tout;
+      stopAtBreakpoint = false;
+    }
+    if (ts < std::numeric_limits<double>::infinity()) {
+      int ier = IDASetStopTime(ida, ts);
+      check_flag(&ier, "IDASetStopTime", 1);
+    }
+    double tret;
+    int ier;
+    if (denseOutput && !oneStep)
+      ier = solveRecordingSteps(tout, tret);
+    else {
+      ier = IDASolve(ida, tout, &tret, uu->getNV(), up->getNV(),
+        oneStep ? IDA_ONE_STEP : IDA_NORMAL);
+      if (denseOutput && ier >= 0)
+        recordStep();
+    }
+    if (ier < 0) {
+      pdePrintf("Error returned from IDASolve=%d\n", ier);
+      printStats();
+      char msg[1024];
+      sprintf(msg, "Time integration failed at t=%15.6e before reaching final time.\n"
+        "Often this is caused by one or more dependent variables becoming unbounded.",
+        tret);
+      throw PDE1dException("pde1d:integ_failure", msg);
+    }
+    tCurrent = tret;
+    // a breakpoint that is also tout is reported as reaching tout;
+    // in one-step mode the caller restarts after using the last step
+    bool atBreakpoint = stopAtBreakpoint && (ier == IDA_TSTOP_RETURN ||
+      (ier == IDA_SUCCESS && tCurrent >= ts));
+    if (!atBreakpoint || oneStep)
+      return ier;
+    restartAtBreakpoint();
+    nextBreakpoint++;
+    if (tCurrent >= tout)
+      return IDA_SUCCESS;
+  }
+}
+
+int PDE1dImpl::solveRecordingSteps(double tout, double &tret)
+{
+  // Internal steps are taken one at a time so that each is recorded.
+  // The stop time set by integrateTo keeps every step, and so every
+  // root returned, at or before tout. Once a step reaches tout,
+  // IDA_NORMAL mode returns the solution without taking another step.
+  while (true) {
+    double tn;
+    int ier = IDAGetCurrentTime(ida, &tn);
+    check_flag(&ier, "IDAGetCurrentTime", 1);
+    if (tn >= tout)
+      return IDASolve(ida, tout, &tret, uu->getNV(), up->getNV(),
+        IDA_NORMAL);
+    ier = IDASolve(ida, tout, &tret, uu->getNV(), up->getNV(),
+      IDA_ONE_STEP);
+    if (ier < 0)
+      return ier;
+    recordStep();
+    if (ier != IDA_SUCCESS)
+      return ier;
+  }
+}
+
+void PDE1dImpl::recordStep()
+{
+  double tn, hu;
+  int order;
+  int ier = IDAGetCurrentTime(ida, &tn);
+  check_flag(&ier, "IDAGetCurrentTime", 1);
+  ier = IDAGetLastStep(ida, &hu);
+  check_flag(&ier, "IDAGetLastStep", 1);
+  ier = IDAGetLastOrder(ida, &order);
+  check_flag(&ier, "IDAGetLastOrder", 1);
+  // a step is returned again after a root or stop time inside it
+  if (hu <= 0 ||
+    (denseOutput->numSteps() && tn <= denseOutput->endTime()))
+    return;
+  // Taylor coefficients of the interpolating polynomial at tn
+  SunVector dky(totalNumEqns);
+  RealVector taylor(totalNumEqns*(order + 1));
+  double scale = 1;
+  for (int k = 0; k <= order; k++) {
+    ier = IDAGetDky(ida, tn, k, dky.getNV());
+    check_flag(&ier, "IDAGetDky", 1);
+    if (k > 1)
+      scale /= k;
+    taylor.segment(k*totalNumEqns, totalNumEqns) = scale*dky;
+  }
+  denseOutput->addStep(tn, hu, order, taylor.data());
+}
+
+void PDE1dImpl::restartAtBreakpoint()
+{
+  // The solution history from before the discontinuity is not useful
+  // so the integrator is restarted with a low order method.
+  // Consistent initial conditions are recalculated only if the current
+  // solution does not satisfy the equations after the discontinuity.
+  // The residual is measured in the integrator's weighted RMS norm, with
+  // the RelTol and AbsTol weights, so the test does not depend on the
+  // number of equations.
+  // The integrator stepped up to the breakpoint with the equations from
+  // before it so they are evaluated just past it, where those after the
+  // discontinuity apply.
+  const double tBreak = tCurrent;
+  const double tAfter = tBreak +
+    4 * std::numeric_limits<double>::epsilon()*std::max(1., std::abs(tBreak));
+  SunVector res(totalNumEqns), ewt(totalNumEqns);
+  calcResidualNorm(tAfter, *uu, *up, res);
+  int ier = IDAGetErrWeights(ida, ewt.getNV());
+  check_flag(&ier, "IDAGetErrWeights", 1);
+  double resWrms = sqrt(res.cwiseProduct(ewt).squaredNorm() /
+    (double)totalNumEqns);
+  if (resWrms > 1) {
+    tCurrent = tAfter;
+    reinitTransient();
+    tCurrent = tBreak;
+  }
+  ier = IDAReInit(ida, tCurrent, uu->getNV(), up->getNV());
+  check_flag(&ier, "IDAReInit", 1);
+}
+
+bool PDE1dImpl::isTerminalEvent(IntVector &eventsFound)
+{
+  int ier = IDAGetRootInfo(ida, eventsFound.data());
+  check_flag(&ier, "IDAGetRootInfo", 1);
+  MapVec u(uu->data(), totalNumEqns);
+  return pdeEvents->isTerminalEvent(tCurrent, u, eventsFound);
+}
+
 void PDE1dImpl::calcGlobalEqns(double time, SunVector &u, SunVector &up,
   RealVector &Cxd, RealVector &F, RealVector &S)
 {
@@ -554,43 +1302,78 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
   void PDE1dImpl::calcGlobalEqnsVectorized(double t, T &u, T &up,
     TR &Cxd, TR &F, TR &S)
   {
-    bool useDiagMassMat = options.getDiagMassMat();
+    // get the coefficients at all integ pts in a single call
+    size_t numXPts = numIntPts*pdeModel->numElements();
+    setIntPtStorage(numXPts);
+    calcIntPtValues(u.data(), 0);
+    evalIntPtCoeffs(t);
+    assembleVectorized(up.data(), 0, Cxd, F, S);
+  }
+
+  void PDE1dImpl::setIntPtStorage(size_t numPts)
+  {
+    // when the pde definition provides its own argument arrays, the
+    // integration point values are written directly into them
+    double *x, *u, *dudx;
+    useArgBuffers = pde.getPDEArgBuffers(numPts, x, u, dudx);
+    if (!useArgBuffers) {
+      xPts.resize(numPts);
+      uPts.resize(numDepVars, numPts);
+      duPts.resize(numDepVars, numPts);
+      x = xPts.data();
+      u = uPts.data();
+      dudx = duPts.data();
+    }
+    new (&xVals) MapVec(x, numPts);
+    new (&uVals) MapMat(u, numDepVars, numPts);
+    new (&duVals) MapMat(dudx, numDepVars, numPts);
+  }
+
+  void PDE1dImpl::evalIntPtCoeffs(double t)
+  {
+    const size_t numPts = xVals.size();
+    PDE1dDefn::PDECoeffView cv;
+    if (useArgBuffers)
+      pde.evalPDEBuffers(t, v, vDot, cv);
+    else {
+      pdeCoeffs.c.resize(numDepVars, numPts);
+      pdeCoeffs.f.resize(numDepVars, numPts);
+      pdeCoeffs.s.resize(numDepVars, numPts);
+      pde.evalPDE(xPts, t, uPts, duPts, v, vDot, pdeCoeffs);
+      cv.c = pdeCoeffs.c.data();
+      cv.f = pdeCoeffs.f.data();
+      cv.s = pdeCoeffs.s.data();
+    }
+    new (&cVals) ConstMapMat(cv.c, numDepVars, numPts);
+    new (&fVals) ConstMapMat(cv.f, numDepVars, numPts);
+    new (&sVals) ConstMapMat(cv.s, numDepVars, numPts);
+  }
+
+  void PDE1dImpl::calcIntPtValues(const double *u, size_t ipOffset)
+  {
     const ShapeFunctionManager::EvaluatedSF &esf =
       sfm->getShapeFunction(polyOrder);
     const RealMatrix &N = esf.N();
     const RealMatrix &dN = esf.dN();
-    const RealVector &intWts = esf.intRuleWts();
 
     const size_t nnfee = pdeModel->numNodesFEEqns();
     const size_t nen = N.rows();
-    const int m = pde.getCoordSystem();
-    size_t numElemEqns = numDepVars*nen;
-    Cxd.setZero();
 
     //cout << "u=" << u.transpose() << endl;
-    MapMat u2(u.data(), numDepVars, nnfee);
-    MapMat up2(up.data(), numDepVars, nnfee);
-    //cout << "u2=" << u2.transpose() << endl;
-    //cout << "up2=" << up2.transpose() << endl;
+    Eigen::Map<const RealMatrix> u2(u, numDepVars, nnfee);
     RealMatrix u2e(numDepVars, nen);
-    RealVector dNdx(nen), ui(numDepVars), upi(numDepVars), dUiDx(numDepVars);
+    RealVector dNdx(nen);
 
 #if 0
     cout << "intWts=" << intWts.transpose() << endl;
     cout << "N\n" << N << endl;
 #endif
 
-    // get the coefficients at all integ pts in a single call
     size_t ne = pdeModel->numElements();
-    size_t numXPts = numIntPts*ne;
-    xPts.resize(numXPts);
-    uPts.resize(numDepVars, numXPts);
-    duPts.resize(numDepVars, numXPts);
-
     PDEModel::DofList eDofs(nen);
 
     RealVector &x = mesh;
-    int ip = 0;
+    size_t ip = ipOffset;
     for (int e = 0; e < ne; e++) {
       pdeModel->getDofIndicesForElem(e, eDofs);
       PDEModel::globalToElemVec(eDofs, u2, u2e);
@@ -598,17 +1381,38 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
       double L = x(e + 1) - x(e);
       double jac = L / 2;
       for (int i = 0; i < numIntPts; i++) {
-        xPts(ip) = x(e)*N(0, i) + x(e + 1)*N(1, i);
+        xVals(ip) = x(e)*N(0, i) + x(e + 1)*N(1, i);
         dNdx = dN.col(i) / jac;
-        uPts.col(ip) = u2e*N.col(i);
-        duPts.col(ip) = u2e*dNdx;
+        uVals.col(ip) = u2e*N.col(i);
+        duVals.col(ip) = u2e*dNdx;
         ip++;
       }
     }
-    pdeCoeffs.c.resize(numDepVars, numXPts);
-    pdeCoeffs.f.resize(numDepVars, numXPts);
-    pdeCoeffs.s.resize(numDepVars, numXPts);
-    pde.evalPDE(xPts, t, uPts, duPts, v, vDot, pdeCoeffs);
+  }
+
+  void PDE1dImpl::assembleVectorized(const double *up, size_t ipOffset,
+    RealVector &Cxd, RealVector &F, RealVector &S)
+  {
+    bool useDiagMassMat = options.getDiagMassMat();
+    const ShapeFunctionManager::EvaluatedSF &esf =
+      sfm->getShapeFunction(polyOrder);
+    const RealMatrix &N = esf.N();
+    const RealMatrix &dN = esf.dN();
+    const RealVector &intWts = esf.intRuleWts();
+
+    const size_t nnfee = pdeModel->numNodesFEEqns();
+    const size_t nen = N.rows();
+    const int m = pde.getCoordSystem();
+    size_t numElemEqns = numDepVars*nen;
+    Cxd.setZero();
+
+    Eigen::Map<const RealMatrix> up2(up, numDepVars, nnfee);
+    //cout << "up2=" << up2.transpose() << endl;
+    RealVector dNdx(nen), upi(numDepVars);
+    RealVector cIp(numDepVars), sIp(numDepVars), fIp(numDepVars);
+    size_t ne = pdeModel->numElements();
+    PDEModel::DofList eDofs(nen);
+    RealVector &x = mesh;
 
     RealVector eF = RealVector::Zero(numElemEqns);
     MapMat eFX(eF.data(), numDepVars, nen);
@@ -620,7 +1424,7 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
     Eigen::Map<RealVector> eUp(up2e.data(), numElemEqns);
     RealMatrix oNen = RealMatrix::Ones(1, nen);
 
-    ip = 0; 
+    size_t ip = ipOffset;
     for (int e = 0; e < ne; e++) {
       pdeModel->getDofIndicesForElem(e, eDofs);
       PDEModel::globalToElemVec(eDofs, up2, up2e);
@@ -632,20 +1436,17 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
       for (int i = 0; i < numIntPts; i++) {
         // assume two node elements
         double jacWt = jac*intWts(i);
-        double xi = xPts(ip);
+        double xi = xVals(ip);
         dNdx = dN.col(i) / jac;
         upi = up2e * N.col(i);
-        Eigen::Ref<Eigen::VectorXd> cIp = pdeCoeffs.c.col(ip);
-        Eigen::Ref<Eigen::VectorXd> sIp = pdeCoeffs.s.col(ip);
-        Eigen::Ref<Eigen::VectorXd> fIp = pdeCoeffs.f.col(ip);
         double xm = 1;
         if (m == 1)
           xm = xi;
         else if (m == 2)
           xm = xi*xi;
-        cIp *= xm;
-        sIp *= xm;
-        fIp *= xm;
+        cIp = cVals.col(ip) * xm;
+        sIp = sVals.col(ip) * xm;
+        fIp = fVals.col(ip) * xm;
 
         eSX += sIp * N.col(i).transpose() * jacWt;
         eFX += fIp * dNdx.transpose() * jacWt;
@@ -684,6 +1485,10 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
   void PDE1dImpl::calcRHSODE(double time, SunVector &u, SunVector &up, 
     SunVector &R)
 {
+    PDE1dProfiler::Scope prof(&profiler, PDE1dProfiler::Residual);
+#if SUNDIALS_3
+    linSolProfiler = &profiler;
+#endif
     // copy the ode dofs to their own vectors
     if (numODE) {
       v = u.bottomRows(numODE);
@@ -717,10 +1522,22 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
     }
 
   // apply constraints
-  size_t rightDofOff = numFEEqns - numDepVars;
   RealVector ul = u2.col(0), ur = u2.col(nnfe-1);
   const double xl = mesh(0), xr = mesh(mesh.size() - 1);
   pde.evalBC(xl, ul, xr, ur, time, v, vDot, bc);
+  applyBCs(R);
+  R.topRows(numFEEqns) += Cxd;
+#if 0
+  cout << "Cxd\n" << Cxd << endl;
+  cout << "F\n" << F << endl;
+#endif
+  
+}
+
+void PDE1dImpl::applyBCs(Eigen::Ref<RealVector> R)
+{
+  size_t rightDofOff = numFEEqns - numDepVars;
+  const double xl = mesh(0), xr = mesh(mesh.size() - 1);
   const int m = pde.getCoordSystem();
   bool sing = m > 0 && xl == 0;
   for (int i = 0; i < numDepVars; i++) {
@@ -754,12 +1571,47 @@ void PDE1dImpl::calcGlobalEqnsNonVectorized(double t, T &u, T &up,
       Cxd(i + rightDofOff) = 0;
     }
   }
-  R.topRows(numFEEqns) += Cxd;
-#if 0
-  cout << "Cxd\n" << Cxd << endl;
-  cout << "F\n" << F << endl;
-#endif
-  
+}
+
+void PDE1dImpl::calcRHSODEBatch(double time, int numCols, const double *u,
+  const double *up, double *R)
+{
+  PDE1dProfiler::Scope prof(&profiler, PDE1dProfiler::Residual, numCols);
+  // The integration point values for all columns are stacked so that
+  // the pde coefficients are calculated in a single call.
+  const size_t nnfe = pdeModel->numNodesFEEqns();
+  const size_t numXPts = numIntPts*pdeModel->numElements();
+  setIntPtStorage(numXPts*numCols);
+  for (int k = 0; k < numCols; k++)
+    calcIntPtValues(u + k*totalNumEqns, k*numXPts);
+  evalIntPtCoeffs(time);
+
+  // Boundary conditions are a function of the end values only so
+  // they are re-evaluated only for columns where these change.
+  const double xl = mesh(0), xr = mesh(mesh.size() - 1);
+  RealVector ul0, ur0;
+  PDE1dDefn::BC bc0;
+  for (int k = 0; k < numCols; k++) {
+    Eigen::Map<const RealMatrix> u2(u + k*totalNumEqns, numDepVars, nnfe);
+    MapVec Rk(R + k*totalNumEqns, totalNumEqns);
+    F.setZero();
+    S.setZero();
+    assembleVectorized(up + k*totalNumEqns, k*numXPts, Cxd, F, S);
+    Rk.topRows(numFEEqns) = F - S;
+    RealVector ul = u2.col(0), ur = u2.col(nnfe - 1);
+    if (k == 0 || ul != ul0 || ur != ur0) {
+      pde.evalBC(xl, ul, xr, ur, time, v, vDot, bc);
+      if (k == 0) {
+        ul0 = ul;
+        ur0 = ur;
+        bc0 = bc;
+      }
+    }
+    else
+      bc = bc0;
+    applyBCs(Rk);
+    Rk.topRows(numFEEqns) += Cxd;
+  }
 }
 
   void PDE1dImpl::jacobianDiagnostics(double t0, SunVector &u,
@@ -1133,6 +1985,32 @@ void PDE1dImpl::checkIncreasing(const RealVector &v,
   }
 }
 
+void PDE1dImpl::checkIntegratorControls()
+{
+  // zero selects the IDA default
+  const char *name = 0;
+  const char *range = "greater than or equal to zero";
+  if (options.getMaxOrder() < 0 || options.getMaxOrder() > 5) {
+    name = "MaxOrder";
+    range = "between 1 and 5";
+  }
+  else if (!(options.getInitialStep() >= 0))
+    name = "InitialStep";
+  else if (!(options.getMaxStep() >= 0))
+    name = "MaxStep";
+  else if (options.getMaxNonlinIters() < 0)
+    name = "MaxNonlinIters";
+  else if (options.getMaxConvFails() < 0)
+    name = "MaxConvFails";
+  else if (options.getMaxErrTestFails() < 0)
+    name = "MaxErrTestFails";
+  if (name) {
+    char msg[1024];
+    sprintf(msg, "The value of the \"%s\" option must be %s.", name, range);
+    throw PDE1dException((std::string("pde1d:invalid") + name).c_str(), msg);
+  }
+}
+
 void PDE1dImpl::checkCoeffs(const PDE1dDefn::PDECoeff &coeffs)
 {
   for (int j = 0; j < coeffs.c.cols(); j++) {
@@ -1150,6 +2028,86 @@ void PDE1dImpl::checkCoeffs(const PDE1dDefn::PDECoeff &coeffs)
   }
 }
 
+bool PDE1dImpl::probeVectorized()
+{
+  // Evaluate the pde coefficients at a few points with a single call and
+  // compare with the values from calls at each point. The solution
+  // values are taken from the initial conditions and each point is
+  // perturbed differently so that a function that only uses its first
+  // point can't return the same values for all of them when the mesh
+  // has one element or the initial conditions are uniform.
+  const size_t ne = mesh.size() - 1;
+  const size_t numPts = 3;
+  RealVector x(numPts);
+  RealMatrix u(numDepVars, numPts), dudx(numDepVars, numPts);
+  RealVector icl(numDepVars), icr(numDepVars);
+  for (size_t i = 0; i < numPts; i++) {
+    size_t e = i*(ne - 1) / (numPts - 1);
+    double xl = mesh(e), xr = mesh(e + 1);
+    pde.evalIC(xl, icl);
+    pde.evalIC(xr, icr);
+    const double frac = (i + 1.) / (numPts + 1), del = 1e-3*(i + 1);
+    x(i) = xl + frac*(xr - xl);
+    for (size_t j = 0; j < numDepVars; j++) {
+      double uj = icl(j) + frac*(icr(j) - icl(j));
+      u(j, i) = uj + del*std::max(1.0, std::abs(uj));
+      double dj = (icr(j) - icl(j)) / (xr - xl);
+      dudx(j, i) = dj + del*std::max(1.0, std::abs(dj));
+    }
+  }
+  // at least two distinct points are needed to tell the modes apart
+  size_t numDistinct = 1;
+  for (size_t i = 1; i < numPts; i++) {
+    bool distinct = true;
+    for (size_t k = 0; k < i && distinct; k++)
+      distinct = x(i) != x(k) || u.col(i) != u.col(k) ||
+        dudx.col(i) != dudx.col(k);
+    if (distinct)
+      numDistinct++;
+  }
+  if (numDistinct < 2)
+    return false;
+  const double t = tspan(0);
+  if (numODE) {
+    pde.evalODEIC(v);
+    vDot.setZero();
+  }
+
+  PDE1dDefn::PDECoeff vecCoeffs, ptCoeffs;
+  vecCoeffs.c.resize(numDepVars, numPts);
+  vecCoeffs.f.resize(numDepVars, numPts);
+  vecCoeffs.s.resize(numDepVars, numPts);
+  try {
+    pde.evalPDE(x, t, u, dudx, v, vDot, vecCoeffs);
+  }
+  catch (const PDE1dException &) {
+    // the function failed or returned the wrong size
+    return false;
+  }
+  auto same = [](double a, double b) {
+    const double tol = 1e-8;
+    return std::abs(a - b) <= tol*std::max(1.0,
+      std::max(std::abs(a), std::abs(b)));
+  };
+  for (size_t i = 0; i < numPts; i++) {
+    ptCoeffs.c.resize(numDepVars, 1);
+    ptCoeffs.f.resize(numDepVars, 1);
+    ptCoeffs.s.resize(numDepVars, 1);
+    RealVector ui = u.col(i), dudxi = dudx.col(i);
+    pde.evalPDE(x(i), t, ui, dudxi, v, vDot, ptCoeffs);
+    // a coupled mass matrix can't be returned from a vectorized call
+    if (ptCoeffs.c.cols() != 1)
+      return false;
+    for (size_t j = 0; j < numDepVars; j++) {
+      if (!same(ptCoeffs.c(j, 0), vecCoeffs.c(j, i)) ||
+        !same(ptCoeffs.f(j, 0), vecCoeffs.f(j, i)) ||
+        !same(ptCoeffs.s(j, 0), vecCoeffs.s(j, i)))
+        return false;
+    }
+  }
+  return true;
+}
+
 void PDE1dImpl::printStats()
 {
   if (!options.printStats()) return;
@@ -1168,6 +2126,8 @@ void PDE1dImpl::printStats()
   pdePrintf("Last internal time step size = %12.3e\n", hlast);
   pdePrintf("Number of nonlinear iterations = %ld\n", nniters);
   pdePrintf("Number of nonlinear convergence failures = %ld\n", nncfails);
+  if (profiler.isEnabled())
+    profiler.print();
 }
 
 void PDE1dImpl::calcJacPattern(Eigen::SparseMatrix<double> &J)
@@ -1234,6 +2194,8 @@ void PDE1dImpl::calcJacPattern(Eigen::SparseMatrix<double> &J)
 void PDE1dImpl::calcJacobianODE(double time, double beta, SunVector &u, 
   SunVector &up, SunVector &res, SUNMatrix Jac)
 {
+  PDE1dProfiler::Scope prof(&profiler, PDE1dProfiler::Jacobian);
+  linSolProfiler = &profiler;
   SunSparseMap eigJac(Jac);
 #else
 void PDE1dImpl::calcJacobianODE(double time, double beta, SunVector &u,
@@ -1243,8 +2205,12 @@ FiniteDiffJacobian::SparseMap eigJac(Jac->N, Jac->M,
   Jac->NNZ, Jac->indexptrs, Jac->indexvals, Jac->data);
 #endif
   const bool useCD = !true; // use central difference approximation, if true
-  finiteDiffJacobian->calcJacobian(time, 1, beta, u.getNV(), up.getNV(),
-    res.getNV(), resFunc, this, eigJac, useCD);
+  if (useBatchJacobian())
+    finiteDiffJacobian->calcJacobianBatch(time, 1, beta, u.getNV(),
+      up.getNV(), res.getNV(), batchResFunc, this, eigJac);
+  else
+    finiteDiffJacobian->calcJacobian(time, 1, beta, u.getNV(), up.getNV(),
+      res.getNV(), resFunc, this, eigJac, useCD);
 #if 0
 #if SUNDIALS_3
   SUNSparseMatrix_Print(Jac, stdout);
@@ -1257,9 +2223,22 @@ FiniteDiffJacobian::SparseMap eigJac(Jac->N, Jac->M,
 void PDE1dImpl::calcJacobian(double time, double alpha, double beta, SunVector &u,
   SunVector &up, SunVector &R, SparseMat &Jac)
 {
+  PDE1dProfiler::Scope prof(&profiler, PDE1dProfiler::Jacobian);
   const bool useCD = !true; // use central difference approximation, if true
-  finiteDiffJacobian->calcJacobian(time, alpha, beta, u.getNV(), up.getNV(), 
-    R.getNV(), resFunc, this, Jac, useCD);
+  if (useBatchJacobian())
+    finiteDiffJacobian->calcJacobianBatch(time, alpha, beta, u.getNV(),
+      up.getNV(), R.getNV(), batchResFunc, this, Jac);
+  else
+    finiteDiffJacobian->calcJacobian(time, alpha, beta, u.getNV(), up.getNV(),
+      R.getNV(), resFunc, this, Jac, useCD);
+}
+
+bool PDE1dImpl::useBatchJacobian() const
+{
+  // With ODE, each column would need its own ODE variables in the
+  // call to the pde function.
+  return options.getBatchJacobian() && options.isVectorized() &&
+    pde.hasVectorPDEEval() && !numODE;
 }
 
 void PDE1dImpl::calcEvents(double time, const SunVector &u, 
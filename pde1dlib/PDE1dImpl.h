@@ -18,12 +18,14 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include <Eigen/SparseCore>
 typedef Eigen::SparseMatrix<double> SparseMat;
 
 #include "PDE1dDefn.h"
 #include "GausLegendreIntRule.h"
+#include "PDE1dProfiler.h"
 
 #include <nvector/nvector_serial.h>
 #if SUNDIALS_3
@@ -40,13 +42,45 @@ class SunVector;
 class PDEMeshMapper;
 class PDEModel;
 class PDEEvents;
+class PDEDenseOutput;
 
 class PDE1dImpl {
 public:
   PDE1dImpl(PDE1dDefn &pde, PDE1dOptions &options);
   ~PDE1dImpl();
   int solveTransient(PDESolution &sol);
+  // solve the equations with all time derivatives set to zero
+  int solveSteadyState(PDESolution &sol);
+  // calculate the response to forcing with period given in the options
+  int solvePeriodic(PDESolution &sol);
+  // Incremental solution, e.g. for co-simulation with an external model.
+  // initTransient creates the integrator and calculates consistent initial
+  // conditions at the first time point. advance integrates to tNext and
+  // returns false if a terminal event stopped the integration early.
+  // reinitTransient restarts the integrator at the current time; it must be
+  // called after a discontinuous change to the equations.
+  void initTransient();
+  bool advance(double tNext, bool stopAtTNext = false);
+  void reinitTransient();
+  // restart the integration at time t from solution u
+  void resetTransient(double t, const RealVector &u);
+  // record the interpolating polynomial of every integrator step in
+  // history, which is reset to the number of equations; it must exist
+  // until the integration is complete
+  void setDenseOutput(PDEDenseOutput *history);
+  double getCurrentTime() const {
+    return tCurrent;
+  }
+  const SunVector &getCurrentSolution() const {
+    return *uu;
+  }
+  const SunVector &getCurrentSolutionDot() const {
+    return *up;
+  }
   void calcRHSODE(double time, SunVector &u, SunVector &up, SunVector &R);
+  // residuals for numCols solution vectors stored as columns
+  void calcRHSODEBatch(double time, int numCols, const double *u,
+    const double *up, double *R);
 #if SUNDIALS_3
   void calcJacobianODE(double time, double alpha, SunVector &u, 
     SunVector &up, SunVector &R, SUNMatrix Jac);
@@ -66,6 +100,18 @@ void calcJacobianODE(double time, double alpha, SunVector &u,
   const PDEModel &getModel() const {
     return *pdeModel;
   }
+  const PDE1dProfiler &getProfiler() const {
+    return profiler;
+  }
+  // weighted rms norm used by IDA for convergence tests
+  static double wrmsNorm(const Eigen::Ref<const RealVector> &du,
+    const Eigen::Ref<const RealVector> &u, double relTol, double absTol);
+  // solution character found by the AutoTune pilot run, e.g. "rough" or
+  // "smooth"; empty if there was none. The controls it chose are set in
+  // the options.
+  const std::string &getAutoTuneProfile() const {
+    return autoTuneProfile;
+  }
   // for testing only
   void testMats(const RealVector &y0);
   typedef std::vector<RealMatrix> MatrixVec;
@@ -77,6 +123,14 @@ private:
   void calcGlobalEqnsNonVectorized(double t, T &u, T &up, TR &Cxd, TR &F, TR &S);
   template<class T, class TR>
   void calcGlobalEqnsVectorized(double t, T &u, T &up, TR &Cxd, TR &F, TR &S);
+  void setIntPtStorage(size_t numPts);
+  void calcIntPtValues(const double *u, size_t ipOffset);
+  void evalIntPtCoeffs(double t);
+  void assembleVectorized(const double *up, size_t ipOffset,
+    RealVector &Cxd, RealVector &F, RealVector &S);
+  void applyBCs(Eigen::Ref<RealVector> R);
+  bool useBatchJacobian() const;
+  bool probeVectorized();
   void setAlgVarFlags(SunVector &y0, SunVector &y0p, SunVector &id);
   RealMatrix calcDOdeDvDot(double time, const RealMatrix &yFE, 
     const RealMatrix &ypFE, const RealMatrix &r2, RealVector &v, RealVector &vdot);
@@ -85,7 +139,27 @@ private:
   void calcDOdeDu(double time, const RealMatrix &yFE,
     const RealMatrix &ypFE, const RealMatrix &r2, RealVector &v, 
     RealVector &vdot, RealMatrix &jac, RealMatrix &jacDot);
+  void getInitConditions(RealVector &y0);
+  void createIntegrator(const RealVector &y0);
+  void createLinearSolver();
+  void setIntegratorControls();
+  void autoTune(const RealVector &y0);
+  int integrateToOutputTimes(PDESolution &sol);
+  int integrateToSolutionChanges(PDESolution &sol);
+  // store a solution, and the flux when it is requested
+  void setOutputSolution(PDESolution &sol, int timeStep, double t,
+    SunVector &y, SunVector &yp);
+  bool steadyStateLinearSolve(double t, double cj, SunVector &res,
+    SunVector &du);
+  bool steadyStateNewton(double t, int maxIter);
+  bool steadyStatePseudoTransient(double t);
+  int integrateTo(double tout, bool oneStep = false);
+  int solveRecordingSteps(double tout, double &tret);
+  void recordStep();
+  void restartAtBreakpoint();
+  bool isTerminalEvent(IntVector &eventsFound);
   void checkIncreasing(const RealVector &v, int argNum, const char *argName);
+  void checkIntegratorControls();
   void checkCoeffs(const PDE1dDefn::PDECoeff &coeffs);
   void printStats();
   void calcJacPattern(Eigen::SparseMatrix<double> &jac);
@@ -102,6 +176,7 @@ private:
   void printSystemVector(const T& v, const char* name);
   //
   PDE1dDefn &pde;
+  PDE1dProfiler profiler;
   PDE1dOptions &options;
   RealVector mesh, tspan;
   size_t numTimes;
@@ -115,8 +190,23 @@ private:
   // temporary arrays for vectorized mode
   RealVector xPts;
   RealMatrix uPts, duPts;
+  // integration point values passed to the vectorized pde function and
+  // the returned coefficients; these view either the arrays above or
+  // arrays owned by the pde definition
+  MapVec xVals;
+  MapMat uVals, duVals;
+  ConstMapMat cVals, fVals, sVals;
+  bool useArgBuffers;
   std::unique_ptr<FiniteDiffJacobian> finiteDiffJacobian;
   void *ida;
+  struct IDALinSys;
+  std::unique_ptr<IDALinSys> idaLinSys;
+  std::unique_ptr<SunVector> uu, up;
+  double tCurrent, tStop;
+  std::vector<double> breakpoints;
+  size_t nextBreakpoint;
+  std::string autoTuneProfile;
+  PDEDenseOutput *denseOutput;
   std::unique_ptr<ShapeFunction> sf;
   std::unique_ptr<ShapeFunctionManager> sfm;
   std::unique_ptr<PDEMeshMapper> meshMapper;
@@ -126,6 +216,8 @@ private:
   RealMatrix odeU, odeDuDx, odeFlux, odeDuDt, odeDuDxDt;
   IntVector isOdeAConstraint;
   size_t numViewElemsPerElem;
+  // result of the vectorization probe: 1 enabled, -1 disabled, 0 not done
+  int autoVectorized;
 };
 
 #define FUNC_NAME "pde1d"
@@ -0,0 +1,62 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <cstdarg>
+
+#include "PDE1dMessages.h"
+#include "PDE1dWarningMsg.h"
+
+namespace {
+
+  void defaultPrint(const char *msg)
+  {
+    fputs(msg, stdout);
+  }
+
+  void defaultWarning(const char *id, const char *msg)
+  {
+    fprintf(stderr, "Warning: %s, %s\n", id, msg);
+  }
+
+  PDE1dPrintSink printSink = defaultPrint;
+  PDE1dWarningSink warningSink = defaultWarning;
+
+}
+
+void setPDE1dPrintSink(PDE1dPrintSink sink)
+{
+  printSink = sink ? sink : defaultPrint;
+}
+
+void setPDE1dWarningSink(PDE1dWarningSink sink)
+{
+  warningSink = sink ? sink : defaultWarning;
+}
+
+void pdePrintf(const char* format, ...)
+{
+  va_list ap;
+  va_start(ap, format);
+  char msg[4096];
+  vsnprintf(msg, sizeof(msg), format, ap);
+  va_end(ap);
+  printSink(msg);
+}
+
+void PDE1dWarningMsg(const char *id, const char *msg)
+{
+  warningSink(id, msg);
+}
@@ -0,0 +1,32 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dMessages_h
+#define PDE1dMessages_h
+
+/*
+ * Destinations for the messages (pdePrintf) and warnings
+ * (PDE1dWarningMsg) issued by the solver. By default messages are written
+ * to stdout and warnings to stderr; a front end such as the mex file
+ * installs sinks that write to its own console. Setting a null sink
+ * restores the default.
+ */
+typedef void (*PDE1dPrintSink)(const char *msg);
+typedef void (*PDE1dWarningSink)(const char *id, const char *msg);
+
+void setPDE1dPrintSink(PDE1dPrintSink sink);
+void setPDE1dWarningSink(PDE1dWarningSink sink);
+
+#endif
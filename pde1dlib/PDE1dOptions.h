@@ -16,12 +16,16 @@
 #ifndef PDE1dOptions_h
 #define PDE1dOptions_h
 
+#include <vector>
+#include <string>
+
 class PDE1dOptions
 {
 public:
   PDE1dOptions(double relTol = 1e-3, double absTol = 1e-6) :
     relTol(relTol), absTol(absTol) {
     vectorizedFuncs = stats = false;
+    vectorizedAuto = false;
     maxSteps = 10000;
     ICMethod = 0;
     ICDiagnostics = 0;
@@ -30,13 +34,39 @@ public:
     polyOrder = 1;
     viewMesh = 1;
     useDiagMassMat = false;
+    steadyState = false;
+    period = 0;
+    maxOrder = 0;
+    initialStep = maxStep = 0;
+    maxNonlinIters = maxConvFails = maxErrTestFails = 0;
+    autoTune = false;
+    batchJacobian = false;
+    profile = false;
+    outputCoefficients = false;
+    outputPrecision = DoubleOutput;
+    quantizationTol = 0;
+    outputCompression = false;
+    derivedOutputs = 0;
+    outputChangeTol = 0;
+    outputChangeNorm = MaxChangeNorm;
+    denseOutput = false;
+    outputThread = false;
   }
   double getRelTol() const { return relTol;  }
   double getAbsTol() const { return absTol;  }
   void setRelTol(double tol) { relTol = tol; }
   void setAbsTol(double tol) { absTol = tol; }
   bool isVectorized() const { return vectorizedFuncs; }
-  void setVectorized(bool isVec) { vectorizedFuncs = isVec; }
+  void setVectorized(bool isVec) {
+    vectorizedFuncs = isVec;
+    vectorizedAuto = false;
+  }
+  // check whether the pde function accepts vectors of points
+  bool isVectorizedAuto() const { return vectorizedAuto; }
+  void setVectorizedAuto() {
+    vectorizedFuncs = false;
+    vectorizedAuto = true;
+  }
   int getMaxSteps() const { return maxSteps;  }
   void setMaxSteps(int maxSteps) { this->maxSteps = maxSteps;  }
   bool printStats() const { return stats; }
@@ -63,9 +93,87 @@ public:
   bool getDiagMassMat() const {
     return useDiagMassMat;
   }
+  void setSteadyState(bool ss) { steadyState = ss; }
+  bool getSteadyState() const { return steadyState; }
+  // integrator controls; a value of zero uses the IDA default
+  void setMaxOrder(int order) { maxOrder = order; }
+  int getMaxOrder() const { return maxOrder; }
+  void setInitialStep(double h) { initialStep = h; }
+  double getInitialStep() const { return initialStep; }
+  void setMaxStep(double h) { maxStep = h; }
+  double getMaxStep() const { return maxStep; }
+  void setMaxNonlinIters(int n) { maxNonlinIters = n; }
+  int getMaxNonlinIters() const { return maxNonlinIters; }
+  void setMaxConvFails(int n) { maxConvFails = n; }
+  int getMaxConvFails() const { return maxConvFails; }
+  void setMaxErrTestFails(int n) { maxErrTestFails = n; }
+  int getMaxErrTestFails() const { return maxErrTestFails; }
+  void setAutoTune(bool tune) { autoTune = tune; }
+  bool getAutoTune() const { return autoTune; }
+  // evaluate all jacobian perturbations in one vectorized call
+  void setBatchJacobian(bool batch) { batchJacobian = batch; }
+  bool getBatchJacobian() const { return batchJacobian; }
+  // collect call counts and times of user functions and solution phases
+  void setProfile(bool prof) { profile = prof; }
+  bool getProfile() const { return profile; }
+  // period of the forcing for a periodic steady-state solution
+  void setPeriod(double T) { period = T; }
+  double getPeriod() const { return period; }
+  // times where the equations are discontinuous
+  void setBreakpoints(const std::vector<double> &bp) { breakpoints = bp; }
+  const std::vector<double> &getBreakpoints() const {
+    return breakpoints;
+  }
+  // points where the solution is output instead of the mesh points
+  void setOutputX(const std::vector<double> &x) { outputX = x; }
+  const std::vector<double> &getOutputX() const { return outputX; }
+  // also return the finite element coefficients at the output times
+  void setOutputCoefficients(bool out) { outputCoefficients = out; }
+  bool getOutputCoefficients() const { return outputCoefficients; }
+  // storage of the solution history (see PDESolutionCodec.h)
+  enum OutputPrecision { DoubleOutput, SingleOutput, QuantizedOutput };
+  void setOutputPrecision(OutputPrecision prec) { outputPrecision = prec; }
+  OutputPrecision getOutputPrecision() const { return outputPrecision; }
+  void setQuantizationTol(double tol) { quantizationTol = tol; }
+  double getQuantizationTol() const { return quantizationTol; }
+  void setOutputCompression(bool comp) { outputCompression = comp; }
+  bool getOutputCompression() const { return outputCompression; }
+  // values calculated from the solution at each output time
+  enum DerivedOutput { DerivedDuDx = 1, DerivedFlux = 2,
+    DerivedIntegrals = 4 };
+  void setDerivedOutputs(int flags) { derivedOutputs = flags; }
+  int getDerivedOutputs() const { return derivedOutputs; }
+  // when the tolerance is greater than zero, the solution is output
+  // only when it has changed by more than the tolerance since the last
+  // output instead of at the requested times
+  enum ChangeNorm { MaxChangeNorm, RMSChangeNorm };
+  void setOutputChangeTol(double tol) { outputChangeTol = tol; }
+  double getOutputChangeTol() const { return outputChangeTol; }
+  void setOutputChangeNorm(ChangeNorm norm) { outputChangeNorm = norm; }
+  ChangeNorm getOutputChangeNorm() const { return outputChangeNorm; }
+  // record the integrator history so the solution can be evaluated at
+  // any time (see PDEDenseOutput.h), optionally in a file
+  void setDenseOutput(bool dense) { denseOutput = dense; }
+  bool getDenseOutput() const { return denseOutput; }
+  void setDenseOutputFile(const std::string &file) { denseOutputFile = file; }
+  const std::string &getDenseOutputFile() const { return denseOutputFile; }
+  // process the output in a background thread (see PDESolution.h)
+  void setOutputThread(bool useThread) { outputThread = useThread; }
+  bool getOutputThread() const { return outputThread; }
+  // zero-based indices of the mesh points passed to the events function;
+  // empty means all mesh points
+  void setEventsMeshPoints(const std::vector<int> &pts) {
+    eventsMeshPoints = pts;
+  }
+  const std::vector<int> &getEventsMeshPoints() const {
+    return eventsMeshPoints;
+  }
+  // stream the solution to this file (see PDESolutionFile.h)
+  void setOutputFile(const std::string &file) { outputFile = file; }
+  const std::string &getOutputFile() const { return outputFile; }
 private:
   double relTol, absTol;
-  bool vectorizedFuncs;
+  bool vectorizedFuncs, vectorizedAuto;
   int maxSteps;
   bool stats;
   int ICMethod;
@@ -75,6 +183,28 @@ private:
   int polyOrder;
   int viewMesh;
   bool useDiagMassMat;
+  bool steadyState;
+  double period;
+  int maxOrder;
+  double initialStep, maxStep;
+  int maxNonlinIters, maxConvFails, maxErrTestFails;
+  bool autoTune;
+  bool batchJacobian;
+  bool profile;
+  std::vector<double> breakpoints;
+  std::vector<double> outputX;
+  bool outputCoefficients;
+  OutputPrecision outputPrecision;
+  double quantizationTol;
+  bool outputCompression;
+  int derivedOutputs;
+  double outputChangeTol;
+  ChangeNorm outputChangeNorm;
+  bool denseOutput;
+  std::string denseOutputFile;
+  bool outputThread;
+  std::vector<int> eventsMeshPoints;
+  std::string outputFile;
 };
 
 #endif
@@ -0,0 +1,93 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * C interface for problem definitions compiled into a shared library.
+ *
+ * The library must export a function named pde1dPluginInit with the
+ * signature of PDE1dPluginInitFunc. It fills in the problem struct and
+ * returns zero on success. pde1d then calls the entry points directly,
+ * without the overhead of calling functions in the interpreter.
+ *
+ * All arrays are stored in column-major order. Coefficients at multiple
+ * x-locations are numPDE x numPts arrays; the c-coefficient is the diagonal
+ * of the mass matrix. An entry point returns zero on success and any other
+ * value to stop the solution with an error. Entry points for ODE and events
+ * may be null when numODE or numEvents is zero.
+ */
+
+#ifndef PDE1dPlugin_h
+#define PDE1dPlugin_h
+
+#define PDE1D_PLUGIN_ABI_VERSION 1
+#define PDE1D_PLUGIN_INIT_NAME "pde1dPluginInit"
+
+#ifdef _WIN32
+#define PDE1D_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define PDE1D_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PDE1dPluginProblem {
+  /* set to PDE1D_PLUGIN_ABI_VERSION by the plugin */
+  int abiVersion;
+  int numPDE, numODE, numEvents;
+  /* x-locations where the ODE couple with the PDE */
+  int numODEPts;
+  const double *odeMesh;
+  /* passed unchanged as the first argument to all entry points */
+  void *userData;
+
+  /* u0 (numPDE x numPts) at x (numPts) */
+  int (*ic)(void *userData, int numPts, const double *x, double *u0);
+  /* c, f, s (numPDE x numPts) at x (numPts); u and dudx are numPDE x numPts;
+     v and vDot are the ODE variables and their time derivatives */
+  int (*pde)(void *userData, int numPts, const double *x, double t,
+    const double *u, const double *dudx, const double *v, const double *vDot,
+    double *c, double *f, double *s);
+  /* pl, ql, pr, qr (numPDE) */
+  int (*bc)(void *userData, double xl, const double *ul, double xr,
+    const double *ur, double t, const double *v, const double *vDot,
+    double *pl, double *ql, double *pr, double *qr);
+  /* v0 (numODE) */
+  int (*odeIC)(void *userData, double *v0);
+  /* f (numODE); u, dudx, flux, dudt, dudxdt are numPDE x numODEPts */
+  int (*ode)(void *userData, double t, const double *v, const double *vDot,
+    const double *u, const double *dudx, const double *flux,
+    const double *dudt, const double *dudxdt, double *f);
+  /* value, isTerminal, direction (numEvents); u is numPDE x numMeshPts at
+     the events mesh points, x */
+  int (*events)(void *userData, double t, int numMeshPts, const double *x,
+    const double *u, double *value, double *isTerminal, double *direction);
+  /* called before the library is unloaded; may be null */
+  void (*destroy)(void *userData);
+  /* optional zero-based indices of the mesh points where the events
+     depend on the solution; when numEventsPts is zero, events receives
+     the solution at all mesh points */
+  int numEventsPts;
+  const int *eventsPts;
+} PDE1dPluginProblem;
+
+typedef int (*PDE1dPluginInitFunc)(PDE1dPluginProblem *problem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
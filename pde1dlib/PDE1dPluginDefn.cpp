@@ -0,0 +1,222 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "PDE1dPluginDefn.h"
+#include "PDE1dException.h"
+
+namespace {
+
+  void *openLib(const char *path)
+  {
+#ifdef _WIN32
+    return LoadLibraryA(path);
+#else
+    return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+#endif
+  }
+
+  void *getSym(void *lib, const char *name)
+  {
+#ifdef _WIN32
+    return (void*) GetProcAddress((HMODULE)lib, name);
+#else
+    return dlsym(lib, name);
+#endif
+  }
+
+  void closeLib(void *lib)
+  {
+#ifdef _WIN32
+    FreeLibrary((HMODULE)lib);
+#else
+    dlclose(lib);
+#endif
+  }
+
+}
+
+PDE1dPluginDefn::PDE1dPluginDefn(const char *libPath, int m,
+  const RealVector &mesh, const RealVector &tspan) :
+  libPath(libPath), mCoord(m), mesh(mesh), tspan(tspan)
+{
+  memset(&prob, 0, sizeof(prob));
+  char msg[1024];
+  lib = openLib(libPath);
+  if (!lib) {
+#ifdef _WIN32
+    sprintf(msg, "Unable to load the problem definition library \"%s\".",
+      libPath);
+#else
+    sprintf(msg, "Unable to load the problem definition library \"%s\".\n%s",
+      libPath, dlerror());
+#endif
+    throw PDE1dException("pde1d:plugin_load", msg);
+  }
+  PDE1dPluginInitFunc init =
+    (PDE1dPluginInitFunc) getSym(lib, PDE1D_PLUGIN_INIT_NAME);
+  if (!init) {
+    closeLib(lib);
+    sprintf(msg, "The library \"%s\" does not define the function \"%s\".",
+      libPath, PDE1D_PLUGIN_INIT_NAME);
+    throw PDE1dException("pde1d:plugin_init", msg);
+  }
+  int err = init(&prob);
+  const char *invalid = 0;
+  if (err)
+    invalid = "initialization function returned an error";
+  else if (prob.abiVersion != PDE1D_PLUGIN_ABI_VERSION)
+    invalid = "interface version is not supported";
+  else if (prob.numPDE < 1)
+    invalid = "number of PDE must be at least one";
+  else if (!prob.ic || !prob.pde || !prob.bc)
+    invalid = "ic, pde, and bc functions must be defined";
+  else if (prob.numODE && (!prob.ode || !prob.odeIC || !prob.odeMesh))
+    invalid = "ode, odeIC, and odeMesh must be defined when there are ODE";
+  else if (prob.numEvents && !prob.events)
+    invalid = "events function must be defined when there are events";
+  if (invalid) {
+    if (!err && prob.destroy)
+      prob.destroy(prob.userData);
+    closeLib(lib);
+    sprintf(msg, "Invalid problem definition in library \"%s\":\n%s.",
+      libPath, invalid);
+    throw PDE1dException("pde1d:plugin_init", msg);
+  }
+  if (prob.numODE) {
+    odeMesh.resize(prob.numODEPts);
+    std::copy_n(prob.odeMesh, prob.numODEPts, odeMesh.data());
+  }
+  xTmp.resize(1);
+  if (prob.numEvents && prob.numEventsPts > 0 && prob.eventsPts) {
+    try {
+      setEventsMeshPoints(std::vector<int>(prob.eventsPts,
+        prob.eventsPts + prob.numEventsPts));
+    }
+    catch (...) {
+      if (prob.destroy)
+        prob.destroy(prob.userData);
+      closeLib(lib);
+      throw;
+    }
+  }
+}
+
+PDE1dPluginDefn::~PDE1dPluginDefn()
+{
+  if (prob.destroy)
+    prob.destroy(prob.userData);
+  closeLib(lib);
+}
+
+void PDE1dPluginDefn::checkReturn(int err, const char *funcName)
+{
+  if (!err) return;
+  char msg[1024];
+  sprintf(msg, "The \"%s\" function in library \"%s\" returned error code %d.",
+    funcName, libPath.c_str(), err);
+  throw PDE1dException("pde1d:plugin_error", msg);
+}
+
+void PDE1dPluginDefn::evalIC(double x, RealVector &ic)
+{
+  ic.resize(prob.numPDE);
+  checkReturn(prob.ic(prob.userData, 1, &x, ic.data()), "ic");
+}
+
+void PDE1dPluginDefn::evalODEIC(RealVector &ic)
+{
+  ic.resize(prob.numODE);
+  checkReturn(prob.odeIC(prob.userData, ic.data()), "odeIC");
+}
+
+void PDE1dPluginDefn::evalBC(double xl, const RealVector &ul,
+  double xr, const RealVector &ur, double t,
+  const RealVector &v, const RealVector &vDot, BC &bc)
+{
+  const int n = prob.numPDE;
+  bc.pl.resize(n);
+  bc.ql.resize(n);
+  bc.pr.resize(n);
+  bc.qr.resize(n);
+  checkReturn(prob.bc(prob.userData, xl, ul.data(), xr, ur.data(), t,
+    v.data(), vDot.data(), bc.pl.data(), bc.ql.data(), bc.pr.data(),
+    bc.qr.data()), "bc");
+}
+
+void PDE1dPluginDefn::evalPDE(double x, double t,
+  const RealVector &u, const RealVector &DuDx,
+  const RealVector &v, const RealVector &vDot, PDECoeff &pde)
+{
+  xTmp(0) = x;
+  evalPDE(xTmp, t, u, DuDx, v, vDot, pde);
+}
+
+void PDE1dPluginDefn::evalPDE(const RealVector &x, double t,
+  const RealMatrix &u, const RealMatrix &DuDx,
+  const RealVector &v, const RealVector &vDot, PDECoeff &pde)
+{
+  const int n = prob.numPDE, numPts = (int)x.size();
+  pde.c.resize(n, numPts);
+  pde.f.resize(n, numPts);
+  pde.s.resize(n, numPts);
+  checkReturn(prob.pde(prob.userData, numPts, x.data(), t, u.data(),
+    DuDx.data(), v.data(), vDot.data(), pde.c.data(), pde.f.data(),
+    pde.s.data()), "pde");
+}
+
+void PDE1dPluginDefn::evalODE(double t, const RealVector &v,
+  const RealVector &vdot,
+  const RealMatrix &u, const RealMatrix &DuDx,
+  const RealMatrix &odeR, const RealMatrix &odeDuDt,
+  const RealMatrix &odeDuDxDt, RealVector &f)
+{
+  f.resize(prob.numODE);
+  checkReturn(prob.ode(prob.userData, t, v.data(), vdot.data(), u.data(),
+    DuDx.data(), odeR.data(), odeDuDt.data(), odeDuDxDt.data(), f.data()),
+    "ode");
+}
+
+void PDE1dPluginDefn::evalEvents(double t, const RealMatrix &u,
+  RealVector &eventsVal, RealVector &eventsIsTerminal,
+  RealVector &eventsDirection)
+{
+  const int n = prob.numEvents;
+  eventsVal.resize(n);
+  eventsIsTerminal.resize(n);
+  eventsDirection.resize(n);
+  eventsIsTerminal.setZero();
+  eventsDirection.setZero();
+  const double *x = eventsMeshPts.empty() ? mesh.data() : eventsX.data();
+  checkReturn(prob.events(prob.userData, t, (int)u.cols(), x, u.data(),
+    eventsVal.data(), eventsIsTerminal.data(), eventsDirection.data()),
+    "events");
+}
+
+void PDE1dPluginDefn::setEventsMeshPoints(const std::vector<int> &pts)
+{
+  PDE1dDefn::setEventsMeshPoints(pts);
+  eventsX.resize(pts.size());
+  for (size_t i = 0; i < pts.size(); i++)
+    eventsX(i) = mesh(pts[i]);
+}
@@ -0,0 +1,72 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dPluginDefn_h
+#define PDE1dPluginDefn_h
+
+#include <string>
+
+#include "PDE1dDefn.h"
+#include "PDE1dPlugin.h"
+
+/*
+ * Problem definition loaded from a compiled shared library that
+ * implements the interface in PDE1dPlugin.h.
+ */
+class PDE1dPluginDefn : public PDE1dDefn
+{
+public:
+  PDE1dPluginDefn(const char *libPath, int m, const RealVector &mesh,
+    const RealVector &tspan);
+  ~PDE1dPluginDefn();
+  virtual int getNumPDE() const { return prob.numPDE; }
+  virtual int getCoordSystem() const { return mCoord; }
+  virtual void evalIC(double x, RealVector &ic);
+  virtual void evalODEIC(RealVector &ic);
+  virtual void evalBC(double xl, const RealVector &ul,
+    double xr, const RealVector &ur, double t,
+    const RealVector &v, const RealVector &vDot, BC &bc);
+  virtual void evalPDE(double x, double t,
+    const RealVector &u, const RealVector &DuDx,
+    const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual bool hasVectorPDEEval() const { return true; }
+  virtual void evalPDE(const RealVector &x, double t,
+    const RealMatrix &u, const RealMatrix &DuDx,
+    const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual const RealVector &getMesh() const { return mesh; }
+  virtual const RealVector &getTimeSpan() const { return tspan; }
+  virtual int getNumODE() const { return prob.numODE; }
+  virtual void evalODE(double t, const RealVector &v,
+    const RealVector &vdot,
+    const RealMatrix &u, const RealMatrix &DuDx,
+    const RealMatrix &odeR, const RealMatrix &odeDuDt,
+    const RealMatrix &odeDuDxDt, RealVector &f);
+  virtual const RealVector &getODEMesh() { return odeMesh; }
+  virtual int getNumEvents() const { return prob.numEvents; }
+  virtual void evalEvents(double t, const RealMatrix &u,
+    RealVector &eventsVal, RealVector &eventsIsTerminal,
+    RealVector &eventsDirection);
+  virtual void setEventsMeshPoints(const std::vector<int> &pts);
+private:
+  void checkReturn(int err, const char *funcName);
+  void *lib;
+  std::string libPath;
+  PDE1dPluginProblem prob;
+  int mCoord;
+  RealVector mesh, tspan, odeMesh;
+  RealVector xTmp, eventsX;
+};
+
+#endif
@@ -0,0 +1,52 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include <util.h>
+
+#include "PDE1dProfiler.h"
+
+PDE1dProfiler::PDE1dProfiler()
+{
+  enable(false);
+}
+
+void PDE1dProfiler::enable(bool on)
+{
+  enabled = on;
+  Counter zero = { 0, 0, 0 };
+  std::fill_n(counters, (int)NumCategories, zero);
+}
+
+const char *PDE1dProfiler::name(Category cat)
+{
+  static const char *names[] = {
+    "pdeFunc", "bcFunc", "icFunc", "odeFunc", "odeIcFunc", "eventsFunc",
+    "residual", "jacobian", "factorization", "linearSolve"
+  };
+  return names[cat];
+}
+
+void PDE1dProfiler::print() const
+{
+  pdePrintf("%-14s %10s %12s %12s\n", "", "calls", "points", "time (s)");
+  for (int i = 0; i < NumCategories; i++) {
+    const Counter &c = counters[i];
+    if (!c.calls) continue;
+    pdePrintf("%-14s %10ld %12ld %12.4f\n", name((Category)i), c.calls,
+      c.points, c.seconds);
+  }
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dProfiler_h
+#define PDE1dProfiler_h
+
+#include <chrono>
+#include <stddef.h>
+
+/*
+ * Call counts, number of points evaluated, and wall time for the
+ * user-defined functions and the main phases of the solution.
+ * Each solver owns a profiler so that solutions running at the same
+ * time are counted separately.
+ * When profiling is disabled, a Scope costs a single test of a flag.
+ * Times are inclusive; e.g. the residual time includes the
+ * time in the pde function.
+ */
+class PDE1dProfiler {
+public:
+  enum Category {
+    PDEFunc, BCFunc, ICFunc, ODEFunc, ODEICFunc, EventsFunc,
+    Residual, Jacobian, Factorization, LinearSolve, NumCategories
+  };
+  struct Counter {
+    long calls, points;
+    double seconds;
+  };
+  typedef std::chrono::steady_clock Clock;
+  class Scope {
+  public:
+    // prof is null when a function is called outside of a solver
+    Scope(PDE1dProfiler *prof, Category cat, size_t numPoints = 1) {
+      counter = prof && prof->enabled ? &prof->counters[cat] : 0;
+      if (!counter) return;
+      this->numPoints = numPoints;
+      start = Clock::now();
+    }
+    ~Scope() {
+      if (!counter) return;
+      std::chrono::duration<double> dt = Clock::now() - start;
+      counter->calls++;
+      counter->points += (long)numPoints;
+      counter->seconds += dt.count();
+    }
+  private:
+    Counter *counter;
+    size_t numPoints;
+    Clock::time_point start;
+  };
+  PDE1dProfiler();
+  bool isEnabled() const { return enabled; }
+  // enabling also clears all counters
+  void enable(bool on);
+  const Counter &get(Category cat) const { return counters[cat]; }
+  // name used for printing and as a field name in the returned struct
+  static const char *name(Category cat);
+  void print() const;
+private:
+  bool enabled;
+  Counter counters[NumCategories];
+};
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "PDEDenseOutput.h"
+#include "PDE1dException.h"
+
+namespace {
+  const char magic[] = "PDE1DDNS";
+  const uint32_t version = 1;
+}
+
+PDEDenseOutput::PDEDenseOutput(size_t numEqns) : fp(0)
+{
+  reset(numEqns);
+}
+
+PDEDenseOutput::PDEDenseOutput(const std::string &fileName) :
+  fileName(fileName), fp(0)
+{
+  FILE *in = fopen(fileName.c_str(), "rb");
+  if (!in)
+    fileError("open");
+  char m[8];
+  uint32_t hdr[2];
+  bool ok = fread(m, 1, 8, in) == 8 && !memcmp(m, magic, 8) &&
+    fread(hdr, sizeof(uint32_t), 2, in) == 2 && hdr[0] == version;
+  if (ok)
+    reset(hdr[1]);
+  double rec[3];
+  while (ok && fread(rec, sizeof(double), 3, in) == 3) {
+    const size_t n = ((size_t)rec[2] + 1)*numEqns_, off = coeffs.size();
+    coeffs.resize(off + n);
+    ok = fread(coeffs.data() + off, sizeof(double), n, in) == n;
+    tn.push_back(rec[0]);
+    h.push_back(rec[1]);
+    order.push_back((int)rec[2]);
+    offsets.push_back(off);
+  }
+  ok = ok && feof(in);
+  fclose(in);
+  if (!ok)
+    fileError("read");
+}
+
+PDEDenseOutput::PDEDenseOutput(const RealVector &tnIn, const RealVector &hIn,
+  const RealVector &orderIn, const RealMatrix &coeffsIn) : fp(0)
+{
+  reset(coeffsIn.rows());
+  const size_t ns = tnIn.size();
+  size_t numCols = 0;
+  for (size_t i = 0; i < ns && i < (size_t)orderIn.size(); i++)
+    numCols += (size_t)orderIn[i] + 1;
+  if (hIn.size() != ns || orderIn.size() != ns ||
+    numCols != (size_t)coeffsIn.cols())
+    throw PDE1dException("pde1d:eval_args",
+      "The step times, sizes, orders, and coefficients of the solution "
+      "history are inconsistent.");
+  coeffs.assign(coeffsIn.data(), coeffsIn.data() + coeffsIn.size());
+  size_t off = 0;
+  for (size_t i = 0; i < ns; i++) {
+    tn.push_back(tnIn[i]);
+    h.push_back(hIn[i]);
+    order.push_back((int)orderIn[i]);
+    offsets.push_back(off);
+    off += (order[i] + 1)*numEqns_;
+  }
+}
+
+PDEDenseOutput::~PDEDenseOutput()
+{
+  if (fp)
+    fclose(fp);
+}
+
+void PDEDenseOutput::reset(size_t numEqns)
+{
+  numEqns_ = numEqns;
+  tn.clear();
+  h.clear();
+  order.clear();
+  offsets.clear();
+  coeffs.clear();
+}
+
+void PDEDenseOutput::setOutputFile(const std::string &fileName)
+{
+  this->fileName = fileName;
+  fp = fopen(fileName.c_str(), "wb");
+  if (!fp)
+    fileError("open");
+  const uint32_t hdr[] = { version, (uint32_t)numEqns_ };
+  writeData(magic, 8);
+  writeData(hdr, sizeof(hdr));
+}
+
+void PDEDenseOutput::addStep(double t, double hStep, int q,
+  const double *taylor)
+{
+  const size_t n = (q + 1)*numEqns_;
+  tn.push_back(t);
+  h.push_back(hStep);
+  order.push_back(q);
+  if (fp) {
+    const double rec[] = { t, hStep, (double)q };
+    writeData(rec, sizeof(rec));
+    writeData(taylor, n*sizeof(double));
+    return;
+  }
+  offsets.push_back(coeffs.size());
+  coeffs.insert(coeffs.end(), taylor, taylor + n);
+}
+
+void PDEDenseOutput::close()
+{
+  if (!fp) return;
+  int err = fclose(fp);
+  fp = 0;
+  if (err)
+    fileError("write");
+}
+
+void PDEDenseOutput::eval(const RealVector &tq, RealMatrix &y,
+  RealMatrix *yDot) const
+{
+  if (fp || offsets.size() != tn.size())
+    throw PDE1dException("pde1d:eval_args",
+      "The solution history was written to a file; it must be read "
+      "from the file to be evaluated.");
+  const size_t ntq = tq.size(), ns = tn.size();
+  y.resize(numEqns_, ntq);
+  if (yDot)
+    yDot->resize(numEqns_, ntq);
+  if (!ns && ntq)
+    throw PDE1dException("pde1d:eval_args",
+      "The solution history has no steps.");
+  const double t0 = startTime(), tf = endTime();
+  const double tol = 100 * std::numeric_limits<double>::epsilon()*
+    std::max(std::abs(t0), std::abs(tf));
+  for (size_t j = 0; j < ntq; j++) {
+    const double t = tq[j];
+    if (t < t0 - tol || t > tf + tol) {
+      char msg[256];
+      sprintf(msg, "Time %12.3e is outside the solution history, "
+        "[%12.3e, %12.3e].", t, t0, tf);
+      throw PDE1dException("pde1d:eval_args", msg);
+    }
+    // the first step ending at or after t
+    size_t i = std::lower_bound(tn.begin(), tn.end(), t) - tn.begin();
+    i = std::min(i, ns - 1);
+    const int q = order[i];
+    ConstMapMat c(coeffs.data() + offsets[i], numEqns_, q + 1);
+    const double s = t - tn[i];
+    // Horner's rule for the polynomial and its derivative
+    y.col(j) = c.col(q);
+    if (yDot)
+      yDot->col(j).setZero();
+    for (int k = q - 1; k >= 0; k--) {
+      if (yDot)
+        yDot->col(j) = yDot->col(j)*s + y.col(j);
+      y.col(j) = y.col(j)*s + c.col(k);
+    }
+  }
+}
+
+void PDEDenseOutput::writeData(const void *p, size_t numBytes)
+{
+  if (!fp || fwrite(p, 1, numBytes, fp) != numBytes)
+    fileError("write");
+}
+
+void PDEDenseOutput::fileError(const char *action) const
+{
+  char msg[1024];
+  snprintf(msg, sizeof(msg), "Unable to %s solution history file \"%s\".",
+    action, fileName.c_str());
+  throw PDE1dException("pde1d:solution_file", msg);
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <MatrixTypes.h>
+
+/*
+ * History of the integrator's interpolating polynomials, one for each
+ * accepted step, from which the solution is reconstructed at any time
+ * with the accuracy of the integration. Step i covers
+ * [tn(i) - h(i), tn(i)] and is stored as the Taylor coefficients,
+ * y^(k)(tn)/k! for k = 0..order, of the interpolant at tn.
+ *
+ * File: char magic[8] = "PDE1DDNS", uint32 version, numEqns, and one
+ *       record per step; double tn, h, order, and the
+ *       (order + 1)*numEqns coefficients
+ */
+class PDEDenseOutput {
+public:
+  PDEDenseOutput(size_t numEqns = 0);
+  // a history previously written to a file
+  explicit PDEDenseOutput(const std::string &fileName);
+  // a history from the arrays returned by stepTimes, etc.
+  PDEDenseOutput(const RealVector &tn, const RealVector &h,
+    const RealVector &order, const RealMatrix &coeffs);
+  ~PDEDenseOutput();
+  void reset(size_t numEqns);
+  // write the coefficients to this file instead of holding them in
+  // memory
+  void setOutputFile(const std::string &fileName);
+  void addStep(double tn, double h, int order, const double *taylor);
+  void close();
+  size_t numEqns() const { return numEqns_; }
+  size_t numSteps() const { return tn.size(); }
+  double startTime() const { return tn.empty() ? 0 : tn[0] - h[0]; }
+  double endTime() const { return tn.empty() ? 0 : tn.back(); }
+  // solution and, optionally, its time derivative at each tq(j) in
+  // column j
+  void eval(const RealVector &tq, RealMatrix &y,
+    RealMatrix *yDot = 0) const;
+  const std::vector<double> &stepTimes() const { return tn; }
+  const std::vector<double> &stepSizes() const { return h; }
+  const std::vector<int> &orders() const { return order; }
+  // numEqns x sum(order + 1) with the coefficients for each step in
+  // consecutive columns
+  ConstMapMat coefficients() const {
+    return ConstMapMat(coeffs.data(), numEqns_,
+      numEqns_ ? coeffs.size() / numEqns_ : 0);
+  }
+private:
+  void writeData(const void *p, size_t numBytes);
+  void fileError(const char *action) const;
+  size_t numEqns_;
+  std::vector<double> tn, h, coeffs;
+  std::vector<int> order;
+  std::vector<size_t> offsets;
+  std::string fileName;
+  FILE *fp;
+};
@@ -8,6 +8,8 @@ PDEEvents::PDEEvents(PDE1dDefn &pde, PDEModel &pdeModel) :
   pde(pde), pdeModel(pdeModel)
 {
   numEvents = pde.getNumEvents();
+  haveLast = false;
+  lastTime = 0;
   if (numEvents) {
     size_t nn = pde.getMesh().size();
     int numPde = pde.getNumPDE();
@@ -15,25 +17,48 @@ PDEEvents::PDEEvents(PDE1dDefn &pde, PDEModel &pdeModel) :
     eventsIsTerminal.resize(numEvents);
     eventsDirection.resize(numEvents);
     eventsDirection.setZero();
-    eventsU.resize(numPde, nn);
+    IntVector meshCols(nn);
+    meshCols(0) = 0;
+    for (int i = 0; i < pdeModel.numElements(); i++)
+      meshCols(i + 1) = meshCols(i) + pdeModel.element(i).numNodes() - 1;
+    const std::vector<int> &pts = pde.getEventsMeshPoints();
+    if (pts.empty())
+      eventsCols = meshCols;
+    else {
+      eventsCols.resize(pts.size());
+      for (size_t i = 0; i < pts.size(); i++)
+        eventsCols(i) = meshCols(pts[i]);
+    }
+    eventsU.resize(numPde, eventsCols.size());
   }
 }
 
-void PDEEvents::calcEvents(double time, const RealVector &u, double *gOut)
+void PDEEvents::evalEvents(double time, const RealVector &u)
 {
-  MapVec g(gOut, numEvents);
-  pdeModel.globalToMeshVec(u, eventsU);
+  const int numPde = eventsU.rows();
+  ConstMapMat gM(u.data(), numPde, pdeModel.numNodesFEEqns());
+  for (int i = 0; i < eventsCols.size(); i++)
+    eventsU.col(i) = gM.col(eventsCols(i));
+  if (haveLast && time == lastTime && eventsU == lastEventsU)
+    return;
   pde.evalEvents(time, eventsU, eventsVal, eventsIsTerminal,
     eventsDirection);
+  lastTime = time;
+  lastEventsU = eventsU;
+  haveLast = true;
+}
+
+void PDEEvents::calcEvents(double time, const RealVector &u, double *gOut)
+{
+  MapVec g(gOut, numEvents);
+  evalEvents(time, u);
   g = eventsVal;
 }
 
 bool PDEEvents::isTerminalEvent(double time, const RealVector &u,
   const IntVector &eventsFound) {
   bool doTerm = false;
-  pdeModel.globalToMeshVec(u, eventsU);
-  pde.evalEvents(time, eventsU, eventsVal, eventsIsTerminal,
-    eventsDirection);
+  evalEvents(time, u);
   for (int j = 0; j < numEvents; j++) {
     int jFlag = eventsFound(j);
 #if 0
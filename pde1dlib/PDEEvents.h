@@ -5,6 +5,14 @@
 class PDE1dDefn;
 class PDEModel;
 
+/*
+ * Evaluates the user-defined events from the global solution vector.
+ * Only the solution at the mesh points returned by
+ * PDE1dDefn::getEventsMeshPoints is gathered, and the results of the
+ * last evaluation are reused when called again with the same t and u,
+ * as happens when IDA reports a root and the events are checked for
+ * termination.
+ */
 class PDEEvents
 {
 public:
@@ -14,9 +22,13 @@ public:
     const IntVector &eventsFound);
   ~PDEEvents();
 private:
+  void evalEvents(double time, const RealVector &u);
   int numEvents;
   RealVector eventsVal, eventsIsTerminal, eventsDirection;
-  RealMatrix eventsU;
+  RealMatrix eventsU, lastEventsU;
+  IntVector eventsCols; // column of each events point in the FE solution
+  double lastTime;
+  bool haveLast;
   PDE1dDefn &pde;
   const PDEModel &pdeModel;
 };
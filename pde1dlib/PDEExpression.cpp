@@ -0,0 +1,340 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+
+#include "PDEExpression.h"
+#include "PDE1dException.h"
+
+namespace {
+
+  typedef double(*Func1Ptr)(double);
+  typedef double(*Func2Ptr)(double, double);
+
+  double sign(double a) { return (a > 0) - (a < 0); }
+  double min2(double a, double b) { return std::min(a, b); }
+  double max2(double a, double b) { return std::max(a, b); }
+
+  struct Func1Defn {
+    const char *name;
+    Func1Ptr f;
+  };
+  const Func1Defn func1Table[] = {
+    { "sin", ::sin }, { "cos", ::cos }, { "tan", ::tan },
+    { "asin", ::asin }, { "acos", ::acos }, { "atan", ::atan },
+    { "sinh", ::sinh }, { "cosh", ::cosh }, { "tanh", ::tanh },
+    { "exp", ::exp }, { "log", ::log }, { "log10", ::log10 },
+    { "sqrt", ::sqrt }, { "abs", ::fabs }, { "floor", ::floor },
+    { "ceil", ::ceil }, { "sign", sign }
+  };
+
+  struct Func2Defn {
+    const char *name;
+    Func2Ptr f;
+  };
+  const Func2Defn func2Table[] = {
+    { "atan2", ::atan2 }, { "pow", ::pow }, { "min", min2 }, { "max", max2 }
+  };
+
+  template<class T, size_t N>
+  int findFunc(const T (&table)[N], const std::string &name)
+  {
+    for (size_t i = 0; i < N; i++)
+      if (name == table[i].name)
+        return (int)i;
+    return -1;
+  }
+
+}
+
+PDEExpression::PDEExpression(const std::string &expr, const VarMap &vars,
+  const ParamMap &params, const PDETable::TableMap &tables) :
+  text(expr), pos(0), vars(&vars), params(&params), tables(&tables)
+{
+  numRegs = 1;
+  parseComparison(0);
+  skipSpace();
+  if (pos < text.size())
+    syntaxError("unexpected character");
+  regs.resize(numRegs);
+  this->vars = 0;
+  this->params = 0;
+  this->tables = 0;
+}
+
+void PDEExpression::eval(const Var *vars, size_t n, double *out,
+  size_t outStride)
+{
+  for (auto &r : regs)
+    if (r.size() < n) r.resize(n);
+  for (const Instr &in : code) {
+    double *d = regs[in.dst].data();
+    const double *a = regs[in.a].data(), *b = regs[in.b].data();
+    switch (in.op) {
+    case LoadConst:
+      std::fill_n(d, n, in.val);
+      break;
+    case LoadVar: {
+      const Var &v = vars[(int)in.val];
+      for (size_t i = 0; i < n; i++)
+        d[i] = v.p[i*v.stride];
+      break;
+    }
+    case Neg:
+      for (size_t i = 0; i < n; i++) d[i] = -a[i];
+      break;
+    case Add:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] + b[i];
+      break;
+    case Sub:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] - b[i];
+      break;
+    case Mul:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] * b[i];
+      break;
+    case Div:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] / b[i];
+      break;
+    case Pow:
+      for (size_t i = 0; i < n; i++) d[i] = std::pow(a[i], b[i]);
+      break;
+    case Lt:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] < b[i];
+      break;
+    case Gt:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] > b[i];
+      break;
+    case Le:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] <= b[i];
+      break;
+    case Ge:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] >= b[i];
+      break;
+    case Eq:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] == b[i];
+      break;
+    case Ne:
+      for (size_t i = 0; i < n; i++) d[i] = a[i] != b[i];
+      break;
+    case Func1: {
+      Func1Ptr f = func1Table[(int)in.val].f;
+      for (size_t i = 0; i < n; i++) d[i] = f(a[i]);
+      break;
+    }
+    case Func2: {
+      Func2Ptr f = func2Table[(int)in.val].f;
+      for (size_t i = 0; i < n; i++) d[i] = f(a[i], b[i]);
+      break;
+    }
+    case Table: {
+      const PDETable &tab = *tableRefs[(int)in.val];
+      if (tab.numArgs() == 1)
+        tab.eval(a, n, d);
+      else
+        tab.eval(a, b, n, d);
+      break;
+    }
+    }
+  }
+  const double *r = regs[0].data();
+  for (size_t i = 0; i < n; i++)
+    out[i*outStride] = r[i];
+}
+
+void PDEExpression::emit(OpCode op, int dst, int a, int b, double val)
+{
+  Instr in = { op, dst, a, b, val };
+  code.push_back(in);
+  numRegs = std::max(numRegs, std::max(dst, std::max(a, b)) + 1);
+}
+
+void PDEExpression::skipSpace()
+{
+  while (pos < text.size() && isspace((unsigned char)text[pos]))
+    pos++;
+}
+
+bool PDEExpression::match(const char *tok)
+{
+  skipSpace();
+  size_t len = strlen(tok);
+  if (text.compare(pos, len, tok) == 0) {
+    pos += len;
+    return true;
+  }
+  return false;
+}
+
+void PDEExpression::syntaxError(const char *msg)
+{
+  char buf[1024];
+  snprintf(buf, sizeof(buf), "Error in expression \"%s\" at position %d:\n%s.",
+    text.c_str(), (int)pos + 1, msg);
+  throw PDE1dException("pde1d:expression_syntax", buf);
+}
+
+void PDEExpression::parseComparison(int dst)
+{
+  parseSum(dst);
+  OpCode op;
+  if (match("<=")) op = Le;
+  else if (match(">=")) op = Ge;
+  else if (match("==")) op = Eq;
+  else if (match("~=") || match("!=")) op = Ne;
+  else if (match("<")) op = Lt;
+  else if (match(">")) op = Gt;
+  else return;
+  parseSum(dst + 1);
+  emit(op, dst, dst, dst + 1);
+}
+
+void PDEExpression::parseSum(int dst)
+{
+  parseProduct(dst);
+  while (true) {
+    OpCode op;
+    if (match("+")) op = Add;
+    else if (match("-")) op = Sub;
+    else return;
+    parseProduct(dst + 1);
+    emit(op, dst, dst, dst + 1);
+  }
+}
+
+void PDEExpression::parseProduct(int dst)
+{
+  parseUnary(dst);
+  while (true) {
+    OpCode op;
+    if (match(".*") || match("*")) op = Mul;
+    else if (match("./") || match("/")) op = Div;
+    else return;
+    parseUnary(dst + 1);
+    emit(op, dst, dst, dst + 1);
+  }
+}
+
+void PDEExpression::parseUnary(int dst)
+{
+  if (match("-")) {
+    parseUnary(dst);
+    emit(Neg, dst, dst);
+  }
+  else if (match("+"))
+    parseUnary(dst);
+  else
+    parsePower(dst);
+}
+
+void PDEExpression::parsePower(int dst)
+{
+  parsePrimary(dst);
+  // left associative as in MATLAB, 2^3^2 is 64; binds tighter than unary
+  // minus on the left, -2^2 is -4, but the exponent may have a sign, 2^-1
+  while (match(".^") || match("^")) {
+    bool neg = false;
+    while (true) {
+      if (match("-")) neg = !neg;
+      else if (!match("+")) break;
+    }
+    parsePrimary(dst + 1);
+    if (neg)
+      emit(Neg, dst + 1, dst + 1);
+    emit(Pow, dst, dst, dst + 1);
+  }
+}
+
+void PDEExpression::parsePrimary(int dst)
+{
+  skipSpace();
+  if (pos >= text.size())
+    syntaxError("unexpected end of expression");
+  char ch = text[pos];
+  if (isdigit((unsigned char)ch) || (ch == '.' && pos + 1 < text.size() &&
+    isdigit((unsigned char)text[pos + 1]))) {
+    const char *start = text.c_str() + pos;
+    char *end;
+    double val = strtod(start, &end);
+    pos += end - start;
+    emit(LoadConst, dst, 0, 0, val);
+  }
+  else if (isalpha((unsigned char)ch) || ch == '_') {
+    size_t start = pos;
+    while (pos < text.size() &&
+      (isalnum((unsigned char)text[pos]) || text[pos] == '_'))
+      pos++;
+    std::string name = text.substr(start, pos - start);
+    PDETable::TableMap::const_iterator tab = tables->find(name);
+    if (tab != tables->end() && match("(")) {
+      parseComparison(dst);
+      if (tab->second->numArgs() == 2) {
+        if (!match(","))
+          syntaxError("expected \",\"; table requires two arguments");
+        parseComparison(dst + 1);
+      }
+      tableRefs.push_back(tab->second);
+      emit(Table, dst, dst, tab->second->numArgs() == 2 ? dst + 1 : 0,
+        (double)(tableRefs.size() - 1));
+      if (!match(")"))
+        syntaxError("expected \")\"");
+    }
+    else if (match("(")) {
+      int f1 = findFunc(func1Table, name), f2 = findFunc(func2Table, name);
+      if (f1 < 0 && f2 < 0) {
+        pos = start;
+        syntaxError(("unknown function \"" + name + "\"").c_str());
+      }
+      parseComparison(dst);
+      if (f2 >= 0) {
+        if (!match(","))
+          syntaxError("expected \",\"; function requires two arguments");
+        parseComparison(dst + 1);
+        emit(Func2, dst, dst, dst + 1, f2);
+      }
+      else
+        emit(Func1, dst, dst, 0, f1);
+      if (!match(")"))
+        syntaxError("expected \")\"");
+    }
+    else {
+      VarMap::const_iterator v = vars->find(name);
+      ParamMap::const_iterator p = params->find(name);
+      if (v != vars->end())
+        emit(LoadVar, dst, 0, 0, v->second);
+      else if (p != params->end())
+        emit(LoadConst, dst, 0, 0, p->second);
+      else if (name == "pi")
+        emit(LoadConst, dst, 0, 0, 3.14159265358979323846);
+      else if (name == "e")
+        emit(LoadConst, dst, 0, 0, 2.71828182845904523536);
+      else {
+        pos = start;
+        syntaxError(("unknown variable or parameter \"" + name + "\"").c_str());
+      }
+    }
+  }
+  else if (match("(")) {
+    parseComparison(dst);
+    if (!match(")"))
+      syntaxError("expected \")\"");
+  }
+  else
+    syntaxError("unexpected character");
+}
@@ -0,0 +1,87 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1DLIB_PDEEXPRESSION_H_
+#define PDE1DLIB_PDEEXPRESSION_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "PDETable.h"
+
+/*
+ * An arithmetic expression compiled to register-based bytecode that
+ * is evaluated at many points in a single call.
+ *
+ * Syntax follows MATLAB: + - * / ^ (and .* ./ .^), unary minus,
+ * comparisons < > <= >= == ~= (result is 1 or 0), parentheses,
+ * numbers, the constants pi and e, variables, parameters, and the functions
+ * sin cos tan asin acos atan sinh cosh tanh exp log log10 sqrt abs
+ * floor ceil sign atan2 min max. Tables are called like functions with
+ * one or two arguments.
+ */
+class PDEExpression {
+public:
+  typedef std::map<std::string, double> ParamMap;
+  // names of the variables and their index in the array passed to eval
+  typedef std::map<std::string, int> VarMap;
+  PDEExpression(const std::string &expr, const VarMap &vars,
+    const ParamMap &params,
+    const PDETable::TableMap &tables = PDETable::TableMap());
+  // values of a variable at successive points are stride apart;
+  // a stride of zero means the same value is used at all points
+  struct Var {
+    const double *p;
+    size_t stride;
+  };
+  void eval(const Var *vars, size_t n, double *out, size_t outStride = 1);
+  const std::string &getText() const { return text; }
+private:
+  enum OpCode {
+    LoadConst, LoadVar, Neg, Add, Sub, Mul, Div, Pow,
+    Lt, Gt, Le, Ge, Eq, Ne, Func1, Func2, Table
+  };
+  struct Instr {
+    OpCode op;
+    int dst, a, b;
+    double val;
+  };
+  // parser; each function leaves its result in register dst
+  void parseComparison(int dst);
+  void parseSum(int dst);
+  void parseProduct(int dst);
+  void parseUnary(int dst);
+  void parsePower(int dst);
+  void parsePrimary(int dst);
+  void emit(OpCode op, int dst, int a = 0, int b = 0, double val = 0);
+  void skipSpace();
+  bool match(const char *tok);
+  void syntaxError(const char *msg);
+  std::string text;
+  size_t pos;
+  // only set while the expression is compiled; the arguments may be
+  // temporaries
+  const VarMap *vars;
+  const ParamMap *params;
+  const PDETable::TableMap *tables;
+  std::vector<std::shared_ptr<const PDETable>> tableRefs;
+  std::vector<Instr> code;
+  int numRegs;
+  std::vector<std::vector<double>> regs;
+};
+
+#endif /* PDE1DLIB_PDEEXPRESSION_H_ */
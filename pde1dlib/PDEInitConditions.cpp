@@ -70,10 +70,8 @@ PDEInitConditions::PDEInitConditions(void *idaMem, PDE1dImpl &pdeImpl,
 
 }
 
-PDEInitConditions::ICPair PDEInitConditions::init() {
+PDEInitConditions::ICPair PDEInitConditions::init(double t0) {
   ICPair icPair;
-  const RealVector &tspan = pdeImpl.getTimePoints();
-  double t0 = tspan[0];
   if (!icMeth) {
     calcShampineAlgo(t0, *u0C, *up0C);
     icPair.first = u0C.get();
@@ -251,17 +249,15 @@ void PDEInitConditions::icFailErr()
     "Often this is caused by an incorrect specification of the boundary conditions.");
 }
 
-void PDEInitConditions::update()
+void PDEInitConditions::update(double tout1)
 {
-  const RealVector &tspan = pdeImpl.getTimePoints();
   if (icMeth > 0) {
-    double tf = tspan.tail<1>()[0];
     int ier;
     if (icMeth == 1) {
-      ier = IDACalcIC(idaMem, IDA_YA_YDP_INIT, tf);
+      ier = IDACalcIC(idaMem, IDA_YA_YDP_INIT, tout1);
     }
     else if (icMeth == 2) {
-      ier = IDACalcIC(idaMem, IDA_Y_INIT, tf);
+      ier = IDACalcIC(idaMem, IDA_Y_INIT, tout1);
     }
     else
       throw PDE1dException("pde1d:consistent_ic_invalid_method",
@@ -33,8 +33,8 @@ public:
   PDEInitConditions(void *idaMem, PDE1dImpl &pdeImpl,
     const SunVector &u0, const SunVector &up0);
   typedef std::pair<SunVector*, SunVector*> ICPair;
-  ICPair init();
-  void update();
+  ICPair init(double t0);
+  void update(double tout1);
   const SunVector &getU0() {
     return *u0C.get();
   }
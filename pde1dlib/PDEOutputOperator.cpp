@@ -0,0 +1,96 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <vector>
+
+#include "PDEOutputOperator.h"
+#include "PDEModel.h"
+#include "PDE1dException.h"
+#include "ShapeFunctionManager.h"
+
+PDEOutputOperator::PDEOutputOperator(const RealVector &mesh,
+  const PDEModel &model, size_t numPDE, const RealVector &xOut,
+  bool calcDeriv)
+{
+  const size_t numOut = xOut.size(), numMesh = mesh.size();
+  const double tol = 100 * std::numeric_limits<double>::epsilon()*
+    (mesh[numMesh - 1] - mesh[0]);
+  const double *begin = mesh.data(), *end = begin + numMesh;
+  typedef Eigen::Triplet<double> Triplet;
+  std::vector<Triplet> entries;
+  PDEModel::DofList eDofs;
+  RealVector N;
+  for (size_t i = 0; i < numOut; i++) {
+    const double xi = xOut[i];
+    if (xi < mesh[0] - tol || xi > mesh[numMesh - 1] + tol) {
+      char msg[256];
+      sprintf(msg, "Output point %12.3e is outside the mesh, "
+        "[%12.3e, %12.3e].", xi, mesh[0], mesh[numMesh - 1]);
+      throw PDE1dException("pde1d:invalid_output_point", msg);
+    }
+    size_t indRight = std::lower_bound(begin, end, xi) - begin;
+    indRight = std::min(std::max(indRight, (size_t)1), numMesh - 1);
+    const int e = (int)indRight - 1;
+    const double L = mesh[indRight] - mesh[e];
+    const double r = std::min(std::max(2 * (xi - mesh[e]) / L - 1, -1.), 1.);
+    const PDEElement &elem = model.element(e);
+    const ShapeFunction &sf = elem.getSF().getShapeFunction();
+    model.getDofIndicesForElem(e, eDofs);
+    const int nn = sf.numNodes();
+    N.resize(nn);
+    if (calcDeriv) {
+      sf.dNdr(r, N.data());
+      N *= 2 / L;
+    }
+    else
+      sf.N(r, N.data());
+    for (int j = 0; j < nn; j++)
+      for (size_t k = 0; k < numPDE; k++)
+        entries.push_back(Triplet(k + numPDE*i, k + numPDE*eDofs[j], N[j]));
+  }
+  op.resize(numPDE*numOut, numPDE*model.numNodesFEEqns());
+  op.setFromTriplets(entries.begin(), entries.end());
+}
+
+PDEOutputOperator PDEOutputOperator::integrals(const RealVector &mesh,
+  const PDEModel &model, size_t numPDE, int m)
+{
+  typedef Eigen::Triplet<double> Triplet;
+  std::vector<Triplet> entries;
+  PDEModel::DofList eDofs;
+  const size_t ne = model.numElements();
+  for (size_t e = 0; e < ne; e++) {
+    const ShapeFunctionManager::EvaluatedSF &esf = model.element(e).getSF();
+    const RealMatrix &N = esf.N();
+    const RealVector &intWts = esf.intRuleWts();
+    model.getDofIndicesForElem(e, eDofs);
+    const double jac = (mesh[e + 1] - mesh[e]) / 2;
+    for (int i = 0; i < intWts.size(); i++) {
+      double xi = mesh[e] * N(0, i) + mesh[e + 1] * N(1, i);
+      double wt = jac*intWts[i] * std::pow(xi, m);
+      for (int j = 0; j < N.rows(); j++)
+        for (size_t k = 0; k < numPDE; k++)
+          entries.push_back(Triplet(k, k + numPDE*eDofs[j], wt*N(j, i)));
+    }
+  }
+  PDEOutputOperator intOp;
+  intOp.op.resize(numPDE, numPDE*model.numNodesFEEqns());
+  intOp.op.setFromTriplets(entries.begin(), entries.end());
+  return intOp;
+}
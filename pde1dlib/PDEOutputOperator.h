@@ -0,0 +1,50 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <Eigen/SparseCore>
+
+#include <MatrixTypes.h>
+
+class PDEModel;
+
+/*
+ * Interpolates the finite element solution, or its derivative with
+ * respect to x, to an arbitrary set of output points. The sparse matrix
+ * is built once so the values at each output time are a single
+ * matrix-vector product.
+ */
+class PDEOutputOperator {
+public:
+  typedef Eigen::SparseMatrix<double, Eigen::RowMajor> SparseMat;
+  PDEOutputOperator() {}
+  PDEOutputOperator(const RealVector &mesh, const PDEModel &model,
+    size_t numPDE, const RealVector &xOut, bool calcDeriv = false);
+  // the integral of x^m*u over the domain for each pde, calculated with
+  // the element integration rule
+  static PDEOutputOperator integrals(const RealVector &mesh,
+    const PDEModel &model, size_t numPDE, int m);
+  // uFE is the finite element part of the global solution vector; uOut
+  // has numPDE values at each output point with the pde index varying
+  // fastest
+  template<class TG, class TO>
+  void apply(const TG &uFE, TO &uOut) const {
+    uOut.noalias() = op*uFE;
+  }
+  const SparseMat &matrix() const { return op; }
+private:
+  SparseMat op;
+};
@@ -0,0 +1,66 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <thread>
+#include <chrono>
+
+#include "PDEOutputQueue.h"
+
+PDEOutputQueue::PDEOutputQueue(size_t capacity) :
+  slots(capacity + 1), head(0), tail(0)
+{
+}
+
+PDEOutputQueue::Snapshot &PDEOutputQueue::back()
+{
+  // one slot is always empty to distinguish a full queue from an empty one
+  const size_t t = tail.load(std::memory_order_relaxed);
+  const size_t next = (t + 1) % slots.size();
+  int numWaits = 0;
+  while (next == head.load(std::memory_order_acquire))
+    wait(numWaits);
+  return slots[t];
+}
+
+void PDEOutputQueue::push()
+{
+  const size_t t = tail.load(std::memory_order_relaxed);
+  tail.store((t + 1) % slots.size(), std::memory_order_release);
+}
+
+PDEOutputQueue::Snapshot &PDEOutputQueue::front()
+{
+  const size_t h = head.load(std::memory_order_relaxed);
+  int numWaits = 0;
+  while (h == tail.load(std::memory_order_acquire))
+    wait(numWaits);
+  return slots[h];
+}
+
+void PDEOutputQueue::pop()
+{
+  const size_t h = head.load(std::memory_order_relaxed);
+  head.store((h + 1) % slots.size(), std::memory_order_release);
+}
+
+void PDEOutputQueue::wait(int &numWaits)
+{
+  // yield briefly and then sleep so a waiting thread doesn't occupy a
+  // core while the integrator takes long steps
+  if (numWaits++ < 100)
+    std::this_thread::yield();
+  else
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
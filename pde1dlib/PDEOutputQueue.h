@@ -0,0 +1,54 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <MatrixTypes.h>
+
+/*
+ * Bounded single-producer, single-consumer queue that passes solution
+ * snapshots from the integrator to the output thread. The slots are
+ * allocated once and reused, and no locks are taken; the producer waits
+ * while the queue is full and the consumer while it is empty.
+ */
+class PDEOutputQueue {
+public:
+  struct Snapshot {
+    enum Kind { Solution, Event, Stop };
+    Kind kind;
+    int timeStep;
+    double t;
+    RealVector u, v;
+    IntVector eventsFound;
+  };
+  explicit PDEOutputQueue(size_t capacity);
+  // the slot to fill; push makes it visible to the consumer
+  Snapshot &back();
+  void push();
+  // the oldest snapshot; pop returns the slot to the producer
+  Snapshot &front();
+  void pop();
+private:
+  static void wait(int &numWaits);
+  std::vector<Snapshot> slots;
+  // head is only written by the consumer and tail by the producer; they
+  // are kept in separate cache lines
+  std::atomic<size_t> head;
+  char pad[64];
+  std::atomic<size_t> tail;
+};
@@ -0,0 +1,124 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <limits>
+
+#include <Eigen/QR>
+
+#include "PDEShootingSolver.h"
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+#include "SunVector.h"
+#include <util.h>
+
+PDEShootingSolver::PDEShootingSolver(PDE1dImpl &pdeImpl, double period) :
+  pdeImpl(pdeImpl), period(period)
+{
+  t0 = 0;
+  const PDE1dOptions &opts = pdeImpl.getOptions();
+  relTol = opts.getRelTol();
+  absTol = opts.getAbsTol();
+  diag = opts.printStats();
+  maxNewtonIter = 20;
+  maxKrylovDim = 30;
+}
+
+bool PDEShootingSolver::solve(double t0, RealVector &u0)
+{
+  this->t0 = t0;
+  const size_t n = u0.size();
+  RealVector uT(n), r(n), du(n);
+  for (int it = 0; it < maxNewtonIter; it++) {
+    flow(u0, uT);
+    r = uT - u0;
+    double rNorm = PDE1dImpl::wrmsNorm(r, u0, relTol, absTol);
+    if (diag)
+      pdePrintf("Periodic: iter=%d, ||u(t0+T)-u(t0)||=%12.3e\n", it + 1, rNorm);
+    // the periodicity error is within the integration tolerances
+    if (rNorm < 1) {
+      u0 = uT;
+      return true;
+    }
+    // solve (M - I)*du = -r where M is the monodromy matrix
+    RealVector b = -r;
+    // the Newton correction is not usable unless the linear system
+    // was solved to the inexact Newton tolerance
+    if (!gmres(u0, uT, b, du))
+      return false;
+    u0 += du;
+  }
+  return false;
+}
+
+void PDEShootingSolver::flow(const RealVector &u0, RealVector &uT)
+{
+  pdeImpl.resetTransient(t0, u0);
+  if (!pdeImpl.advance(t0 + period, true))
+    throw PDE1dException("pde1d:periodic_event",
+      "A terminal event occurred during the calculation of the periodic "
+      "solution.");
+  uT = pdeImpl.getCurrentSolution();
+}
+
+bool PDEShootingSolver::gmres(const RealVector &u0, const RealVector &uT,
+  const RealVector &b, RealVector &x)
+{
+  const size_t n = u0.size();
+  const int m = maxKrylovDim;
+  const double beta = b.norm();
+  x.setZero();
+  if (beta == 0)
+    return true;
+  // inexact Newton; the products are only accurate to about the
+  // integration tolerance so there is no point solving more accurately
+  const double tol = 1e-2*beta;
+  // directional difference increment; the integration error
+  // limits the accuracy of the difference
+  const double eps = std::sqrt(relTol)*std::max(1., u0.lpNorm<Eigen::Infinity>());
+  RealMatrix V(n, m + 1), H(m + 1, m);
+  H.setZero();
+  V.col(0) = b / beta;
+  RealVector uPert(n), uTPert(n), w(n), e1(m + 1), y;
+  double resNorm = beta;
+  e1.setZero();
+  e1(0) = beta;
+  for (int j = 0; j < m; j++) {
+    uPert = u0 + eps*V.col(j);
+    flow(uPert, uTPert);
+    w = (uTPert - uT) / eps - V.col(j);
+    // modified Gram-Schmidt
+    for (int i = 0; i <= j; i++) {
+      H(i, j) = w.dot(V.col(i));
+      w -= H(i, j)*V.col(i);
+    }
+    H(j + 1, j) = w.norm();
+    Eigen::HouseholderQR<RealMatrix> qr(H.topLeftCorner(j + 2, j + 1));
+    y = qr.solve(e1.head(j + 2));
+    resNorm = (e1.head(j + 2) - H.topLeftCorner(j + 2, j + 1)*y).norm();
+    if (diag)
+      pdePrintf("Periodic:   gmres iter=%d, resNorm=%12.3e\n", j + 1, resNorm);
+    if (resNorm <= tol || H(j + 1, j) <= std::numeric_limits<double>::epsilon()*beta) {
+      x = V.leftCols(j + 1)*y;
+      return true;
+    }
+    V.col(j + 1) = w / H(j + 1, j);
+  }
+  x = V.leftCols(m)*y;
+  if (diag && resNorm > tol)
+    pdePrintf("Periodic:   gmres did not converge in %d iterations\n", m);
+  return resNorm <= tol;
+}
@@ -0,0 +1,46 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1DLIB_PDESHOOTINGSOLVER_H_
+#define PDE1DLIB_PDESHOOTINGSOLVER_H_
+
+#include "MatrixTypes.h"
+
+class PDE1dImpl;
+
+/*
+ * Calculates the initial conditions, u0, for which the solution after one
+ * period of the forcing returns to u0. The nonlinear equations,
+ * u(t0+T; u0) - u0 = 0, are solved with Newton's method. The Jacobian is
+ * never formed; its product with a vector is approximated by a
+ * finite difference of two time integrations, and the linear equations
+ * are solved with GMRES.
+ */
+class PDEShootingSolver {
+public:
+  PDEShootingSolver(PDE1dImpl &pdeImpl, double period);
+  bool solve(double t0, RealVector &u0);
+private:
+  void flow(const RealVector &u0, RealVector &uT);
+  bool gmres(const RealVector &u0, const RealVector &uT,
+    const RealVector &b, RealVector &x);
+  PDE1dImpl &pdeImpl;
+  double period, t0;
+  double relTol, absTol;
+  int maxNewtonIter, maxKrylovDim;
+  bool diag;
+};
+
+#endif /* PDE1DLIB_PDESHOOTINGSOLVER_H_ */
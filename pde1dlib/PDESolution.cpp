@@ -21,50 +21,53 @@
  */
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 using std::cout;
 using std::endl;
 
 #include "PDESolution.h"
+#include "PDESolutionFile.h"
+#include "PDE1dOptions.h"
 #include "PDE1dDefn.h"
 #include "PDEModel.h"
+#include "PDE1dException.h"
+#include "PDEOutputQueue.h"
 
 PDESolution::PDESolution(const PDE1dDefn &pde, const PDEModel &model,
-  int numViewElemsPerElem) :
+  int numViewElemsPerElem, const std::vector<double> &outputX) :
   initialX(pde.getMesh()),
-  time(pde.getTimeSpan()), numViewElemsPerElem(numViewElemsPerElem),
-  pde(pde), model(model)
+  time(pde.getTimeSpan()), pde(pde), model(model)
 {
   numTimesSet = 0;
   numEventsSet = 0;
+  file = 0;
+  outBuf = 0;
+  derivedFlags = 0;
   size_t maxNumTimes = time.size();
   outTimes.resize(maxNumTimes);
   int numPDE = pde.getNumPDE();
-  if (numViewElemsPerElem == 1) {
+  if (!outputX.empty())
+    x = Eigen::Map<const RealVector>(outputX.data(), outputX.size());
+  else if (numViewElemsPerElem == 1)
     x = initialX;
-    size_t nnOrig = x.size();
-    u.resize(maxNumTimes, nnOrig*numPDE);
-    const size_t nnfee = model.numNodesFEEqns();
-    u2Tmp.resize(1, nnOrig*numPDE);
-  }
   else {
     size_t ne = initialX.size() - 1;
-    numNodesViewMesh = numViewElemsPerElem*ne + 1;
-    x.resize(numNodesViewMesh);
-    u.resize(maxNumTimes, numNodesViewMesh*numPDE);
-    u2Tmp.resize(numPDE, numNodesViewMesh);
+    x.resize(numViewElemsPerElem*ne + 1);
     x(0) = initialX(0);
-    double xij = x(0);
     size_t ij = 1;
     for (int i = 0; i < ne; i++) {
       double L = initialX(i + 1) - initialX(i);
       double dx = L / (double)numViewElemsPerElem;
-      for (int j = 0; j < numViewElemsPerElem; j++) {
-        xij += dx;
-        x(ij++) = xij;
-      }
+      for (int j = 1; j < numViewElemsPerElem; j++)
+        x(ij++) = initialX(i) + j*dx;
+      x(ij++) = initialX(i + 1);
     }
   }
+  outOp = PDEOutputOperator(initialX, model, numPDE, x);
+  u.resize(maxNumTimes, x.size()*numPDE);
+  uOde.resize(maxNumTimes, pde.getNumODE());
+  uRow.resize(u.cols());
   numEvents = pde.getNumEvents();
   if (numEvents) {
     eventsSolution.resize(numEvents, u.cols());
@@ -73,63 +76,220 @@ PDESolution::PDESolution(const PDE1dDefn &pde, const PDEModel &model,
   }
 }
 
-void PDESolution::setSolutionVector(int timeStep, double time,
-  const RealVector &uSol)
+PDESolution::PDESolution(PDESolution &&) = default;
+
+PDESolution::~PDESolution()
 {
-  outTimes(numTimesSet++) = time;
-  int numDepVars = pde.getNumPDE();
-  const size_t nnfee = model.numNodesFEEqns();
-  if (numViewElemsPerElem == 1) {
-    model.globalToMeshVec(uSol.topRows(nnfee), u2Tmp);
-    u.row(timeStep) = u2Tmp;
-#if 0
-    int numDepVars = pde.getNumPDE();
-    const size_t nnfee = model.numNodesFEEqns();
-    typedef Eigen::Map<const Eigen::MatrixXd> ConstMapMat;
-    ConstMapMat u2Sol(uSol.data(), numDepVars, nnfee);
-    cout << "u2Sol=" << u2Sol << endl;
-#endif
+  // the integration may have stopped with an exception before close
+  stopOutputThread();
+}
+
+void PDESolution::setOutputFile(PDESolutionFile *f)
+{
+  file = f;
+  u.resize(0, u.cols());
+  uOde.resize(0, uOde.cols());
+}
+
+void PDESolution::setOutputBuffer(double *buf)
+{
+  outBuf = buf;
+  u.resize(0, u.cols());
+}
+
+void PDESolution::setStorageOptions(const PDE1dOptions &opts)
+{
+  codec = PDESolutionCodec(u.cols(), opts);
+  if (isEncoded())
+    u.resize(0, u.cols());
+}
+
+void PDESolution::decodeSolution(double *buf)
+{
+  for (int i = 0; i < numTimesSet; i++) {
+    if (isEncoded()) {
+      if (i % PDESolutionCodec::keyInterval == 0)
+        codec.reset();
+      size_t end = i + 1 < numTimesSet ? packedOffsets[i + 1] :
+        packed.size();
+      codec.decode(&packed[packedOffsets[i]], end - packedOffsets[i],
+        uRow.data());
+    }
+    else
+      uRow = u.row(i).transpose();
+    scatterRow(i, numTimesSet, buf);
   }
-  else {
-    typedef Eigen::Map<const Eigen::MatrixXd> ConstMapMat;
-    ConstMapMat u2Sol(uSol.data(), numDepVars, nnfee);
-    PDEModel::DofList eDofs;
-    RealMatrix u2e(numDepVars, 2);
-    size_t numR = numViewElemsPerElem - 1;
-    double dr = 2. / (double)numViewElemsPerElem;
-    RealVector rVals(numR);
-    double r = -1;
-    for (int i = 0; i < numR; i++) {
-      r += dr;
-      rVals(i) = r;
+}
+
+void PDESolution::scatterRow(size_t timeStep, size_t ld, double *buf) const
+{
+  // uRow has the pde index varying fastest
+  const size_t numPDE = pde.getNumPDE(), numPts = x.size();
+  const double *ur = uRow.data();
+  for (size_t j = 0; j < numPts; j++)
+    for (size_t k = 0; k < numPDE; k++)
+      buf[timeStep + ld*(j + numPts*k)] = *ur++;
+}
+
+void PDESolution::setDerivedOutputs(int flags)
+{
+  derivedFlags = flags;
+  const int numPDE = pde.getNumPDE();
+  const size_t maxNumTimes = time.size();
+  if (flags & (PDE1dOptions::DerivedDuDx | PDE1dOptions::DerivedFlux))
+    duDxOp = PDEOutputOperator(initialX, model, numPDE, x, true);
+  if (flags & PDE1dOptions::DerivedDuDx)
+    duDx.resize(u.cols(), maxNumTimes);
+  if (flags & PDE1dOptions::DerivedFlux)
+    flux.resize(u.cols(), maxNumTimes);
+  if (flags & PDE1dOptions::DerivedIntegrals) {
+    intOp = PDEOutputOperator::integrals(initialX, model, numPDE,
+      pde.getCoordSystem());
+    integrals.resize(numPDE, maxNumTimes);
+  }
+}
+
+bool PDESolution::needsFlux() const
+{
+  return (derivedFlags & PDE1dOptions::DerivedFlux) != 0;
+}
+
+void PDESolution::setFlux(int timeStep, const RealMatrix &f)
+{
+  flux.col(timeStep) = MapVec(const_cast<double*>(f.data()), f.size());
+}
+
+void PDESolution::setStoreCoefficients(bool store)
+{
+  if (store)
+    coeffs.resize(pde.getNumPDE()*model.numNodesFEEqns(), time.size());
+  else
+    coeffs.resize(0, 0);
+}
+
+void PDESolution::setOutputThread(bool useThread, size_t queueLength)
+{
+  stopOutputThread();
+  if (!useThread || needsFlux())
+    return;
+  queue.reset(new PDEOutputQueue(queueLength));
+  outputThread = std::thread(&PDESolution::outputLoop, this);
+}
+
+void PDESolution::outputLoop()
+{
+  while (true) {
+    PDEOutputQueue::Snapshot &s = queue->front();
+    if (s.kind == PDEOutputQueue::Snapshot::Stop) {
+      queue->pop();
+      return;
     }
-    //cout << "rvals=" << rVals << endl;
-    RealMatrix N, u2eView;
-    size_t ne = model.numElements();
-    int lastNumElemNodes = 0;
-    size_t iViewNode = 0;
-    for (int e = 0; e < ne; e++) {
-      const PDEElement &elem = model.element(e);
-      model.getDofIndicesForElem(e, eDofs);
-      PDEModel::globalToElemVec(eDofs, u2Sol, u2e);
-      const ShapeFunction &sf = elem.getSF().getShapeFunction();
-      if (sf.numNodes() != lastNumElemNodes) {
-        lastNumElemNodes = sf.numNodes();
-        N.resize(lastNumElemNodes, numR);
-        for (int i = 0; i < numR; i++)
-          sf.N(rVals(i), N.col(i).data());
-        //cout << "N\n" << N << endl;
+    // after an error the remaining snapshots are discarded so the
+    // integrator is not blocked; the error is reported by close
+    if (!outputError) {
+      try {
+        if (s.kind == PDEOutputQueue::Snapshot::Solution)
+          storeSolutionVector(s.timeStep, s.t, s.u, s.v);
+        else
+          storeEventsSolution(s.timeStep, s.t, s.u, s.eventsFound);
+      }
+      catch (...) {
+        outputError = std::current_exception();
       }
-      u2eView = u2e*N;
-      u2Tmp.col(iViewNode) = u2e.col(0);
-      u2Tmp.block(0, iViewNode + 1, numDepVars, numR) = u2eView;
-      iViewNode += numR + 1;
     }
-    // finish the last view node
-    u2Tmp.col(iViewNode) = u2e.col(1);
-    MapVec u2ViewVector(u2Tmp.data(), u2Tmp.size());
-    u.row(timeStep) = u2ViewVector;
+    queue->pop();
+  }
+}
+
+void PDESolution::stopOutputThread()
+{
+  if (!queue)
+    return;
+  queue->back().kind = PDEOutputQueue::Snapshot::Stop;
+  queue->push();
+  outputThread.join();
+  queue.reset();
+}
+
+void PDESolution::setSolutionVector(int timeStep, double time,
+  const RealVector &uSol, const RealVector &v)
+{
+  if (queue) {
+    PDEOutputQueue::Snapshot &s = queue->back();
+    s.kind = PDEOutputQueue::Snapshot::Solution;
+    s.timeStep = timeStep;
+    s.t = time;
+    s.u = uSol;
+    s.v = v;
+    queue->push();
+    return;
+  }
+  storeSolutionVector(timeStep, time, uSol, v);
+}
+
+void PDESolution::storeSolutionVector(int timeStep, double time,
+  const RealVector &uSol, const RealVector &v)
+{
+  if (numTimesSet == outTimes.size())
+    reserveTimes(2 * numTimesSet + 1);
+  outTimes(numTimesSet++) = time;
+  if (coeffs.size())
+    coeffs.col(timeStep) = uSol;
+  calcSolutionRow(uSol);
+  if (derivedFlags) {
+    const size_t nnfee = model.numNodesFEEqns();
+    auto uFE = uSol.topRows(pde.getNumPDE()*nnfee);
+    if (duDxOp.matrix().size())
+      duDxOp.apply(uFE, duDxRow);
+    if (duDx.size())
+      duDx.col(timeStep) = duDxRow;
+    if (integrals.size())
+      integrals.col(timeStep).noalias() = intOp.matrix()*uFE;
+  }
+  if (file) {
+    file->append(time, uRow.data(), v.data());
+    return;
+  }
+  if (outBuf)
+    scatterRow(timeStep, this->time.size(), outBuf);
+  else if (isEncoded()) {
+    if (timeStep % PDESolutionCodec::keyInterval == 0)
+      codec.reset();
+    packedOffsets.push_back(packed.size());
+    codec.encode(uRow.data(), packed);
   }
+  else
+    u.row(timeStep) = uRow;
+  if (uOde.cols())
+    uOde.row(timeStep) = v;
+}
+
+void PDESolution::reserveTimes(size_t n)
+{
+  // more outputs than requested times when they are chosen by the
+  // integrator; the output buffer can't grow so it isn't used then
+  if (outBuf)
+    throw PDE1dException("pde1d:internal_error",
+      "More solution rows than the output buffer holds.");
+  outTimes.conservativeResize(n);
+  if (u.rows())
+    u.conservativeResize(n, u.cols());
+  if (uOde.rows())
+    uOde.conservativeResize(n, uOde.cols());
+  if (coeffs.size())
+    coeffs.conservativeResize(coeffs.rows(), n);
+  if (duDx.size())
+    duDx.conservativeResize(duDx.rows(), n);
+  if (flux.size())
+    flux.conservativeResize(flux.rows(), n);
+  if (integrals.size())
+    integrals.conservativeResize(integrals.rows(), n);
+}
+
+void PDESolution::calcSolutionRow(const RealVector &uSol)
+{
+  const size_t nnfee = model.numNodesFEEqns();
+  outOp.apply(uSol.topRows(pde.getNumPDE()*nnfee), uRow);
 }
 
 void PDESolution::print() const
@@ -139,8 +299,34 @@ void PDESolution::print() const
 
 void PDESolution::close()
 {
+  stopOutputThread();
+  if (outputError) {
+    std::exception_ptr err = outputError;
+    outputError = nullptr;
+    std::rethrow_exception(err);
+  }
   outTimes.conservativeResize(numTimesSet);
+  if (coeffs.size())
+    coeffs.conservativeResize(coeffs.rows(), numTimesSet);
+  if (duDx.size())
+    duDx.conservativeResize(duDx.rows(), numTimesSet);
+  if (flux.size())
+    flux.conservativeResize(flux.rows(), numTimesSet);
+  if (integrals.size())
+    integrals.conservativeResize(integrals.rows(), numTimesSet);
+  if (file) {
+    file->close();
+    return;
+  }
+  const size_t ld = time.size();
+  if (outBuf && numTimesSet < ld) {
+    // each column moves toward the start so it can be done in place
+    const size_t numCols = x.size()*pde.getNumPDE();
+    for (size_t j = 1; j < numCols; j++)
+      std::copy_n(outBuf + j*ld, numTimesSet, outBuf + j*numTimesSet);
+  }
   u.conservativeResize(numTimesSet, u.cols());
+  uOde.conservativeResize(numTimesSet, uOde.cols());
   if (numEventsSet < numEvents) {
     eventsSolution.conservativeResize(numEventsSet, u.cols());
     eventsTimes.conservativeResize(numEventsSet);
@@ -151,6 +337,26 @@ void PDESolution::close()
 void PDESolution::setEventsSolution(int timeStep, double time,
   const RealVector &u, const IntVector &eventsFound)
 {
+  if (queue) {
+    PDEOutputQueue::Snapshot &s = queue->back();
+    s.kind = PDEOutputQueue::Snapshot::Event;
+    s.timeStep = timeStep;
+    s.t = time;
+    s.u = u;
+    s.eventsFound = eventsFound;
+    queue->push();
+    return;
+  }
+  storeEventsSolution(timeStep, time, u, eventsFound);
+}
+
+void PDESolution::storeEventsSolution(int timeStep, double time,
+  const RealVector &u, const IntVector &eventsFound)
+{
+  if (file) {
+    calcSolutionRow(u);
+    file->appendEvent(time, numEventsSet + 1, uRow.data());
+  }
   eventsSolution.row(numEventsSet) = u;
   eventsTimes(numEventsSet) = time;
   eventsIndex(numEventsSet) = numEventsSet + 1;
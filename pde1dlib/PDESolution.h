@@ -23,15 +23,31 @@
 #ifndef PDE1DLIB_PDESOLUTION_H_
 #define PDE1DLIB_PDESOLUTION_H_
 
+#include <vector>
+#include <memory>
+#include <thread>
+#include <exception>
+
 #include <MatrixTypes.h>
+#include "PDEOutputOperator.h"
+#include "PDESolutionCodec.h"
 
 class PDE1dDefn;
 class PDEModel;
+class PDESolutionFile;
+class PDE1dOptions;
+class PDEOutputQueue;
 
 class PDESolution {
 public:
+  // the solution is output at the points in outputX if it is not empty
+  // and otherwise, at the mesh points subdivided numViewElemsPerElem times
   PDESolution(const PDE1dDefn &pde, const PDEModel &model,
-    int numViewElemsPerElem);
+    int numViewElemsPerElem,
+    const std::vector<double> &outputX = std::vector<double>());
+  // only valid after close, when the output thread is not running
+  PDESolution(PDESolution &&);
+  ~PDESolution();
   int numSpatialPoints() const {
     return (int) x.size();
   }
@@ -44,11 +60,65 @@ public:
   const RealVector &getOutputTimes() const {
     return outTimes;
   }
+  // u is the finite element solution and v, the ODE variables
   void setSolutionVector(int timeStep, double time,
-    const RealVector &u);
+    const RealVector &u, const RealVector &v = RealVector());
+  // append the solution at each time to a file rather than storing it;
+  // getSolution and uOde are then empty
+  void setOutputFile(PDESolutionFile *file);
+  // write the solution directly into buf, a column-major array of
+  // dimensions numTimes x numSpatialPoints x numPDE where numTimes is the
+  // length of the time span; getSolution is then empty. If fewer times are
+  // calculated, close moves the values so that buf has dimensions
+  // numTimePoints x numSpatialPoints x numPDE.
+  void setOutputBuffer(double *buf);
+  // store the solution at each time encoded with the output precision
+  // and compression options; getSolution is then empty and
+  // decodeSolution returns the values
+  void setStorageOptions(const PDE1dOptions &opts);
+  bool isEncoded() const { return !codec.isIdentity(); }
+  // the solution in a column-major array of dimensions
+  // numTimePoints x numSpatialPoints x numPDE
+  void decodeSolution(double *buf);
   const RealMatrix &getSolution() const {
     return u;
   }
+  // also keep the finite element solution at each output time in a
+  // column of getCoefficients, e.g. for PDESolutionQuery
+  void setStoreCoefficients(bool store);
+  const RealMatrix &getCoefficients() const {
+    return coeffs;
+  }
+  // also calculate the values selected by PDE1dOptions::DerivedOutput
+  // flags; column j of getDuDx, getFlux, and getIntegrals is for output
+  // time j with the pde index varying fastest. The flux is calculated
+  // from the pde coefficients so it is set by the caller with setFlux
+  // from getLastU and getLastDuDx.
+  void setDerivedOutputs(int flags);
+  // Process the solutions (interpolation, derived values, encoding, and
+  // file output) in a background thread; setSolutionVector and
+  // setEventsSolution only copy the solution into a queue of queueLength
+  // entries and wait when it is full. The results are identical. This
+  // is ignored when the flux is needed since its calculation calls the
+  // pde definition. The thread is stopped by close.
+  void setOutputThread(bool useThread, size_t queueLength = 16);
+  bool needsFlux() const;
+  const RealVector &getLastU() const {
+    return uRow;
+  }
+  const RealVector &getLastDuDx() const {
+    return duDxRow;
+  }
+  void setFlux(int timeStep, const RealMatrix &f);
+  const RealMatrix &getDuDx() const {
+    return duDx;
+  }
+  const RealMatrix &getFlux() const {
+    return flux;
+  }
+  const RealMatrix &getIntegrals() const {
+    return integrals;
+  }
   void print() const;
   void close();
   void setEventsSolution(int timeStep, double time,
@@ -65,21 +135,42 @@ public:
 //private:
   RealMatrix uOde;
 private:
+  void storeSolutionVector(int timeStep, double time,
+    const RealVector &u, const RealVector &v);
+  void storeEventsSolution(int timeStep, double time,
+    const RealVector &u, const IntVector &eventsFound);
+  void outputLoop();
+  void stopOutputThread();
+  void reserveTimes(size_t n);
+  void calcSolutionRow(const RealVector &uSol);
+  void scatterRow(size_t timeStep, size_t ld, double *buf) const;
   int numEvents, numEventsSet;
   int numTimesSet;
   const RealVector &initialX;
   const RealVector &time;
   RealVector x;
-  int numViewElemsPerElem;
-  size_t numNodesViewMesh;
   const PDE1dDefn &pde;
   const PDEModel &model;
+  PDEOutputOperator outOp;
   RealMatrix u;
   RealVector outTimes;
-  RealMatrix u2Tmp; // temporary work storage;
+  RealVector uRow;
+  RealMatrix coeffs;
+  int derivedFlags;
+  PDEOutputOperator duDxOp, intOp;
+  RealVector duDxRow;
+  RealMatrix duDx, flux, integrals;
+  PDESolutionFile *file;
+  double *outBuf;
+  PDESolutionCodec codec;
+  std::vector<unsigned char> packed;
+  std::vector<size_t> packedOffsets;
   RealMatrix eventsSolution;
   RealVector eventsTimes;
   IntVector eventsIndex;
+  std::unique_ptr<PDEOutputQueue> queue;
+  std::thread outputThread;
+  std::exception_ptr outputError;
 };
 
 #endif /* PDE1DLIB_PDESOLUTION_H_ */
@@ -0,0 +1,203 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "PDESolutionCodec.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+
+PDESolutionCodec::PDESolutionCodec(size_t rowLength) :
+  n(rowLength), precision(Double), quantTol(0), compress(false)
+{
+  init();
+}
+
+PDESolutionCodec::PDESolutionCodec(size_t rowLength,
+  const PDE1dOptions &opts) :
+  n(rowLength), precision((Precision)opts.getOutputPrecision()),
+  quantTol(opts.getQuantizationTol()), compress(opts.getOutputCompression())
+{
+  init();
+}
+
+PDESolutionCodec::PDESolutionCodec(size_t rowLength, Precision precision,
+  double quantTol, bool compress) :
+  n(rowLength), precision(precision), quantTol(quantTol), compress(compress)
+{
+  init();
+}
+
+void PDESolutionCodec::init()
+{
+  if (precision == Quantized && !(quantTol > 0))
+    throw PDE1dException("pde1d:invalidQuantizationTol",
+      "QuantizationTol must be greater than zero for quantized output.");
+  wordSize = precision == Double ? 8 : 4;
+  words.resize(n);
+  prev.assign(n, 0);
+}
+
+void PDESolutionCodec::reset()
+{
+  prev.assign(n, 0);
+}
+
+void PDESolutionCodec::encode(const double *row,
+  std::vector<unsigned char> &out)
+{
+  for (size_t i = 0; i < n; i++) {
+    uint64_t w;
+    if (precision == Double)
+      memcpy(&w, row + i, 8);
+    else if (precision == Single) {
+      float f = (float)row[i];
+      uint32_t w32;
+      memcpy(&w32, &f, 4);
+      w = w32;
+    }
+    else {
+      double q = floor(row[i] / (2 * quantTol) + .5);
+      // written so that NaN also fails the test
+      if (!(fabs(q) <= 2147483647.)) {
+        char msg[256];
+        if (isfinite(row[i]))
+          snprintf(msg, sizeof(msg), "The solution value %g is too large to "
+            "be quantized with QuantizationTol = %g.", row[i], quantTol);
+        else
+          snprintf(msg, sizeof(msg), "The solution value %g can not be "
+            "quantized; only finite values can be stored with "
+            "QuantizationTol.", row[i]);
+        throw PDE1dException("pde1d:invalidQuantizationTol", msg);
+      }
+      w = (uint32_t)(int32_t)q;
+    }
+    if (compress) {
+      uint64_t d;
+      if (precision == Quantized) {
+        // zigzag so that small differences of either sign are small
+        int32_t di = (int32_t)(uint32_t)(w - prev[i]);
+        d = (uint32_t)((uint32_t)di << 1) ^ (uint32_t)(di >> 31);
+      }
+      else
+        d = w ^ prev[i];
+      prev[i] = w;
+      w = d;
+    }
+    words[i] = w;
+  }
+  if (!compress) {
+    for (size_t i = 0; i < n; i++)
+      for (int b = 0; b < wordSize; b++)
+        out.push_back((unsigned char)(words[i] >> 8 * b));
+    return;
+  }
+  // group the bytes by significance and replace runs of zeros with the
+  // zero byte and the run length
+  size_t zeros = 0;
+  auto flushZeros = [&]() {
+    if (!zeros) return;
+    out.push_back(0);
+    for (; zeros >= 0x80; zeros >>= 7)
+      out.push_back((unsigned char)(zeros | 0x80));
+    out.push_back((unsigned char)zeros);
+    zeros = 0;
+  };
+  for (int b = 0; b < wordSize; b++) {
+    for (size_t i = 0; i < n; i++) {
+      unsigned char c = (unsigned char)(words[i] >> 8 * b);
+      if (c) {
+        flushZeros();
+        out.push_back(c);
+      }
+      else
+        zeros++;
+    }
+  }
+  flushZeros();
+}
+
+void PDESolutionCodec::decode(const unsigned char *in, size_t numBytes,
+  double *row)
+{
+  const unsigned char *end = in + numBytes;
+  auto corrupt = []() {
+    throw PDE1dException("pde1d:solution_file",
+      "Unable to decode the stored solution.");
+  };
+  if (!compress) {
+    if (numBytes != n*wordSize)
+      corrupt();
+    for (size_t i = 0; i < n; i++) {
+      uint64_t w = 0;
+      for (int b = 0; b < wordSize; b++)
+        w |= (uint64_t)*in++ << 8 * b;
+      words[i] = w;
+    }
+  }
+  else {
+    bytes.resize(n*wordSize);
+    size_t k = 0;
+    while (in < end) {
+      unsigned char c = *in++;
+      if (c) {
+        if (k == bytes.size()) corrupt();
+        bytes[k++] = c;
+        continue;
+      }
+      size_t run = 0;
+      for (int shift = 0; ; shift += 7) {
+        if (in == end) corrupt();
+        c = *in++;
+        run |= (size_t)(c & 0x7f) << shift;
+        if (!(c & 0x80)) break;
+      }
+      if (run > bytes.size() - k) corrupt();
+      memset(&bytes[k], 0, run);
+      k += run;
+    }
+    if (k != bytes.size())
+      corrupt();
+    for (size_t i = 0; i < n; i++) {
+      uint64_t w = 0;
+      for (int b = 0; b < wordSize; b++)
+        w |= (uint64_t)bytes[b*n + i] << 8 * b;
+      if (precision == Quantized) {
+        uint32_t zz = (uint32_t)w;
+        uint32_t di = (zz >> 1) ^ (0u - (zz & 1));
+        w = (uint32_t)(prev[i] + di);
+      }
+      else
+        w ^= prev[i];
+      prev[i] = w;
+      words[i] = w;
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    uint64_t w = words[i];
+    if (precision == Double)
+      memcpy(row + i, &w, 8);
+    else if (precision == Single) {
+      uint32_t w32 = (uint32_t)w;
+      float f;
+      memcpy(&f, &w32, 4);
+      row[i] = f;
+    }
+    else
+      row[i] = (double)(int32_t)(uint32_t)w * 2 * quantTol;
+  }
+}
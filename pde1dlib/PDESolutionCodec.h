@@ -0,0 +1,61 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class PDE1dOptions;
+
+/*
+ * Encodes rows of the solution for storage in memory or in a solution
+ * file. Values are stored as doubles, floats, or integer multiples of
+ * 2*QuantizationTol. With compression, each row is stored as the
+ * difference from the previous row of the sequence, the bytes of these
+ * differences are grouped by significance, and runs of zero bytes are
+ * replaced by their length. A sequence is restarted every keyInterval
+ * rows so that any row can be decoded from the preceding key row.
+ */
+class PDESolutionCodec {
+public:
+  enum Precision { Double, Single, Quantized };
+  static const int keyInterval = 32;
+  // identity encoding of doubles
+  PDESolutionCodec(size_t rowLength = 0);
+  PDESolutionCodec(size_t rowLength, const PDE1dOptions &opts);
+  PDESolutionCodec(size_t rowLength, Precision precision, double quantTol,
+    bool compress);
+  Precision getPrecision() const { return precision; }
+  double getQuantizationTol() const { return quantTol; }
+  bool isCompressed() const { return compress; }
+  bool isIdentity() const { return precision == Double && !compress; }
+  // start a new sequence of rows
+  void reset();
+  // append the encoded row to out
+  void encode(const double *row, std::vector<unsigned char> &out);
+  // decode the next row of the sequence
+  void decode(const unsigned char *in, size_t numBytes, double *row);
+private:
+  void init();
+  size_t n;
+  Precision precision;
+  double quantTol;
+  bool compress;
+  int wordSize;
+  std::vector<uint64_t> prev, words;
+  std::vector<unsigned char> bytes;
+};
@@ -0,0 +1,236 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "PDESolutionFile.h"
+#include "PDE1dException.h"
+
+PDESolutionFile::PDESolutionFile(const std::string &fileName,
+  const RealVector &x, int numPDE, int numODE,
+  const PDESolutionCodec &codecIn) : fileName(fileName),
+  codec(numPDE*x.size(), codecIn.getPrecision(),
+    codecIn.getQuantizationTol(), codecIn.isCompressed())
+{
+  fp = fopen(fileName.c_str(), "wb");
+  if (!fp) {
+    char msg[1024];
+    snprintf(msg, sizeof(msg), "Unable to open solution file \"%s\".",
+      fileName.c_str());
+    throw PDE1dException("pde1d:solution_file", msg);
+  }
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "PDE1DSOL", 8);
+  header.version = version;
+  header.numPDE = numPDE;
+  header.numODE = numODE;
+  header.numPts = x.size();
+  header.precision = codec.getPrecision();
+  header.compressed = codec.isCompressed();
+  header.quantizationTol = codec.getQuantizationTol();
+  offset = 0;
+  writeData(&header, sizeof(header));
+  writeData(x.data(), x.size()*sizeof(double));
+}
+
+PDESolutionFile::~PDESolutionFile()
+{
+  if (fp)
+    fclose(fp);
+}
+
+void PDESolutionFile::append(double t, const double *u, const double *v)
+{
+  index.push_back(offset);
+  writeData(&t, sizeof(double));
+  if (header.numODE)
+    writeData(v, header.numODE*sizeof(double));
+  if (header.numTimes % PDESolutionCodec::keyInterval == 0)
+    codec.reset();
+  buf.clear();
+  codec.encode(u, buf);
+  uint64_t numBytes = buf.size();
+  buf.resize((buf.size() + 7) & ~(size_t)7);
+  writeData(&numBytes, sizeof(numBytes));
+  writeData(buf.data(), buf.size());
+  header.numTimes++;
+}
+
+void PDESolutionFile::appendEvent(double t, int index, const double *u)
+{
+  // there are few events so they are kept until the file is closed
+  events.push_back(t);
+  events.push_back(index);
+  events.insert(events.end(), u, u + header.numPDE*header.numPts);
+  header.numEvents++;
+}
+
+void PDESolutionFile::close()
+{
+  if (!fp) return;
+  header.indexOffset = offset;
+  writeData(index.data(), index.size()*sizeof(uint64_t));
+  writeData(events.data(), events.size()*sizeof(double));
+  if (fseek(fp, 0, SEEK_SET))
+    writeError();
+  writeData(&header, sizeof(header));
+  int err = fclose(fp);
+  fp = 0;
+  if (err)
+    writeError();
+}
+
+void PDESolutionFile::writeData(const void *p, size_t numBytes)
+{
+  if (!fp || fwrite(p, 1, numBytes, fp) != numBytes)
+    writeError();
+  offset += numBytes;
+}
+
+void PDESolutionFile::writeError() const
+{
+  char msg[1024];
+  snprintf(msg, sizeof(msg), "Error writing solution file \"%s\".",
+    fileName.c_str());
+  throw PDE1dException("pde1d:solution_file", msg);
+}
+
+PDESolutionReader::PDESolutionReader(const std::string &fileName) :
+  fileName(fileName), data(0), size(0), lastDecoded(-1)
+{
+#ifdef _WIN32
+  mapHandle = 0;
+  fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+    readError("Unable to open solution file");
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx(fileHandle, &fileSize);
+  size = (size_t)fileSize.QuadPart;
+  if (size >= sizeof(PDESolutionFile::Header)) {
+    mapHandle = CreateFileMappingA(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+    if (mapHandle)
+      data = (const char*)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+  }
+#else
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    readError("Unable to open solution file");
+  struct stat st;
+  if (fstat(fd, &st) == 0)
+    size = st.st_size;
+  if (size >= sizeof(PDESolutionFile::Header)) {
+    void *p = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p != MAP_FAILED)
+      data = (const char*)p;
+  }
+  ::close(fd);
+#endif
+  if (!data)
+    readError("Unable to read solution file");
+  header = (const PDESolutionFile::Header*)data;
+  if (memcmp(header->magic, "PDE1DSOL", 8))
+    readError("Invalid solution file");
+  if (header->version != PDESolutionFile::version)
+    readError("Unsupported version of solution file");
+  numU = header->numPDE*header->numPts;
+  xData = (const double*)(data + sizeof(PDESolutionFile::Header));
+  size_t indexEnd = header->indexOffset +
+    sizeof(uint64_t)*header->numTimes;
+  if (!header->indexOffset || size < indexEnd +
+    sizeof(double)*header->numEvents*(2 + numU))
+    readError("Solution file is incomplete; the solution may not have "
+      "finished");
+  recordIndex = (const uint64_t*)(data + header->indexOffset);
+  events = (const double*)(data + indexEnd);
+  for (size_t i = 0; i < header->numTimes; i++)
+    if (recordIndex[i] + sizeof(double)*(2 + header->numODE) >
+      header->indexOffset)
+      readError("Invalid solution file");
+  try {
+    codec = PDESolutionCodec(numU,
+      (PDESolutionCodec::Precision)header->precision,
+      header->quantizationTol, header->compressed != 0);
+  }
+  catch (const PDE1dException &) {
+    readError("Invalid solution file");
+  }
+}
+
+void PDESolutionReader::u(size_t i, double *row)
+{
+  // compressed rows are decoded in sequence from the preceding key row
+  const size_t key = i - i % PDESolutionCodec::keyInterval;
+  size_t first = i;
+  if (codec.isCompressed()) {
+    first = key;
+    if (lastDecoded != (size_t)-1 && lastDecoded >= key && lastDecoded < i)
+      first = lastDecoded + 1;
+  }
+  if (first == key)
+    codec.reset();
+  for (size_t j = first; j <= i; j++) {
+    const double *r = record(j);
+    uint64_t numBytes;
+    memcpy(&numBytes, r + 1 + header->numODE, sizeof(numBytes));
+    const unsigned char *bytes = (const unsigned char*)(r + 2 +
+      header->numODE);
+    if (bytes + numBytes > (const unsigned char*)data + header->indexOffset)
+      readError("Invalid solution file");
+    codec.decode(bytes, numBytes, row);
+  }
+  lastDecoded = i;
+}
+
+PDESolutionReader::~PDESolutionReader()
+{
+  release();
+}
+
+void PDESolutionReader::release()
+{
+#ifdef _WIN32
+  if (data)
+    UnmapViewOfFile(data);
+  if (mapHandle)
+    CloseHandle(mapHandle);
+  if (fileHandle != INVALID_HANDLE_VALUE)
+    CloseHandle(fileHandle);
+  mapHandle = 0;
+  fileHandle = INVALID_HANDLE_VALUE;
+#else
+  if (data)
+    munmap((void*)data, size);
+#endif
+  data = 0;
+}
+
+void PDESolutionReader::readError(const char *msg)
+{
+  char buf[1024];
+  snprintf(buf, sizeof(buf), "%s \"%s\".", msg, fileName.c_str());
+  // the destructor is not called when the constructor throws
+  release();
+  throw PDE1dException("pde1d:solution_file", buf);
+}
@@ -0,0 +1,121 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1DLIB_PDESOLUTIONFILE_H_
+#define PDE1DLIB_PDESOLUTIONFILE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "MatrixTypes.h"
+#include "PDESolutionCodec.h"
+
+/*
+ * Binary file containing a solution. All values are in the native byte
+ * order of the machine that wrote the file.
+ *
+ *   Header:  char magic[8] = "PDE1DSOL", uint32 version, numPDE, numODE,
+ *            numEvents, precision, compressed, uint64 numPts, numTimes,
+ *            double quantizationTol, uint64 indexOffset
+ *   x:       double[numPts]
+ *   Records: one per output time; double t, v[numODE], uint64 numBytes,
+ *            and the numPDE*numPts solution values, with the PDE index
+ *            varying fastest, encoded by PDESolutionCodec in numBytes
+ *            bytes padded to a multiple of eight
+ *   Index:   uint64 offset of each record, at indexOffset
+ *   Events:  one per event found; double t, index, u[numPDE*numPts]
+ *
+ * Records are appended as they are calculated so the solution is never
+ * held in memory; the index, events, and the final counts are written
+ * when the file is closed.
+ */
+class PDESolutionFile {
+public:
+  static const uint32_t version = 2;
+  struct Header {
+    char magic[8];
+    uint32_t version, numPDE, numODE, numEvents;
+    uint32_t precision, compressed;
+    uint64_t numPts, numTimes;
+    double quantizationTol;
+    uint64_t indexOffset;
+  };
+  PDESolutionFile(const std::string &fileName, const RealVector &x,
+    int numPDE, int numODE, const PDESolutionCodec &codec =
+    PDESolutionCodec());
+  ~PDESolutionFile();
+  void append(double t, const double *u, const double *v = 0);
+  void appendEvent(double t, int index, const double *u);
+  void close();
+private:
+  void writeData(const void *p, size_t numBytes);
+  void writeError() const;
+  std::string fileName;
+  FILE *fp;
+  Header header;
+  PDESolutionCodec codec;
+  uint64_t offset;
+  std::vector<uint64_t> index;
+  std::vector<unsigned char> buf;
+  std::vector<double> events;
+};
+
+/*
+ * Read-only access to a solution file. The file is memory mapped so
+ * only the parts that are referenced are read from disk.
+ */
+class PDESolutionReader {
+public:
+  PDESolutionReader(const std::string &fileName);
+  ~PDESolutionReader();
+  int numPDE() const { return header->numPDE; }
+  int numODE() const { return header->numODE; }
+  size_t numPts() const { return header->numPts; }
+  size_t numTimes() const { return header->numTimes; }
+  size_t numEvents() const { return header->numEvents; }
+  const double *x() const { return xData; }
+  double time(size_t i) const { return record(i)[0]; }
+  // the numPDE*numPts values with the PDE index varying fastest; reading
+  // the records in order is fastest when the file is compressed
+  void u(size_t i, double *row);
+  const double *v(size_t i) const { return record(i) + 1; }
+  double eventTime(size_t i) const { return event(i)[0]; }
+  int eventIndex(size_t i) const { return (int)event(i)[1]; }
+  const double *eventU(size_t i) const { return event(i) + 2; }
+private:
+  const double *record(size_t i) const {
+    return (const double*)(data + recordIndex[i]);
+  }
+  const double *event(size_t i) const {
+    return events + i*(2 + numU);
+  }
+  void release();
+  void readError(const char *msg);
+  std::string fileName;
+  const char *data;
+  size_t size;
+  const PDESolutionFile::Header *header;
+  const double *xData, *events;
+  const uint64_t *recordIndex;
+  size_t numU;
+  PDESolutionCodec codec;
+  size_t lastDecoded;
+#ifdef _WIN32
+  void *fileHandle, *mapHandle;
+#endif
+};
+#endif /* PDE1DLIB_PDESOLUTIONFILE_H_ */
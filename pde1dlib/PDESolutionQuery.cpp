@@ -0,0 +1,146 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "PDESolutionQuery.h"
+#include "PDEDenseOutput.h"
+#include "PDEOutputOperator.h"
+#include "PDEModel.h"
+#include "ShapeFunctionManager.h"
+#include "PDE1dException.h"
+
+PDESolutionQuery::PDESolutionQuery(const RealVector &mesh, int polyOrder,
+  int numPDE, const RealVector &t, const RealMatrix &coeffs,
+  const RealMatrix &uOde) :
+  mesh(mesh), t(t), coeffs(coeffs), uOde(uOde), numPDE_(numPDE),
+  numODE_((int)uOde.cols()), history(0)
+{
+  if (mesh.size() < 2 || t.size() < 1 || numPDE < 1)
+    throw PDE1dException("pde1d:eval_args",
+      "The solution must have at least two mesh points and one time.");
+  sfm.reset(new ShapeFunctionManager);
+  model.reset(new PDEModel(this->mesh, polyOrder, numPDE, *sfm));
+  const size_t numFE = numPDE*model->numNodesFEEqns();
+  if (coeffs.rows() != numFE || coeffs.cols() != t.size() ||
+    (uOde.size() && uOde.rows() != t.size())) {
+    char msg[256];
+    sprintf(msg, "The coefficient matrix must be %d x %d for this mesh, "
+      "polynomial order, and number of times.", (int)numFE, (int)t.size());
+    throw PDE1dException("pde1d:eval_args", msg);
+  }
+}
+
+PDESolutionQuery::PDESolutionQuery(const RealVector &mesh, int polyOrder,
+  int numPDE, const PDEDenseOutput &history) :
+  mesh(mesh), numPDE_(numPDE), history(&history)
+{
+  if (mesh.size() < 2 || !history.numSteps() || numPDE < 1)
+    throw PDE1dException("pde1d:eval_args",
+      "The solution must have at least two mesh points and one step.");
+  sfm.reset(new ShapeFunctionManager);
+  model.reset(new PDEModel(this->mesh, polyOrder, numPDE, *sfm));
+  const size_t numFE = numPDE*model->numNodesFEEqns();
+  if (history.numEqns() < numFE) {
+    char msg[256];
+    sprintf(msg, "The solution history must have at least %d equations "
+      "for this mesh and polynomial order.", (int)numFE);
+    throw PDE1dException("pde1d:eval_args", msg);
+  }
+  numODE_ = (int)(history.numEqns() - numFE);
+}
+
+PDESolutionQuery::~PDESolutionQuery() {}
+
+void PDESolutionQuery::interval(double tq, int &k, double &w) const
+{
+  const int nt = (int)t.size();
+  const double tol = 100 * std::numeric_limits<double>::epsilon()*
+    std::max(std::abs(t[0]), std::abs(t[nt - 1]));
+  if (tq < t[0] - tol || tq > t[nt - 1] + tol) {
+    char msg[256];
+    sprintf(msg, "Time %12.3e is outside the solution times, "
+      "[%12.3e, %12.3e].", tq, t[0], t[nt - 1]);
+    throw PDE1dException("pde1d:eval_args", msg);
+  }
+  if (nt == 1) {
+    k = 0;
+    w = 0;
+    return;
+  }
+  const double *begin = t.data(), *end = begin + nt;
+  k = (int)(std::upper_bound(begin, end, tq) - begin) - 1;
+  k = std::min(std::max(k, 0), nt - 2);
+  w = std::min(std::max((tq - t[k]) / (t[k + 1] - t[k]), 0.), 1.);
+}
+
+void PDESolutionQuery::eval(const RealVector &xq, const RealVector &tq,
+  RealMatrix &u, RealMatrix &DuDx) const
+{
+  PDEOutputOperator op(mesh, *model, numPDE_, xq),
+    dop(mesh, *model, numPDE_, xq, true);
+  const size_t ntq = tq.size();
+  u.resize(op.matrix().rows(), ntq);
+  DuDx.resize(op.matrix().rows(), ntq);
+  if (history) {
+    RealMatrix y;
+    history->eval(tq, y);
+    auto c = y.topRows(op.matrix().cols());
+    u.noalias() = op.matrix()*c;
+    DuDx.noalias() = dop.matrix()*c;
+    return;
+  }
+  RealVector c;
+  for (size_t j = 0; j < ntq; j++) {
+    int k;
+    double w;
+    interval(tq[j], k, w);
+    if (w == 0)
+      c = coeffs.col(k);
+    else
+      c = (1 - w)*coeffs.col(k) + w*coeffs.col(k + 1);
+    u.col(j).noalias() = op.matrix()*c;
+    DuDx.col(j).noalias() = dop.matrix()*c;
+  }
+}
+
+void PDESolutionQuery::evalODE(double tq, RealVector &v,
+  RealVector &vDot) const
+{
+  v.setZero(numODE_);
+  vDot.setZero(numODE_);
+  if (!numODE_)
+    return;
+  if (history) {
+    RealMatrix y, yDot;
+    history->eval(RealVector::Constant(1, tq), y, &yDot);
+    v = y.bottomRows(numODE_);
+    vDot = yDot.bottomRows(numODE_);
+    return;
+  }
+  int k;
+  double w;
+  interval(tq, k, w);
+  if (t.size() == 1) {
+    v = uOde.row(0).transpose();
+    return;
+  }
+  const double dt = t[k + 1] - t[k];
+  v = ((1 - w)*uOde.row(k) + w*uOde.row(k + 1)).transpose();
+  vDot = (uOde.row(k + 1) - uOde.row(k)).transpose() / dt;
+}
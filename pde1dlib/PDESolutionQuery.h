@@ -0,0 +1,60 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+
+#include <MatrixTypes.h>
+
+class PDEModel;
+class ShapeFunctionManager;
+class PDEDenseOutput;
+
+/*
+ * Evaluates a solution at arbitrary x and t from the finite element
+ * coefficients stored at the output times (see
+ * PDESolution::setStoreCoefficients). Values between output times are
+ * linearly interpolated. Alternatively, the coefficients at any time are
+ * calculated from the integrator's history (see PDEDenseOutput).
+ */
+class PDESolutionQuery {
+public:
+  // coeffs has the finite element solution at time t(j) in column j and
+  // uOde, the optional ODE solution at time t(i) in row i
+  PDESolutionQuery(const RealVector &mesh, int polyOrder, int numPDE,
+    const RealVector &t, const RealMatrix &coeffs,
+    const RealMatrix &uOde = RealMatrix());
+  // history must exist as long as the query
+  PDESolutionQuery(const RealVector &mesh, int polyOrder, int numPDE,
+    const PDEDenseOutput &history);
+  ~PDESolutionQuery();
+  int numPDE() const { return numPDE_; }
+  int numODE() const { return numODE_; }
+  // u and DuDx at each xq for each time tq(j) in column j with the pde
+  // index varying fastest
+  void eval(const RealVector &xq, const RealVector &tq,
+    RealMatrix &u, RealMatrix &DuDx) const;
+  // ODE variables and their time derivatives at time tq
+  void evalODE(double tq, RealVector &v, RealVector &vDot) const;
+private:
+  void interval(double tq, int &k, double &w) const;
+  RealVector mesh, t;
+  RealMatrix coeffs, uOde;
+  int numPDE_, numODE_;
+  const PDEDenseOutput *history;
+  std::unique_ptr<ShapeFunctionManager> sfm;
+  std::unique_ptr<PDEModel> model;
+};
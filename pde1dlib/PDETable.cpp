@@ -0,0 +1,221 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <cmath>
+#include <algorithm>
+
+#include "PDETable.h"
+#include "PDE1dException.h"
+
+namespace {
+
+  /*
+   * Shape-preserving slopes for piecewise cubic Hermite interpolation
+   * (Fritsch and Carlson), the same as used by MATLAB pchip.
+   */
+  void pchipSlopes(const RealVector &x, const double *y, size_t stride,
+    double *d)
+  {
+    const size_t n = x.size();
+    auto del = [&](size_t k) {
+      return (y[(k + 1)*stride] - y[k*stride]) / (x(k + 1) - x(k));
+    };
+    if (n == 2) {
+      d[0] = d[stride] = del(0);
+      return;
+    }
+    for (size_t k = 1; k < n - 1; k++) {
+      double d0 = del(k - 1), d1 = del(k);
+      double dk = 0;
+      if (d0*d1 > 0) {
+        double h0 = x(k) - x(k - 1), h1 = x(k + 1) - x(k), hs = h0 + h1;
+        double w1 = (h0 + hs) / (3 * hs), w2 = (hs + h1) / (3 * hs);
+        double dmax = std::max(std::abs(d0), std::abs(d1));
+        double dmin = std::min(std::abs(d0), std::abs(d1));
+        dk = dmin / (w1*(d0 / dmax) + w2*(d1 / dmax));
+      }
+      d[k*stride] = dk;
+    }
+    // non-centered, shape-preserving three-point formula at the ends
+    auto endSlope = [](double h0, double h1, double del0, double del1) {
+      double d = ((2 * h0 + h1)*del0 - h0*del1) / (h0 + h1);
+      if (d*del0 <= 0)
+        d = 0;
+      else if (del0*del1 < 0 && std::abs(d) > std::abs(3 * del0))
+        d = 3 * del0;
+      return d;
+    };
+    d[0] = endSlope(x(1) - x(0), x(2) - x(1), del(0), del(1));
+    d[(n - 1)*stride] = endSlope(x(n - 1) - x(n - 2), x(n - 2) - x(n - 3),
+      del(n - 2), del(n - 3));
+  }
+
+  // cubic Hermite basis functions on [0,1]
+  inline void hermiteBasis(double s, double &h0, double &h1, double &g0,
+    double &g1)
+  {
+    double s2 = s*s, s3 = s2*s;
+    h0 = 2 * s3 - 3 * s2 + 1;
+    h1 = 3 * s2 - 2 * s3;
+    g0 = s3 - 2 * s2 + s;
+    g1 = s3 - s2;
+  }
+
+  void tableError(const char *msg)
+  {
+    throw PDE1dException("pde1d:table", msg);
+  }
+
+}
+
+void PDETable::Grid::set(const RealVector &p, const char *name)
+{
+  char msg[1024];
+  if (p.size() < 2) {
+    sprintf(msg, "Table grid \"%s\" must have at least two points.", name);
+    tableError(msg);
+  }
+  pts = p;
+  last = (int)p.size() - 1;
+  double h = (p(last) - p(0)) / last;
+  uniform = true;
+  for (int i = 0; i < last; i++) {
+    double hi = p(i + 1) - p(i);
+    if (hi <= 0) {
+      sprintf(msg, "Table grid \"%s\" must be strictly increasing.", name);
+      tableError(msg);
+    }
+    if (std::abs(hi - h) > 1e-10*h)
+      uniform = false;
+  }
+  invH = 1 / h;
+}
+
+inline int PDETable::Grid::locate(double p, double &s) const
+{
+  // a NaN coordinate makes the interpolated value NaN
+  if (std::isnan(p)) {
+    s = p;
+    return 0;
+  }
+  double r;
+  int i;
+  if (uniform) {
+    r = (p - pts(0))*invH;
+    r = std::min(std::max(r, 0.), (double)last);
+    i = std::min((int)r, last - 1);
+    s = r - i;
+  }
+  else {
+    const double *b = pts.data();
+    i = (int)(std::upper_bound(b + 1, b + last, p) - b) - 1;
+    s = (p - b[i]) / (b[i + 1] - b[i]);
+    s = std::min(std::max(s, 0.), 1.);
+  }
+  return i;
+}
+
+PDETable::PDETable(const RealVector &x, const RealVector &vals,
+  Method method) : v(vals), method(method), twoD(false)
+{
+  gx.set(x, "x");
+  if (vals.size() != x.size())
+    tableError("The number of table values must equal the number of "
+      "grid points.");
+  if (method == PCHIP) {
+    dx.resize(x.size(), 1);
+    pchipSlopes(x, v.data(), 1, dx.data());
+  }
+}
+
+PDETable::PDETable(const RealVector &x, const RealVector &y,
+  const RealMatrix &vals, Method method) : v(vals), method(method),
+  twoD(true)
+{
+  gx.set(x, "x");
+  gy.set(y, "y");
+  if (vals.rows() != x.size() || vals.cols() != y.size())
+    tableError("The table values must be a matrix with one row for each "
+      "x grid point and one column for each y grid point.");
+  if (method == PCHIP) {
+    const size_t nx = x.size(), ny = y.size();
+    dx.resize(nx, ny);
+    dy.resize(nx, ny);
+    for (size_t j = 0; j < ny; j++)
+      pchipSlopes(x, v.data() + j*nx, 1, dx.data() + j*nx);
+    for (size_t i = 0; i < nx; i++)
+      pchipSlopes(y, v.data() + i, nx, dy.data() + i);
+  }
+}
+
+void PDETable::eval(const double *x, size_t n, double *out) const
+{
+  const double *vp = v.data();
+  double s;
+  if (method == Linear) {
+    for (size_t k = 0; k < n; k++) {
+      int i = gx.locate(x[k], s);
+      out[k] = vp[i] + s*(vp[i + 1] - vp[i]);
+    }
+  }
+  else {
+    const double *dp = dx.data(), *xp = gx.pts.data();
+    double h0, h1, g0, g1;
+    for (size_t k = 0; k < n; k++) {
+      int i = gx.locate(x[k], s);
+      double h = xp[i + 1] - xp[i];
+      hermiteBasis(s, h0, h1, g0, g1);
+      out[k] = h0*vp[i] + h1*vp[i + 1] + h*(g0*dp[i] + g1*dp[i + 1]);
+    }
+  }
+}
+
+void PDETable::eval(const double *x, const double *y, size_t n,
+  double *out) const
+{
+  const size_t nx = v.rows();
+  const double *vp = v.data();
+  double s, t;
+  if (method == Linear) {
+    for (size_t k = 0; k < n; k++) {
+      int i = gx.locate(x[k], s), j = gy.locate(y[k], t);
+      const double *v0 = vp + j*nx + i, *v1 = v0 + nx;
+      double a = v0[0] + s*(v0[1] - v0[0]);
+      double b = v1[0] + s*(v1[1] - v1[0]);
+      out[k] = a + t*(b - a);
+    }
+  }
+  else {
+    // tensor product Hermite interpolation with zero cross derivatives
+    const double *xp = gx.pts.data(), *yp = gy.pts.data();
+    double hx0, hx1, gx0, gx1, hy0, hy1, gy0, gy1;
+    for (size_t k = 0; k < n; k++) {
+      int i = gx.locate(x[k], s), j = gy.locate(y[k], t);
+      double hx = xp[i + 1] - xp[i], hy = yp[j + 1] - yp[j];
+      hermiteBasis(s, hx0, hx1, gx0, gx1);
+      hermiteBasis(t, hy0, hy1, gy0, gy1);
+      size_t i0 = j*nx + i, i1 = i0 + nx;
+      const double *vx = dx.data(), *vy = dy.data();
+      double f0 = hx0*vp[i0] + hx1*vp[i0 + 1] +
+        hx*(gx0*vx[i0] + gx1*vx[i0 + 1]);
+      double f1 = hx0*vp[i1] + hx1*vp[i1 + 1] +
+        hx*(gx0*vx[i1] + gx1*vx[i1 + 1]);
+      double fy0 = hx0*vy[i0] + hx1*vy[i0 + 1];
+      double fy1 = hx0*vy[i1] + hx1*vy[i1 + 1];
+      out[k] = hy0*f0 + hy1*f1 + hy*(gy0*fy0 + gy1*fy1);
+    }
+  }
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1DLIB_PDETABLE_H_
+#define PDE1DLIB_PDETABLE_H_
+
+#include <string>
+#include <map>
+#include <memory>
+
+#include "MatrixTypes.h"
+
+/*
+ * Tabulated function of one or two variables, e.g. a material property
+ * as a function of temperature or concentration. Values between the grid
+ * points are calculated by linear or monotone piecewise cubic (pchip)
+ * interpolation; values outside the grid are those at the nearest end
+ * and the value at a NaN coordinate is NaN.
+ * On a uniformly-spaced grid the interval is calculated directly rather
+ * than by searching.
+ */
+class PDETable {
+public:
+  enum Method { Linear, PCHIP };
+  typedef std::map<std::string, std::shared_ptr<const PDETable>> TableMap;
+  // 1D table with values v at grid points x
+  PDETable(const RealVector &x, const RealVector &v, Method method);
+  // 2D table with values v(i,j) at (x(i),y(j))
+  PDETable(const RealVector &x, const RealVector &y, const RealMatrix &v,
+    Method method);
+  int numArgs() const { return twoD ? 2 : 1; }
+  // out may be the same array as x or y
+  void eval(const double *x, size_t n, double *out) const;
+  void eval(const double *x, const double *y, size_t n, double *out) const;
+private:
+  struct Grid {
+    void set(const RealVector &pts, const char *name);
+    // interval containing p and the local coordinate in [0,1];
+    // s is NaN when p is
+    inline int locate(double p, double &s) const;
+    RealVector pts;
+    bool uniform;
+    double invH;
+    int last;
+  };
+  Grid gx, gy;
+  RealMatrix v;
+  // slopes in the x and y directions for cubic interpolation
+  RealMatrix dx, dy;
+  Method method;
+  bool twoD;
+};
+
+#endif /* PDE1DLIB_PDETABLE_H_ */
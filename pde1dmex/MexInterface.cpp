@@ -103,4 +103,12 @@ Eigen::VectorXd MexInterface::fromMxArrayVec(const mxArray *a)
   Eigen::VectorXd mat(m*n);
   std::copy_n(mxGetPr(a), m*n, mat.data());
   return mat;
-}
\ No newline at end of file
+}
+
+std::string MexInterface::getString(const mxArray *a)
+{
+  char *buf = mxArrayToString(a);
+  std::string str(buf ? buf : "");
+  mxFree(buf);
+  return str;
+}
@@ -42,6 +42,7 @@ public:
   }
   static Eigen::MatrixXd fromMxArray(const mxArray *a);
   static Eigen::VectorXd fromMxArrayVec(const mxArray *a);
+  static std::string getString(const mxArray *a);
 private:
   const int maxOutArgs;
   std::vector<mxArray*> matOutArgs;
@@ -0,0 +1,601 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include "PDE1dMexArgs.h"
+#include "MexInterface.h"
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+
+namespace {
+
+  void checkCoordSys(const mxArray *pM)
+  {
+    if (!mxIsNumeric(pM) || mxGetNumberOfElements(pM) != 1) {
+      pdeErrMsgIdAndTxt("pde1d:invalid_m_type",
+        "First argument must be an integer scalar.");
+    }
+
+    int m = (int)mxGetScalar(pM);
+    if (m != 0 && m != 1 && m != 2)
+      pdeErrMsgIdAndTxt("pde1d:invalid_m_val",
+      "First argument must be either 0, 1, or 2");
+  }
+
+  void checkMeshAndTimes(const mxArray *pX, const mxArray *pT,
+    int minNumTimes)
+  {
+    if (!mxIsNumeric(pX) || mxIsComplex(pX))
+      pdeErrMsgIdAndTxt("pde1d:mesh_type",
+      "Argument \"meshPts\" must be a real vector.");
+    if (mxGetNumberOfElements(pX) < 2)
+      pdeErrMsgIdAndTxt("pde1d:mesh_length",
+      "Length of argument \"meshPts\", must be at least two.");
+
+    if (!mxIsNumeric(pT) || mxIsComplex(pT))
+      pdeErrMsgIdAndTxt("pde1d:time_type",
+      "Argument \"timePts\" must be a real vector.");
+    if (mxGetNumberOfElements(pT) < minNumTimes) {
+      char msg[80];
+      sprintf(msg, "Length of argument \"timePts\", must be at least %d.",
+        minNumTimes);
+      pdeErrMsgIdAndTxt("pde1d:time_length", msg);
+    }
+  }
+
+}
+
+int checkPDEArgs(int nrhs, const mxArray *prhs[], int minNumTimes)
+{
+  // options struct is always the last argument in the
+  // function call
+  int optsArg = -1;
+  if (nrhs == 7)
+    optsArg = 6;
+  else if (nrhs == 10)
+    optsArg = 9;
+  else if (nrhs != 6 && nrhs != 9)
+    pdeErrMsgIdAndTxt("pde1d:nrhs",
+      "Illegal number of input arguments passed to " FUNC_NAME);
+
+  checkCoordSys(prhs[0]);
+
+  for (int i = 1; i < 4; i++) {
+    if (!mxIsFunctionHandle(prhs[i])) {
+      char msg[80];
+      sprintf(msg, "Argument %d is not a function handle.", i + 1);
+      pdeErrMsgIdAndTxt("pde1d:arg_not_func", msg);
+    }
+  }
+
+  checkMeshAndTimes(prhs[4], prhs[5], minNumTimes);
+  return optsArg;
+}
+
+int checkPluginArgs(int nrhs, const mxArray *prhs[])
+{
+  int optsArg = -1;
+  if (nrhs == 5)
+    optsArg = 4;
+  else if (nrhs != 4)
+    pdeErrMsgIdAndTxt("pde1d:nrhs",
+      "Illegal number of input arguments passed to " FUNC_NAME);
+  checkCoordSys(prhs[0]);
+  checkMeshAndTimes(prhs[2], prhs[3], 3);
+  return optsArg;
+}
+
+namespace {
+
+  void getStrings(const mxArray *defn, const char *name,
+    std::vector<std::string> &strs)
+  {
+    const mxArray *val = mxGetField(defn, 0, name);
+    char msg[1024];
+    if (!val) {
+      sprintf(msg, "The problem definition struct must have a field "
+        "named \"%s\".", name);
+      pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+    }
+    if (mxIsChar(val))
+      strs.push_back(MexInterface::getString(val));
+    else if (mxIsCell(val)) {
+      size_t n = mxGetNumberOfElements(val);
+      for (size_t i = 0; i < n; i++) {
+        const mxArray *ci = mxGetCell(val, i);
+        if (!ci || !mxIsChar(ci)) {
+          sprintf(msg, "Entry %d in field \"%s\" is not a string.",
+            (int)i + 1, name);
+          pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+        }
+        strs.push_back(MexInterface::getString(ci));
+      }
+    }
+    else {
+      sprintf(msg, "Field \"%s\" must be a string or a cell array of strings.",
+        name);
+      pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+    }
+  }
+
+  bool isRealDoubleArray(const mxArray *a)
+  {
+    return a && mxIsDouble(a) && !mxIsComplex(a) && !mxIsEmpty(a);
+  }
+
+  // table struct with fields x, v, and optionally, y and method
+  std::shared_ptr<const PDETable> getTable(const char *name,
+    const mxArray *t)
+  {
+    char msg[1024];
+    const mxArray *x = t ? mxGetField(t, 0, "x") : 0;
+    const mxArray *y = t ? mxGetField(t, 0, "y") : 0;
+    const mxArray *v = t ? mxGetField(t, 0, "v") : 0;
+    const mxArray *m = t ? mxGetField(t, 0, "method") : 0;
+    if (!t || !mxIsStruct(t) || !isRealDoubleArray(x) ||
+      !isRealDoubleArray(v) || (y && !isRealDoubleArray(y))) {
+      sprintf(msg, "Table \"%s\" must be a struct with real vector field "
+        "\"x\", real array field \"v\", and optionally, real vector "
+        "field \"y\".", name);
+      pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+    }
+    PDETable::Method method = PDETable::Linear;
+    if (m) {
+      std::string ms = mxIsChar(m) ? MexInterface::getString(m) : "";
+      if (boost::iequals(ms, "pchip"))
+        method = PDETable::PCHIP;
+      else if (!boost::iequals(ms, "linear")) {
+        sprintf(msg, "The method of table \"%s\" must be \"linear\" or "
+          "\"pchip\".", name);
+        pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+      }
+    }
+    try {
+      if (y)
+        return std::make_shared<PDETable>(MexInterface::fromMxArrayVec(x),
+          MexInterface::fromMxArrayVec(y), MexInterface::fromMxArray(v),
+          method);
+      return std::make_shared<PDETable>(MexInterface::fromMxArrayVec(x),
+        MexInterface::fromMxArrayVec(v), method);
+    }
+    catch (const PDE1dException &ex) {
+      sprintf(msg, "In table \"%s\":\n%s", name, ex.what());
+      pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+    }
+    return 0;
+  }
+
+}
+
+void getExpressionDefn(const mxArray *defn,
+  PDE1dExprDefn::Expressions &exprs, PDEExpression::ParamMap &params,
+  PDETable::TableMap &tables)
+{
+  getStrings(defn, "c", exprs.c);
+  getStrings(defn, "f", exprs.f);
+  getStrings(defn, "s", exprs.s);
+  getStrings(defn, "ic", exprs.ic);
+  getStrings(defn, "pl", exprs.pl);
+  getStrings(defn, "ql", exprs.ql);
+  getStrings(defn, "pr", exprs.pr);
+  getStrings(defn, "qr", exprs.qr);
+  const mxArray *tabs = mxGetField(defn, 0, "tables");
+  if (tabs) {
+    if (!mxIsStruct(tabs))
+      pdeErrMsgIdAndTxt("pde1d:expression_defn",
+        "Field \"tables\" must be a struct of table definitions.");
+    int n = mxGetNumberOfFields(tabs);
+    for (int i = 0; i < n; i++) {
+      const char *name = mxGetFieldNameByNumber(tabs, i);
+      tables[name] = getTable(name, mxGetFieldByNumber(tabs, 0, i));
+    }
+  }
+  const mxArray *p = mxGetField(defn, 0, "params");
+  if (!p) return;
+  if (!mxIsStruct(p))
+    pdeErrMsgIdAndTxt("pde1d:expression_defn",
+      "Field \"params\" must be a struct of scalar parameter values.");
+  int n = mxGetNumberOfFields(p);
+  for (int i = 0; i < n; i++) {
+    const mxArray *val = mxGetFieldByNumber(p, 0, i);
+    if (!val || !mxIsNumeric(val) || mxGetNumberOfElements(val) != 1) {
+      char msg[1024];
+      sprintf(msg, "Parameter \"%s\" must be a real scalar.",
+        mxGetFieldNameByNumber(p, i));
+      pdeErrMsgIdAndTxt("pde1d:expression_defn", msg);
+    }
+    params[mxGetFieldNameByNumber(p, i)] = mxGetScalar(val);
+  }
+}
+
+void getOptions(const mxArray *opts, PDE1dOptions &pdeOpts,
+  mxArray* &eventFunc) {
+  if (!mxIsStruct(opts))
+    pdeErrMsgIdAndTxt("pde1d:options_type", 
+    "The last options argument to " FUNC_NAME " must be a struct.");
+  int n = mxGetNumberOfFields(opts);
+  for (int i = 0; i < n; i++) {
+    const char *ni = mxGetFieldNameByNumber(opts, i);
+    mxArray *val = mxGetFieldByNumber(opts, 0, i);
+    // pdepe apparently allows the options field to be set
+    // with odeset. This populates all allowable fileds with empty objects
+    if (mxIsEmpty(val)) continue;
+    if (boost::iequals(ni, "reltol")) 
+      pdeOpts.setRelTol(mxGetScalar(val));
+    else if (boost::iequals(ni, "abstol"))
+      pdeOpts.setAbsTol(mxGetScalar(val));
+    else if (boost::iequals(ni, "vectorized")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      if (boost::iequals(buf, "on"))
+        pdeOpts.setVectorized(true);
+      else if (boost::iequals(buf, "off"))
+        pdeOpts.setVectorized(false);
+      else if (boost::iequals(buf, "auto"))
+        pdeOpts.setVectorizedAuto();
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidVectorized",
+        "The value of the \"Vectorized\" option must be \"On\", \"Off\", "
+        "or \"Auto\".");
+    }
+    else if (boost::iequals(ni, "maxsteps")) {
+      int mxs = (int)mxGetScalar(val);
+      pdeOpts.setMaxSteps(mxs);
+    }
+    else if (boost::iequals(ni, "stats")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool doStats;
+      if (boost::iequals(buf, "on"))
+        doStats = true;
+      else if (boost::iequals(buf, "off"))
+        doStats = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidStats",
+        "The value of the \"Stats\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setPrintStats(doStats);
+    }
+    else if (boost::iequals(ni, "icmethod")) {
+      int icMethod = (int) mxGetScalar(val);
+      pdeOpts.setICMethod(icMethod);
+    }
+    else if (boost::iequals(ni, "icdiagnostics")) {
+      int icDiag = (int) mxGetScalar(val);
+      pdeOpts.setICDiagnostics(icDiag);
+    }
+    else if (boost::iequals(ni, "jacdiagnostics")) {
+      int jacDiag = (int) mxGetScalar(val);
+      pdeOpts.setJacDiagnostics(jacDiag);
+    }
+    else if (boost::iequals(ni, "eqndiagnostics")) {
+      int eqnDiag = (int)mxGetScalar(val);
+      pdeOpts.setEqnDiagnostics(eqnDiag);
+    }
+    else if (boost::iequals(ni, "polyorder")) {
+      int porder = (int)mxGetScalar(val);
+      pdeOpts.setPolyOrder(porder);
+    }
+    else if (boost::iequals(ni, "viewmesh")) {
+      int vumesh = (int)mxGetScalar(val);
+      pdeOpts.setViewMesh(vumesh);
+    }
+    else if (boost::iequals(ni, "diagonalMassMatrix")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool useDiagMassMat;
+      if (boost::iequals(buf, "on"))
+        useDiagMassMat = true;
+      else if (boost::iequals(buf, "off"))
+        useDiagMassMat = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidMassMat",
+          "The value of the \"diagonalMassMatrix\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setDiagMassMat(useDiagMassMat);
+    }
+    else if (boost::iequals(ni, "maxorder")) {
+      int maxOrder = (int)mxGetScalar(val);
+      if (maxOrder < 1 || maxOrder > 5)
+        pdeErrMsgIdAndTxt("pde1d:invalidMaxOrder",
+          "The value of the \"MaxOrder\" option must be between 1 and 5.");
+      pdeOpts.setMaxOrder(maxOrder);
+    }
+    else if (boost::iequals(ni, "initialstep")) {
+      double h = mxGetScalar(val);
+      if (!(h > 0))
+        pdeErrMsgIdAndTxt("pde1d:invalidInitialStep",
+          "The value of the \"InitialStep\" option must be greater than zero.");
+      pdeOpts.setInitialStep(h);
+    }
+    else if (boost::iequals(ni, "maxstep")) {
+      double h = mxGetScalar(val);
+      if (!(h > 0))
+        pdeErrMsgIdAndTxt("pde1d:invalidMaxStep",
+          "The value of the \"MaxStep\" option must be greater than zero.");
+      pdeOpts.setMaxStep(h);
+    }
+    else if (boost::iequals(ni, "maxnonliniters")) {
+      int n = (int)mxGetScalar(val);
+      if (n < 1)
+        pdeErrMsgIdAndTxt("pde1d:invalidMaxNonlinIters",
+          "The value of the \"MaxNonlinIters\" option must be at least one.");
+      pdeOpts.setMaxNonlinIters(n);
+    }
+    else if (boost::iequals(ni, "maxconvfails")) {
+      int n = (int)mxGetScalar(val);
+      if (n < 1)
+        pdeErrMsgIdAndTxt("pde1d:invalidMaxConvFails",
+          "The value of the \"MaxConvFails\" option must be at least one.");
+      pdeOpts.setMaxConvFails(n);
+    }
+    else if (boost::iequals(ni, "maxerrtestfails")) {
+      int n = (int)mxGetScalar(val);
+      if (n < 1)
+        pdeErrMsgIdAndTxt("pde1d:invalidMaxErrTestFails",
+          "The value of the \"MaxErrTestFails\" option must be at least one.");
+      pdeOpts.setMaxErrTestFails(n);
+    }
+    else if (boost::iequals(ni, "autotune")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool autoTune;
+      if (boost::iequals(buf, "on"))
+        autoTune = true;
+      else if (boost::iequals(buf, "off"))
+        autoTune = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidAutoTune",
+          "The value of the \"AutoTune\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setAutoTune(autoTune);
+    }
+    else if (boost::iequals(ni, "batchjacobian")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool batch;
+      if (boost::iequals(buf, "on"))
+        batch = true;
+      else if (boost::iequals(buf, "off"))
+        batch = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidBatchJacobian",
+          "The value of the \"BatchJacobian\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setBatchJacobian(batch);
+    }
+    else if (boost::iequals(ni, "profile")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool prof;
+      if (boost::iequals(buf, "on"))
+        prof = true;
+      else if (boost::iequals(buf, "off"))
+        prof = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidProfile",
+          "The value of the \"Profile\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setProfile(prof);
+    }
+    else if (boost::iequals(ni, "steadystate")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool steadyState;
+      if (boost::iequals(buf, "on"))
+        steadyState = true;
+      else if (boost::iequals(buf, "off"))
+        steadyState = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidSteadyState",
+          "The value of the \"SteadyState\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setSteadyState(steadyState);
+    }
+    else if (boost::iequals(ni, "period")) {
+      double period = mxGetScalar(val);
+      if (period <= 0)
+        pdeErrMsgIdAndTxt("pde1d:invalidPeriod",
+          "The value of the \"Period\" option must be greater than zero.");
+      pdeOpts.setPeriod(period);
+    }
+    else if (boost::iequals(ni, "breakpoints")) {
+      if (!mxIsDouble(val) || mxIsComplex(val))
+        pdeErrMsgIdAndTxt("pde1d:invalidBreakpoints",
+          "The value of the \"Breakpoints\" option must be a real vector.");
+      const double *bp = mxGetPr(val);
+      pdeOpts.setBreakpoints(std::vector<double>(bp,
+        bp + mxGetNumberOfElements(val)));
+    }
+    else if (boost::iequals(ni, "outputx")) {
+      if (!mxIsDouble(val) || mxIsComplex(val))
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputX",
+          "The value of the \"OutputX\" option must be a real vector.");
+      const double *x = mxGetPr(val);
+      pdeOpts.setOutputX(std::vector<double>(x,
+        x + mxGetNumberOfElements(val)));
+    }
+    else if (boost::iequals(ni, "outputcoefficients")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool outCoeffs;
+      if (boost::iequals(buf, "on"))
+        outCoeffs = true;
+      else if (boost::iequals(buf, "off"))
+        outCoeffs = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputCoefficients",
+          "The value of the \"OutputCoefficients\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setOutputCoefficients(outCoeffs);
+    }
+    else if (boost::iequals(ni, "derivedoutputs")) {
+      // a name or cell array of names
+      const bool isCell = mxIsCell(val);
+      const size_t numNames = isCell ? mxGetNumberOfElements(val) : 1;
+      int flags = 0;
+      for (size_t j = 0; j < numNames; j++) {
+        const mxArray *name = isCell ? mxGetCell(val, j) : val;
+        const int buflen = 1024;
+        char buf[buflen];
+        if (!name || !mxIsChar(name) || mxGetString(name, buf, buflen))
+          buf[0] = 0;
+        if (boost::iequals(buf, "dudx"))
+          flags |= PDE1dOptions::DerivedDuDx;
+        else if (boost::iequals(buf, "flux"))
+          flags |= PDE1dOptions::DerivedFlux;
+        else if (boost::iequals(buf, "integrals"))
+          flags |= PDE1dOptions::DerivedIntegrals;
+        else
+          pdeErrMsgIdAndTxt("pde1d:invalidDerivedOutputs",
+            "The value of the \"DerivedOutputs\" option must be one or more of "
+            "\"DuDx\", \"Flux\", and \"Integrals\".");
+      }
+      pdeOpts.setDerivedOutputs(flags);
+    }
+    else if (boost::iequals(ni, "outputprecision")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      if (boost::iequals(buf, "double"))
+        pdeOpts.setOutputPrecision(PDE1dOptions::DoubleOutput);
+      else if (boost::iequals(buf, "single"))
+        pdeOpts.setOutputPrecision(PDE1dOptions::SingleOutput);
+      else if (boost::iequals(buf, "quantized"))
+        pdeOpts.setOutputPrecision(PDE1dOptions::QuantizedOutput);
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputPrecision",
+          "The value of the \"OutputPrecision\" option must be \"Double\", "
+          "\"Single\", or \"Quantized\".");
+    }
+    else if (boost::iequals(ni, "quantizationtol")) {
+      double tol = mxGetScalar(val);
+      if (tol <= 0)
+        pdeErrMsgIdAndTxt("pde1d:invalidQuantizationTol",
+          "The value of the \"QuantizationTol\" option must be greater than zero.");
+      pdeOpts.setQuantizationTol(tol);
+    }
+    else if (boost::iequals(ni, "outputcompression")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool comp;
+      if (boost::iequals(buf, "on"))
+        comp = true;
+      else if (boost::iequals(buf, "off"))
+        comp = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputCompression",
+          "The value of the \"OutputCompression\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setOutputCompression(comp);
+    }
+    else if (boost::iequals(ni, "outputchangetol")) {
+      double tol = mxGetScalar(val);
+      if (tol < 0)
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputChangeTol",
+          "The value of the \"OutputChangeTol\" option must not be negative.");
+      pdeOpts.setOutputChangeTol(tol);
+    }
+    else if (boost::iequals(ni, "outputchangenorm")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      if (boost::iequals(buf, "max"))
+        pdeOpts.setOutputChangeNorm(PDE1dOptions::MaxChangeNorm);
+      else if (boost::iequals(buf, "rms"))
+        pdeOpts.setOutputChangeNorm(PDE1dOptions::RMSChangeNorm);
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputChangeNorm",
+          "The value of the \"OutputChangeNorm\" option must be either "
+          "\"Max\" or \"RMS\".");
+    }
+    else if (boost::iequals(ni, "denseoutput")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool dense;
+      if (boost::iequals(buf, "on"))
+        dense = true;
+      else if (boost::iequals(buf, "off"))
+        dense = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidDenseOutput",
+          "The value of the \"DenseOutput\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setDenseOutput(dense);
+    }
+    else if (boost::iequals(ni, "denseoutputfile")) {
+      if (!mxIsChar(val))
+        pdeErrMsgIdAndTxt("pde1d:invalidDenseOutputFile",
+          "The value of the \"DenseOutputFile\" option must be a file name.");
+      pdeOpts.setDenseOutputFile(MexInterface::getString(val));
+      pdeOpts.setDenseOutput(true);
+    }
+    else if (boost::iequals(ni, "outputthread")) {
+      const int buflen = 1024;
+      char buf[buflen];
+      mxGetString(val, buf, buflen);
+      bool useThread;
+      if (boost::iequals(buf, "on"))
+        useThread = true;
+      else if (boost::iequals(buf, "off"))
+        useThread = false;
+      else
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputThread",
+          "The value of the \"OutputThread\" option must be either \"On\" or \"Off\".");
+      pdeOpts.setOutputThread(useThread);
+    }
+    else if (boost::iequals(ni, "outputfile")) {
+      if (!mxIsChar(val))
+        pdeErrMsgIdAndTxt("pde1d:invalidOutputFile",
+          "The value of the \"OutputFile\" option must be a file name.");
+      pdeOpts.setOutputFile(MexInterface::getString(val));
+    }
+    else if (boost::iequals(ni, "eventsmeshpoints")) {
+      if (!mxIsDouble(val) || mxIsComplex(val))
+        pdeErrMsgIdAndTxt("pde1d:invalidEventsMeshPoints",
+          "The value of the \"EventsMeshPoints\" option must be a vector "
+          "of mesh point indices.");
+      const double *pts = mxGetPr(val);
+      const size_t n = mxGetNumberOfElements(val);
+      std::vector<int> meshPts(n);
+      for (size_t i = 0; i < n; i++) {
+        if (pts[i] != (int)pts[i] || pts[i] < 1)
+          pdeErrMsgIdAndTxt("pde1d:invalidEventsMeshPoints",
+            "The value of the \"EventsMeshPoints\" option must be a vector "
+            "of mesh point indices.");
+        meshPts[i] = (int)pts[i] - 1;
+      }
+      pdeOpts.setEventsMeshPoints(meshPts);
+    }
+    else if (boost::iequals(ni, "events")) {
+      if (!mxIsFunctionHandle(val))
+        pdeErrMsgIdAndTxt("pde1d:invalidEventsFunc",
+          "The value of the \"Events\" option must be a function handle.");
+      eventFunc = val;
+    }
+    else {
+      char msg[1024];
+      sprintf(msg, "The options argument contains the field \"%s\".\n"
+        "This is not a currently-supported option and will be ignored.",
+        ni);
+      mexWarnMsgIdAndTxt("pde1d:unknown_option", msg);
+    }
+  }
+}
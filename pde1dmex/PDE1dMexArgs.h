@@ -0,0 +1,48 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dMexArgs_h
+#define PDE1dMexArgs_h
+
+#include <mex.h>
+
+#include "PDE1dExprDefn.h"
+
+class PDE1dOptions;
+
+/*
+ * Check the arguments of a pde1d call:
+ *   (m,pdeFunc,icFunc,bcFunc,meshPts,timePts[,odeFunc,odeIcFunc,xOde][,options])
+ * and return the index of the options argument or -1 if there is none.
+ */
+int checkPDEArgs(int nrhs, const mxArray *prhs[], int minNumTimes = 3);
+/*
+ * Check the arguments of a pde1d call with a compiled problem definition
+ * or one defined by expressions:
+ *   (m,libPath|defnStruct,meshPts,timePts[,options])
+ */
+int checkPluginArgs(int nrhs, const mxArray *prhs[]);
+/*
+ * Get the expressions, parameters, and tables from a problem definition
+ * struct with fields c, f, s, ic, pl, ql, pr, qr, and optionally, params
+ * and tables.
+ */
+void getExpressionDefn(const mxArray *defn,
+  PDE1dExprDefn::Expressions &exprs, PDEExpression::ParamMap &params,
+  PDETable::TableMap &tables);
+void getOptions(const mxArray *opts, PDE1dOptions &pdeOpts,
+  mxArray* &eventFunc);
+
+#endif
@@ -29,18 +29,7 @@ using std::endl;
 #include "PDE1dMexInt.h"
 #include "MexInterface.h"
 #include "PDE1dException.h"
-
-void pdePrintf(const char* format, ...)
-{
-  va_list ap;
-  va_start(ap, format);
-  char msg[4096];
-  vsprintf(msg, format, ap);
-  va_end(ap);
-  // matlab mex connects cout to console but not printf
-  //std::cout << msg;
-  mexPrintf(msg);
-}
+#include "PDE1dProfiler.h"
 
 namespace {
 
@@ -80,6 +69,8 @@ PDE1dMexInt::PDE1dMexInt(int m, const mxArray *pdefun, const mxArray *icfun,
   mxVec2 = mxCreateDoubleMatrix(numPDE, 1, mxREAL);
   mxMat1 = mxCreateDoubleMatrix(numPDE, numMesh, mxREAL);
   mxMat2 = mxCreateDoubleMatrix(numPDE, numMesh, mxREAL);
+  mxXPts = mxCreateDoubleMatrix(1, numMesh, mxREAL);
+  std::fill_n(pdeOutArgs, 3, nullptr);
   odefun = 0;
   odeIcFun = 0;
   odeMesh = 0;
@@ -95,6 +86,8 @@ PDE1dMexInt::PDE1dMexInt(int m, const mxArray *pdefun, const mxArray *icfun,
   numEvents = 0;
   mxM = 0;
   mxEventsU = 0;
+  mxEventsX = 0;
+  isPersistent = false;
 }
 
 
@@ -107,6 +100,9 @@ PDE1dMexInt::~PDE1dMexInt()
   mxDestroyArray(mxVec2);
   destroy(mxMat1);
   destroy(mxMat2);
+  destroy(mxXPts);
+  for (mxArray *a : pdeOutArgs)
+    destroy(a);
   destroy(mxV);
   destroy(mxVDot);
   destroy(mxOdeU);
@@ -116,6 +112,23 @@ PDE1dMexInt::~PDE1dMexInt()
   destroy(mxOdeDuDxDt);
   destroy(mxM);
   destroy(mxEventsU);
+  destroy(mxEventsX);
+}
+
+void PDE1dMexInt::makePersistent()
+{
+  mxArray *arrays[] = { mxX1, mxX2, mxT, mxVec1, mxVec2, mxMat1, mxMat2,
+    mxXPts, mxV, mxVDot, mxOdeU, mxOdeDuDx, mxOdeR, mxOdeDuDt, mxOdeDuDxDt,
+    mxM, mxEventsU, mxEventsX };
+  for (mxArray *a : arrays) {
+    if (a)
+      mexMakeArrayPersistent(a);
+  }
+  for (mxArray *a : pdeOutArgs) {
+    if (a)
+      mexMakeArrayPersistent(a);
+  }
+  isPersistent = true;
 }
 
 void PDE1dMexInt::setODEDefn(const mxArray *odeFun, const mxArray *icFun,
@@ -140,12 +153,26 @@ void PDE1dMexInt::setEventsFunction(const mxArray *eventsFun) {
   if (!eventsFun) return;
   this->eventsFun = eventsFun;
   setNumEvents();
-  mwSize nn = static_cast<mwSize>(mesh.size());
+  const std::vector<int> &pts = getEventsMeshPoints();
+  mwSize nn = static_cast<mwSize>(pts.empty() ? mesh.size() : pts.size());
   mxEventsU = mxCreateDoubleMatrix(nn*numPDE, 1, mxREAL);
 }
 
+void PDE1dMexInt::setEventsMeshPoints(const std::vector<int> &pts)
+{
+  PDE1dDefn::setEventsMeshPoints(pts);
+  destroy(mxEventsX);
+  mxEventsX = 0;
+  if (pts.empty()) return;
+  mxEventsX = mxCreateDoubleMatrix(1, pts.size(), mxREAL);
+  double *x = mxGetPr(mxEventsX);
+  for (size_t i = 0; i < pts.size(); i++)
+    x[i] = mesh[pts[i]];
+}
+
 void PDE1dMexInt::evalIC(double x, RealVector &ic)
 {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::ICFunc);
   setScalar(x, mxX1);
   const int nargout = 1, nargin = 2;
   const mxArray *funcInp[] = { icfun, mxX1 };
@@ -155,6 +182,7 @@ void PDE1dMexInt::evalIC(double x, RealVector &ic)
 
 void PDE1dMexInt::evalODEIC(RealVector &ic)
 {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::ODEICFunc);
   const int nargout = 1, nargin = 1;
   const mxArray *funcInp[] = { odeIcFun };
   RealVector *outArgs[] = { &ic };
@@ -164,6 +192,7 @@ void PDE1dMexInt::evalODEIC(RealVector &ic)
 void PDE1dMexInt::evalBC(double xl, const RealVector &ul,
   double xr, const RealVector &ur, double t, 
   const RealVector &v, const RealVector &vDot, BC &bc) {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::BCFunc, 2);
   setScalar(xl, mxX1);
   setVector(ul, mxVec1);
   setScalar(xr, mxX2);
@@ -185,6 +214,7 @@ void PDE1dMexInt::evalBC(double xl, const RealVector &ul,
 void PDE1dMexInt::evalPDE(double x, double t,
   const RealVector &u, const RealVector &DuDx, 
   const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::PDEFunc);
   // Evaluate pde coefficients one point at a time
   // [c,f,s] = heatpde(x,t,u,DuDx)
   setScalar(x, mxX1);
@@ -216,9 +246,10 @@ void PDE1dMexInt::evalPDE(const RealVector &x, double t,
   const RealMatrix &u, const RealMatrix &DuDx, 
   const RealVector &v, const RealVector &vDot, PDECoeff &pde)
 {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::PDEFunc, x.size());
   // Evaluate pde coefficients at all x-locations
   // [c,f,s] = heatpde(x,t,u,DuDx)
-  setMatrix(x.transpose(), mxX1);
+  setMatrix(x.transpose(), mxXPts);
   setScalar(t, mxT);
   setMatrix(u, mxMat1);
   setMatrix(DuDx, mxMat2);
@@ -229,17 +260,63 @@ void PDE1dMexInt::evalPDE(const RealVector &x, double t,
     setVector(v, mxV);
     setVector(vDot, mxVDot);
   }
-  const mxArray *funcInp[] = { pdefun, mxX1, mxT, mxMat1, mxMat2,
+  const mxArray *funcInp[] = { pdefun, mxXPts, mxT, mxMat1, mxMat2,
   mxV, mxVDot};
   RealMatrix *outArgs[] = { &pde.c, &pde.f, &pde.s };
   callMatlab(funcInp, nargin, outArgs, nargout);
 }
 
+bool PDE1dMexInt::getPDEArgBuffers(size_t numPts, double *&x, double *&u,
+  double *&DuDx)
+{
+  // the solver writes the arguments directly into the mxArrays
+  setSize(1, numPts, mxXPts);
+  setSize(numPDE, numPts, mxMat1);
+  setSize(numPDE, numPts, mxMat2);
+  x = mxGetPr(mxXPts);
+  u = mxGetPr(mxMat1);
+  DuDx = mxGetPr(mxMat2);
+  return true;
+}
+
+void PDE1dMexInt::evalPDEBuffers(double t, const RealVector &v,
+  const RealVector &vDot, PDECoeffView &pde)
+{
+  const size_t numPts = mxGetN(mxXPts);
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::PDEFunc, numPts);
+  setScalar(t, mxT);
+  const int nargout = 3;
+  int nargin = 5;
+  if (numODE) {
+    nargin = 7;
+    setVector(v, mxV);
+    setVector(vDot, mxVDot);
+  }
+  for (mxArray *&a : pdeOutArgs) {
+    destroy(a);
+    a = nullptr;
+  }
+  const mxArray *funcInp[] = { pdefun, mxXPts, mxT, mxMat1, mxMat2,
+    mxV, mxVDot };
+  callMatlab(funcInp, nargin, nargout);
+  // keep the returned arrays and let the solver read them in place
+  std::copy_n(matOutArgs, nargout, pdeOutArgs);
+  for (int i = 0; i < nargout; i++) {
+    checkReturnedArg(pdefun, i, pdeOutArgs[i], numPDE, numPts);
+    if (isPersistent)
+      mexMakeArrayPersistent(pdeOutArgs[i]);
+  }
+  pde.c = mxGetPr(pdeOutArgs[0]);
+  pde.f = mxGetPr(pdeOutArgs[1]);
+  pde.s = mxGetPr(pdeOutArgs[2]);
+}
+
 void PDE1dMexInt::evalODE(double t, const RealVector &v,
   const RealVector &vdot, const RealMatrix &u, const RealMatrix &DuDx,
   const RealMatrix &odeR, const RealMatrix &odeDuDt,
   const RealMatrix &odeDuDxDt, RealVector &f)
 {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::ODEFunc, u.cols());
   // odeFunc(t,v,vdot,x,u,DuDx)
   setScalar(t, mxT);
   setVector(v, mxV);
@@ -261,12 +338,15 @@ void PDE1dMexInt::evalEvents(double t, const RealMatrix &u,
   RealVector &eventsVal, RealVector &eventsIsTerminal, 
   RealVector &eventsDirection)
 {
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::EventsFunc,
+    u.size() / numPDE);
   // [value,isterminal,direction] = events(m,t,xmesh,umesh)
   eventsIsTerminal.setZero();
   eventsDirection.setZero();
   setScalar(t, mxT);
   setMatrix(u, mxEventsU);
-  const mxArray *funcInp[] = { eventsFun, mxM, mxT, xmesh, mxEventsU };
+  const mxArray *funcInp[] = { eventsFun, mxM, mxT, eventsXMesh(),
+    mxEventsU };
   RealVector *outArgs[] = {&eventsVal, &eventsIsTerminal, &eventsDirection};
   const int nargout = 3;
   const int nargin = 5;
@@ -286,17 +366,39 @@ const RealVector &PDE1dMexInt::getTimeSpan() const { return tSpan; }
 
 void PDE1dMexInt::callMatlab(const mxArray *inArgs[], int nargin, int nargout) {
   std::fill_n(matOutArgs, nargout, nullptr);
-  int err = mexCallMATLAB(nargout, matOutArgs, nargin,
+  // errors are trapped so that they can be handled, e.g. when checking
+  // whether the pde function is vectorized, and so the stack is unwound
+  mxArray *ex = mexCallMATLABWithTrap(nargout, matOutArgs, nargin,
     const_cast<mxArray**>(inArgs), "feval");
-  if (err) {
-    char msg[1024];
+  if (ex) {
+    char msg[2048];
     std::string funcName = getFuncNameFromHandle(inArgs[0]);
-    sprintf(msg, "An error occurred in the call to user-defined function:\n\"%s\".",
-      funcName.c_str());
+    std::string exMsg = getErrorMessage(ex);
+    mxDestroyArray(ex);
+    snprintf(msg, sizeof(msg), "An error occurred in the call to user-defined "
+      "function:\n\"%s\".\n%s", funcName.c_str(), exMsg.c_str());
     pdeErrMsgIdAndTxt("pde1d:mexCallMATLAB:err", msg);
   }
 }
 
+std::string PDE1dMexInt::getErrorMessage(const mxArray *ex)
+{
+  // MATLAB returns an MException object, Octave a struct
+  std::string msg;
+  if (mxIsStruct(ex)) {
+    const mxArray *m = mxGetField(ex, 0, "message");
+    if (m && mxIsChar(m))
+      msg = MexInterface::getString(m);
+  }
+  else {
+    mxArray *m = mxGetProperty(ex, 0, "message");
+    if (m && mxIsChar(m))
+      msg = MexInterface::getString(m);
+    destroy(m);
+  }
+  return msg;
+}
+
 void PDE1dMexInt::callMatlab(const mxArray *inArgs[], int nargin,
   RealVector *outArgs[], int nargout)
 {
@@ -355,15 +457,12 @@ void PDE1dMexInt::checkMxType(const mxArray *a, int argIndex, const mxArray *fun
 
 }
 
-template<typename T>
-void PDE1dMexInt::processReturnedArg(const mxArray* callingFunc,
-  int argNum, const mxArray* retArg, T* outArg) {
+void PDE1dMexInt::checkReturnedArg(const mxArray* callingFunc,
+  int argNum, const mxArray* retArg, size_t exRows, size_t exCols) {
   if (!retArg)
     pdeErrMsgIdAndTxt("pde1d:mexCallMATLAB:arg", "Error in mexCallMATLAB arg.");
   size_t retRows = mxGetM(retArg);
   size_t retCols = mxGetN(retArg);
-  size_t exRows = outArg->rows();
-  size_t exCols = outArg->cols();
   bool dimsOK = false;
   bool isVec = exCols == 1;
   if (isVec)
@@ -382,7 +481,14 @@ void PDE1dMexInt::processReturnedArg(const mxArray* callingFunc,
     pdeErrMsgIdAndTxt("pde1d:mexCallMATLAB:arglen", msg);
   }
   checkMxType(retArg, argNum, callingFunc);
-  std::copy_n(mxGetPr(retArg), retRows*retCols, outArg->data());
+}
+
+template<typename T>
+void PDE1dMexInt::processReturnedArg(const mxArray* callingFunc,
+  int argNum, const mxArray* retArg, T* outArg) {
+  checkReturnedArg(callingFunc, argNum, retArg, outArg->rows(),
+    outArg->cols());
+  std::copy_n(mxGetPr(retArg), outArg->size(), outArg->data());
 }
 
 
@@ -427,14 +533,15 @@ void PDE1dMexInt::setNumEvents()
   int *mxMptr = reinterpret_cast<int*>(mxGetPr(mxM));
   mxMptr[0] = mCoord;
   setScalar(tSpan[0], mxT);
-  const size_t numMesh = mesh.size();
-  RealMatrix u(numPDE, numMesh);
-  // get initial conditions at all points in the mesh
+  const std::vector<int> &pts = getEventsMeshPoints();
+  const size_t numPts = pts.empty() ? mesh.size() : pts.size();
+  RealMatrix u(numPDE, numPts);
+  // get initial conditions at the events mesh points
   mxArray *initCond = 0;
   const mxArray *funcInpIC[] = { icfun, mxX1 };
   double *mxXptr = mxGetPr(mxX1);
-  for (int i = 0; i < numMesh; i++) {
-    *mxXptr = mesh[i];
+  for (int i = 0; i < numPts; i++) {
+    *mxXptr = mesh[pts.empty() ? i : pts[i]];
     int err = mexCallMATLAB(1, &initCond, 2,
       const_cast<mxArray**>(funcInpIC), "feval");
     if (err)
@@ -451,7 +558,7 @@ void PDE1dMexInt::setNumEvents()
     destroy(initCond);
   }
   setMatrix(u, mxVec1);
-  const mxArray *funcInp[] = { eventsFun, mxM, mxT, xmesh, mxVec1 };
+  const mxArray *funcInp[] = { eventsFun, mxM, mxT, eventsXMesh(), mxVec1 };
   int nargin = sizeof(funcInp) / sizeof(funcInp[0]);
   int nargout = 3;
   int err = mexCallMATLAB(nargout, matOutArgs, 
@@ -52,6 +52,10 @@ public:
   virtual void evalPDE(const RealVector &x, double t,
     const RealMatrix &u, const RealMatrix &DuDx, 
     const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual bool getPDEArgBuffers(size_t numPts, double *&x, double *&u,
+    double *&DuDx);
+  virtual void evalPDEBuffers(double t, const RealVector &v,
+    const RealVector &vDot, PDECoeffView &pde);
   virtual const RealVector &getMesh() const;
   virtual const RealVector &getODEMesh();
   virtual const RealVector &getTimeSpan() const;
@@ -65,46 +69,61 @@ public:
     const RealMatrix &odeDuDt, const RealMatrix &odeDuDxDt,
     RealVector &f);
   void setEventsFunction(const mxArray *eventsFun);
+  virtual void setEventsMeshPoints(const std::vector<int> &pts);
   virtual int getNumEvents() const { return numEvents; }
   virtual void evalEvents(double t, const RealMatrix &u,
     RealVector &eventsVal, RealVector &eventsIsTerminal,
     RealVector &eventsDirection);
+  // replace a user-defined function between calls, e.g. in a session
+  void setPDEFunction(const mxArray *pdeFun) { pdefun = pdeFun; }
+  void setBCFunction(const mxArray *bcFun) { bcfun = bcFun; }
+  void setODEFunction(const mxArray *odeFun) { odefun = odeFun; }
+  // keep all work arrays alive between mex function calls
+  void makePersistent();
 private:
-  static void setScalar(double x, mxArray *a) {
+  void setScalar(double x, mxArray *a) {
     const int vr = 1, vc = 1;
     if (vr != mxGetM(a) || vc != mxGetN(a)) {
-      double *pr = (double*)mxRealloc(mxGetPr(a), sizeof(double));
+      double *pr = reallocPr(a, sizeof(double));
       mxSetM(a, vr);
       mxSetN(a, vc);
       mxSetPr(a, pr);
     }
     double *p = mxGetPr(a); p[0] = x;
   }
-  template<class T>
-  static void setMxImpl(const T &ea, mxArray *a) {
-    size_t vr = ea.rows(), vc = ea.cols(), s = ea.size();
+  void setSize(size_t vr, size_t vc, mxArray *a) {
     if (vr != mxGetM(a) || vc != mxGetN(a)) {
-      double *pr = (double*)mxRealloc(mxGetPr(a), s*sizeof(double));
+      double *pr = reallocPr(a, vr*vc*sizeof(double));
       mxSetM(a, vr);
       mxSetN(a, vc);
       mxSetPr(a, pr);
     }
-    std::copy_n(ea.data(), s, mxGetPr(a));
   }
   template<class T>
-  static void setVector(const T &v, mxArray *a) {
+  void setMxImpl(const T &ea, mxArray *a) {
+    setSize(ea.rows(), ea.cols(), a);
+    std::copy_n(ea.data(), ea.size(), mxGetPr(a));
+  }
+  template<class T>
+  void setVector(const T &v, mxArray *a) {
     size_t s = v.size();
     if (s != mxGetM(a) || mxGetN(a) != 1) {
-      double *pr = (double*)mxRealloc(mxGetPr(a), s * sizeof(double));
+      double *pr = reallocPr(a, s * sizeof(double));
       mxSetM(a, s);
       mxSetN(a, 1);
       mxSetPr(a, pr);
     }
     std::copy_n(v.data(), s, mxGetPr(a));
   }
-  static void setMatrix(const RealMatrix &v, mxArray *a) {
+  void setMatrix(const RealMatrix &v, mxArray *a) {
     setMxImpl(v, a);
   }
+  double *reallocPr(mxArray *a, size_t numBytes) {
+    double *pr = (double*)mxRealloc(mxGetPr(a), numBytes);
+    if (isPersistent)
+      mexMakeMemoryPersistent(pr);
+    return pr;
+  }
   void setNumPde();
   void setNumOde();
   void setNumEvents();
@@ -115,7 +134,10 @@ private:
     RealMatrix *outArgs[], int nargout);
   void callMatlab(const mxArray *inArgs[], int nargin, int nargout);
   static std::string getFuncNameFromHandle(const mxArray *funcHandle);
+  static std::string getErrorMessage(const mxArray *ex);
   void checkMxType(const mxArray *a, int argIndex, const mxArray *funcHandle);
+  void checkReturnedArg(const mxArray* callingFunc, int argNum,
+    const mxArray* retArg, size_t exRows, size_t exCols);
   template<typename T>
   void processReturnedArg(const mxArray* callingFunc,
     int argNum, const mxArray* retArg, T *outArg);
@@ -131,6 +153,10 @@ private:
 
   mxArray *mxX1, *mxX2, *mxT; // scalar x and t
   mxArray *mxVec1, *mxVec2, *mxMat1, *mxMat2; // input to pde function
+  mxArray *mxXPts; // x-values for vectorized pde function
+  // c, f, s returned from the vectorized pde function; these are
+  // referenced by the solver until the next call
+  mxArray *pdeOutArgs[3];
   mxArray *mxV, *mxVDot, *mxOdeU, *mxOdeDuDx, *mxOdeR, 
     *mxOdeDuDt, *mxOdeDuDxDt;
   static const int maxMatlabRetArgs = 4;
@@ -138,7 +164,12 @@ private:
 
   const mxArray *eventsFun;
   mxArray *mxM;
-  mxArray *mxEventsU; // solution at mesh points
+  mxArray *mxEventsU; // solution at the events mesh points
+  mxArray *mxEventsX; // x at the events mesh points; null for all points
+  const mxArray *eventsXMesh() const {
+    return mxEventsX ? mxEventsX : xmesh;
+  }
+  bool isPersistent;
 };
 
 #ifdef _MSC_VER
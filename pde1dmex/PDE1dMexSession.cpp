@@ -0,0 +1,223 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <map>
+
+#include <boost/algorithm/string.hpp>
+
+#include "PDE1dMexSession.h"
+#include "PDE1dMexArgs.h"
+#include "PDE1dMexInt.h"
+#include "MexInterface.h"
+#include "PDE1dImpl.h"
+#include "PDEModel.h"
+#include "SunVector.h"
+#include "PDE1dException.h"
+
+namespace {
+
+  typedef std::map<int, std::unique_ptr<PDE1dMexSession>> SessionMap;
+  SessionMap sessions;
+  int lastSessionId = 0;
+
+  void deleteAllSessions()
+  {
+    sessions.clear();
+  }
+
+  PDE1dMexSession &getSession(int nrhs, const mxArray *prhs[])
+  {
+    if (nrhs < 2 || !mxIsNumeric(prhs[1]) ||
+      mxGetNumberOfElements(prhs[1]) != 1)
+      pdeErrMsgIdAndTxt("pde1d:invalid_session",
+        "The second argument must be a handle returned from "
+        "pde1d('init',...).");
+    int id = (int)mxGetScalar(prhs[1]);
+    SessionMap::iterator s = sessions.find(id);
+    if (s == sessions.end())
+      pdeErrMsgIdAndTxt("pde1d:invalid_session",
+        "The pde1d session handle is not valid; it may have been deleted.");
+    return *s->second;
+  }
+
+}
+
+PDE1dMexSession::PDE1dMexSession(int nrhs, const mxArray *prhs[]) :
+  needsRestart(false)
+{
+  int optsArg = checkPDEArgs(nrhs, prhs, 2);
+  const bool hasODE = nrhs > 7;
+  int m = (int)mxGetScalar(prhs[0]);
+
+  // the function handles and other arguments are referenced after this
+  // call returns so persistent copies are needed
+  const mxArray *args[10];
+  for (int i = 0; i < nrhs; i++)
+    args[i] = keep(prhs[i]);
+
+  mxArray *eventsFunc = 0;
+  if (optsArg > 0)
+    getOptions(args[optsArg], opts, eventsFunc);
+
+  pde = std::unique_ptr<PDE1dMexInt>(new PDE1dMexInt(m, args[1], args[2],
+    args[3], args[4], args[5]));
+  pde->applyEventsMeshPoints(opts);
+  pde->setEventsFunction(eventsFunc);
+  if (hasODE)
+    pde->setODEDefn(args[6], args[7], args[8]);
+  pde->makePersistent();
+  pdeImpl = std::unique_ptr<PDE1dImpl>(new PDE1dImpl(*pde, opts));
+  pdeImpl->initTransient();
+}
+
+PDE1dMexSession::~PDE1dMexSession()
+{
+  // destroy the solver before the arrays it references
+  pdeImpl.reset();
+  pde.reset();
+}
+
+PDE1dMexSession::PersistentArrays::~PersistentArrays()
+{
+  for (mxArray *a : *this)
+    mxDestroyArray(a);
+}
+
+const mxArray *PDE1dMexSession::keep(const mxArray *a)
+{
+  mxArray *ac = mxDuplicateArray(a);
+  mexMakeArrayPersistent(ac);
+  persistentArgs.push_back(ac);
+  return ac;
+}
+
+void PDE1dMexSession::advance(double tNext, bool stopAtTNext)
+{
+  if (needsRestart)
+    reinit();
+  pdeImpl->advance(tNext, stopAtTNext);
+}
+
+void PDE1dMexSession::setFunction(const char *name,
+  const mxArray *funcHandle)
+{
+  if (!mxIsFunctionHandle(funcHandle))
+    pdeErrMsgIdAndTxt("pde1d:arg_not_func",
+      "The new value of the function must be a function handle.");
+  if (boost::iequals(name, "pdefunc"))
+    pde->setPDEFunction(keep(funcHandle));
+  else if (boost::iequals(name, "bcfunc"))
+    pde->setBCFunction(keep(funcHandle));
+  else if (boost::iequals(name, "odefunc")) {
+    if (!pde->getNumODE())
+      pdeErrMsgIdAndTxt("pde1d:no_ode",
+        "An ODE function can not be set because there are no ODE in the system.");
+    pde->setODEFunction(keep(funcHandle));
+  }
+  else {
+    char msg[1024];
+    sprintf(msg, "\"%s\" is not a function that can be changed.\n"
+      "Valid names are \"pdeFunc\", \"bcFunc\", and \"odeFunc\".", name);
+    pdeErrMsgIdAndTxt("pde1d:invalid_func_name", msg);
+  }
+  // the change is assumed to be discontinuous so the integrator
+  // is restarted before the next step
+  needsRestart = true;
+}
+
+void PDE1dMexSession::reinit()
+{
+  pdeImpl->reinitTransient();
+  needsRestart = false;
+}
+
+void PDE1dMexSession::getState(int nlhs, mxArray *plhs[]) const
+{
+  const SunVector &u = pdeImpl->getCurrentSolution();
+  const PDEModel &model = pdeImpl->getModel();
+  const int numPde = pde->getNumPDE(), numOde = pde->getNumODE();
+  const size_t numMesh = pde->getMesh().size();
+  RealMatrix uMesh(numPde, numMesh);
+  model.globalToMeshVec(u, uMesh);
+  // same layout as one time step of the pde1d solution
+  RealMatrix uMeshT = uMesh.transpose();
+  plhs[0] = MexInterface::toMxArray(uMeshT);
+  int lhsIndex = 1;
+  if (lhsIndex < nlhs) {
+    RealVector uOde = u.bottomRows(numOde);
+    plhs[lhsIndex++] = MexInterface::toMxArray(uOde);
+  }
+  if (lhsIndex < nlhs)
+    plhs[lhsIndex++] = mxCreateDoubleScalar(pdeImpl->getCurrentTime());
+}
+
+void pde1dSessionCommand(int nlhs, mxArray *plhs[],
+  int nrhs, const mxArray *prhs[])
+{
+  const int buflen = 1024;
+  char cmd[buflen];
+  mxGetString(prhs[0], cmd, buflen);
+  if (boost::iequals(cmd, "init")) {
+    if (nlhs > 1)
+      pdeErrMsgIdAndTxt("pde1d:nlhs",
+        "pde1d('init',...) returns only a single session handle.");
+    std::unique_ptr<PDE1dMexSession> s(new PDE1dMexSession(nrhs - 1, prhs + 1));
+    int id = ++lastSessionId;
+    if (sessions.empty()) {
+      // sessions must not be lost if the mex file is cleared
+      mexLock();
+      mexAtExit(deleteAllSessions);
+    }
+    sessions[id] = std::move(s);
+    plhs[0] = mxCreateDoubleScalar(id);
+  }
+  else if (boost::iequals(cmd, "advance")) {
+    PDE1dMexSession &s = getSession(nrhs, prhs);
+    if (nrhs < 3 || !mxIsNumeric(prhs[2]) ||
+      mxGetNumberOfElements(prhs[2]) != 1)
+      pdeErrMsgIdAndTxt("pde1d:time_type",
+        "The third argument to pde1d('advance',...) must be a real scalar.");
+    bool stopAtTNext = nrhs > 3 && mxGetScalar(prhs[3]) != 0;
+    s.advance(mxGetScalar(prhs[2]), stopAtTNext);
+    s.getState(nlhs, plhs);
+  }
+  else if (boost::iequals(cmd, "state")) {
+    getSession(nrhs, prhs).getState(nlhs, plhs);
+  }
+  else if (boost::iequals(cmd, "set")) {
+    PDE1dMexSession &s = getSession(nrhs, prhs);
+    if (nrhs != 4 || !mxIsChar(prhs[2]))
+      pdeErrMsgIdAndTxt("pde1d:nrhs",
+        "Usage is pde1d('set',h,funcName,funcHandle).");
+    char name[buflen];
+    mxGetString(prhs[2], name, buflen);
+    s.setFunction(name, prhs[3]);
+  }
+  else if (boost::iequals(cmd, "reinit")) {
+    getSession(nrhs, prhs).reinit();
+  }
+  else if (boost::iequals(cmd, "delete")) {
+    getSession(nrhs, prhs);
+    sessions.erase((int)mxGetScalar(prhs[1]));
+    if (sessions.empty())
+      mexUnlock();
+  }
+  else {
+    char msg[1024];
+    sprintf(msg, "\"%s\" is not a valid pde1d command.", cmd);
+    pdeErrMsgIdAndTxt("pde1d:invalid_command", msg);
+  }
+}
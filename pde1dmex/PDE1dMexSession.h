@@ -0,0 +1,68 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dMexSession_h
+#define PDE1dMexSession_h
+
+#include <vector>
+#include <memory>
+
+#include <mex.h>
+
+#include "PDE1dOptions.h"
+
+class PDE1dMexInt;
+class PDE1dImpl;
+
+/*
+ * A pde1d solution that persists between mex function calls so that
+ * it can be advanced incrementally in time, e.g. when pde1d is coupled
+ * to an external model.
+ *
+ * h = pde1d('init',m,pdeFunc,icFunc,bcFunc,meshPts,timePts,...)
+ * [u,uOde,t] = pde1d('advance',h,tNext)
+ * [u,uOde,t] = pde1d('advance',h,tNext,stopAtTNext)
+ * [u,uOde,t] = pde1d('state',h)
+ * pde1d('set',h,'pdeFunc'|'bcFunc'|'odeFunc',funcHandle)
+ * pde1d('reinit',h)
+ * pde1d('delete',h)
+ */
+class PDE1dMexSession {
+public:
+  PDE1dMexSession(int nrhs, const mxArray *prhs[]);
+  ~PDE1dMexSession();
+  void advance(double tNext, bool stopAtTNext);
+  void setFunction(const char *name, const mxArray *funcHandle);
+  void reinit();
+  void getState(int nlhs, mxArray *plhs[]) const;
+private:
+  const mxArray *keep(const mxArray *a);
+  // owns the persistent copies of the arguments so that they are also
+  // destroyed when construction fails; declared first so that it is
+  // destroyed after the solver that references them
+  struct PersistentArrays : public std::vector<mxArray*> {
+    ~PersistentArrays();
+  };
+  PersistentArrays persistentArgs;
+  PDE1dOptions opts;
+  std::unique_ptr<PDE1dMexInt> pde;
+  std::unique_ptr<PDE1dImpl> pdeImpl;
+  bool needsRestart;
+};
+
+void pde1dSessionCommand(int nlhs, mxArray *plhs[],
+  int nrhs, const mxArray *prhs[]);
+
+#endif
@@ -16,21 +16,30 @@
 #include <stdio.h>
 #include <stdexcept>
 #include <iostream>
+#include <memory>
 using std::cout;
 using std::endl;
 
-#include <boost/multi_array.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include <mex.h>
 
 #include "MexInterface.h"
 #include "PDE1dMexInt.h"
+#include "PDE1dPluginDefn.h"
+#include "PDE1dExprDefn.h"
+#include "PDE1dMexArgs.h"
+#include "PDE1dMexSession.h"
+#include "PDE1dDriver.h"
 #include "PDE1dImpl.h"
 #include "PDE1dOptions.h"
 #include "PDESolution.h"
+#include "PDESolutionFile.h"
+#include "PDESolutionQuery.h"
+#include "PDEDenseOutput.h"
 #include "PDE1dException.h"
-#include "PDE1dWarningMsg.h"
+#include "PDE1dMessages.h"
+#include "PDE1dProfiler.h"
 
 typedef double Float;
 
@@ -63,111 +72,286 @@ namespace {
     return ma;
   }
 
-  void getOptions(const mxArray *opts, PDE1dOptions &pdeOpts,
-    mxArray* &eventFunc) {
-    if (!mxIsStruct(opts))
-      pdeErrMsgIdAndTxt("pde1d:options_type", 
-      "The last options argument to " FUNC_NAME " must be a struct.");
-    int n = mxGetNumberOfFields(opts);
-    for (int i = 0; i < n; i++) {
-      const char *ni = mxGetFieldNameByNumber(opts, i);
-      mxArray *val = mxGetFieldByNumber(opts, 0, i);
-      // pdepe apparently allows the options field to be set
-      // with odeset. This populates all allowable fileds with empty objects
-      if (mxIsEmpty(val)) continue;
-      if (boost::iequals(ni, "reltol")) 
-        pdeOpts.setRelTol(mxGetScalar(val));
-      else if (boost::iequals(ni, "abstol"))
-        pdeOpts.setAbsTol(mxGetScalar(val));
-      else if (boost::iequals(ni, "vectorized")) {
-        const int buflen = 1024;
-        char buf[buflen];
-        mxGetString(val, buf, buflen);
-        bool isVec;
-        if (boost::iequals(buf, "on"))
-          isVec = true;
-        else if (boost::iequals(buf, "off"))
-          isVec = false;
-        else
-          pdeErrMsgIdAndTxt("pde1d:invalidVectorized",
-          "The value of the \"Vectorized\" option must be either \"On\" or \"Off\".");
-        pdeOpts.setVectorized(isVec);
-      }
-      else if (boost::iequals(ni, "maxsteps")) {
-        int mxs = (int)mxGetScalar(val);
-        pdeOpts.setMaxSteps(mxs);
-      }
-      else if (boost::iequals(ni, "stats")) {
-        const int buflen = 1024;
-        char buf[buflen];
-        mxGetString(val, buf, buflen);
-        bool doStats;
-        if (boost::iequals(buf, "on"))
-          doStats = true;
-        else if (boost::iequals(buf, "off"))
-          doStats = false;
-        else
-          pdeErrMsgIdAndTxt("pde1d:invalidStats",
-          "The value of the \"Stats\" option must be either \"On\" or \"Off\".");
-        pdeOpts.setPrintStats(doStats);
-      }
-      else if (boost::iequals(ni, "icmethod")) {
-        int icMethod = (int) mxGetScalar(val);
-        pdeOpts.setICMethod(icMethod);
-      }
-      else if (boost::iequals(ni, "icdiagnostics")) {
-        int icDiag = (int) mxGetScalar(val);
-        pdeOpts.setICDiagnostics(icDiag);
-      }
-      else if (boost::iequals(ni, "jacdiagnostics")) {
-        int jacDiag = (int) mxGetScalar(val);
-        pdeOpts.setJacDiagnostics(jacDiag);
-      }
-      else if (boost::iequals(ni, "eqndiagnostics")) {
-        int eqnDiag = (int)mxGetScalar(val);
-        pdeOpts.setEqnDiagnostics(eqnDiag);
-      }
-      else if (boost::iequals(ni, "polyorder")) {
-        int porder = (int)mxGetScalar(val);
-        pdeOpts.setPolyOrder(porder);
-      }
-      else if (boost::iequals(ni, "viewmesh")) {
-        int vumesh = (int)mxGetScalar(val);
-        pdeOpts.setViewMesh(vumesh);
-      }
-      else if (boost::iequals(ni, "diagonalMassMatrix")) {
-        const int buflen = 1024;
-        char buf[buflen];
-        mxGetString(val, buf, buflen);
-        bool useDiagMassMat;
-        if (boost::iequals(buf, "on"))
-          useDiagMassMat = true;
-        else if (boost::iequals(buf, "off"))
-          useDiagMassMat = false;
-        else
-          pdeErrMsgIdAndTxt("pde1d:invalidMassMat",
-            "The value of the \"diagonalMassMatrix\" option must be either \"On\" or \"Off\".");
-        pdeOpts.setDiagMassMat(useDiagMassMat);
-      }
-      else if (boost::iequals(ni, "events")) {
-        if (!mxIsFunctionHandle(val))
-          pdeErrMsgIdAndTxt("pde1d:invalidEventsFunc",
-            "The value of the \"Events\" option must be a function handle.");
-        eventFunc = val;
+  /*
+   * Array of numRows solutions from a solution file in the same form as
+   * returned by pde1d; rowData(i) returns the solution in row i.
+   */
+  template<class F>
+  mxArray *solutionArray(size_t numRows, int numPde, size_t numPts,
+    F rowData)
+  {
+    mwSize dims[] = { (mwSize)numRows, (mwSize)numPts, (mwSize)numPde };
+    mxArray *sol = mxCreateNumericArray(numPde > 1 ? 3 : 2, dims,
+      mxDOUBLE_CLASS, mxREAL);
+    double *p = mxGetPr(sol);
+    for (size_t i = 0; i < numRows; i++) {
+      const double *ui = rowData(i);
+      for (int k = 0; k < numPde; k++)
+        for (size_t j = 0; j < numPts; j++)
+          p[i + numRows*(j + numPts*k)] = ui[k + numPde*j];
+    }
+    return sol;
+  }
+
+  /*
+   * info = pde1d('read',fileName)
+   * [u,uOde] = pde1d('read',fileName,timeIndices)
+   */
+  void readSolutionFile(int nlhs, mxArray *plhs[], int nrhs,
+    const mxArray *prhs[])
+  {
+    if (nrhs < 2 || nrhs > 3 || !mxIsChar(prhs[1]))
+      pdeErrMsgIdAndTxt("pde1d:read_args",
+        "Usage: info = pde1d('read',fileName) or "
+        "[u,uOde] = pde1d('read',fileName,timeIndices)");
+    PDESolutionReader sf(MexInterface::getString(prhs[1]));
+    const int numPde = sf.numPDE(), numOde = sf.numODE();
+    const size_t numPts = sf.numPts();
+    if (nrhs == 2) {
+      if (nlhs > 1)
+        pdeErrMsgIdAndTxt("pde1d:nlhs",
+          "pde1d('read',fileName) returns a single struct.");
+      const char *fields[] = { "x", "t", "numPDE", "numODE", "te", "ue",
+        "ie" };
+      mxArray *info = mxCreateStructMatrix(1, 1, 7, fields);
+      mxArray *x = mxCreateDoubleMatrix(1, numPts, mxREAL);
+      std::copy_n(sf.x(), numPts, mxGetPr(x));
+      mxArray *t = mxCreateDoubleMatrix(sf.numTimes(), 1, mxREAL);
+      for (size_t i = 0; i < sf.numTimes(); i++)
+        mxGetPr(t)[i] = sf.time(i);
+      const size_t numEvents = sf.numEvents();
+      mxArray *te = mxCreateDoubleMatrix(numEvents, 1, mxREAL);
+      mxArray *ie = mxCreateDoubleMatrix(numEvents, 1, mxREAL);
+      for (size_t i = 0; i < numEvents; i++) {
+        mxGetPr(te)[i] = sf.eventTime(i);
+        mxGetPr(ie)[i] = sf.eventIndex(i);
       }
-      else {
+      mxSetField(info, 0, "x", x);
+      mxSetField(info, 0, "t", t);
+      mxSetField(info, 0, "numPDE", mxCreateDoubleScalar(numPde));
+      mxSetField(info, 0, "numODE", mxCreateDoubleScalar(numOde));
+      mxSetField(info, 0, "te", te);
+      mxSetField(info, 0, "ue", solutionArray(numEvents, numPde, numPts,
+        [&sf](size_t i) { return sf.eventU(i); }));
+      mxSetField(info, 0, "ie", ie);
+      plhs[0] = info;
+      return;
+    }
+    if (nlhs > 2)
+      pdeErrMsgIdAndTxt("pde1d:nlhs",
+        "pde1d('read',fileName,timeIndices) returns at most two matrices.");
+    if (!mxIsDouble(prhs[2]) || mxIsComplex(prhs[2]))
+      pdeErrMsgIdAndTxt("pde1d:read_args",
+        "The time indices must be a real vector.");
+    const size_t n = mxGetNumberOfElements(prhs[2]);
+    std::vector<size_t> rows(n);
+    for (size_t i = 0; i < n; i++) {
+      double ti = mxGetPr(prhs[2])[i];
+      if (ti < 1 || ti > sf.numTimes() || ti != (size_t)ti) {
         char msg[1024];
-        sprintf(msg, "The options argument contains the field \"%s\".\n"
-          "This is not a currently-supported option and will be ignored.",
-          ni);
-        mexWarnMsgIdAndTxt("pde1d:unknown_option", msg);
+        sprintf(msg, "Time index %g is not an integer from 1 to %d.", ti,
+          (int)sf.numTimes());
+        pdeErrMsgIdAndTxt("pde1d:read_args", msg);
+      }
+      rows[i] = (size_t)ti - 1;
+    }
+    std::vector<double> row(numPde*numPts);
+    plhs[0] = solutionArray(n, numPde, numPts,
+      [&](size_t i) {
+        sf.u(rows[i], row.data());
+        return row.data();
+      });
+    if (nlhs > 1) {
+      mxArray *uOde = mxCreateDoubleMatrix(n, numOde, mxREAL);
+      for (size_t i = 0; i < n; i++)
+        for (int j = 0; j < numOde; j++)
+          mxGetPr(uOde)[i + n*j] = sf.v(rows[i])[j];
+      plhs[1] = uOde;
+    }
+  }
+
+  const mxArray *getSolutionField(const mxArray *sol, const char *name)
+  {
+    const mxArray *f = mxGetField(sol, 0, name);
+    if (!f || !mxIsDouble(f) || mxIsComplex(f)) {
+      char msg[1024];
+      sprintf(msg, "The solution struct has no real field \"%s\"; it "
+        "must be returned by pde1d with OutputCoefficients or DenseOutput "
+        "\"On\".", name);
+      pdeErrMsgIdAndTxt("pde1d:eval_args", msg);
+    }
+    return f;
+  }
+
+  /*
+   * [u,DuDx,flux] = pde1d('eval',sol,xq,tq)
+   * [u,DuDx,flux] = pde1d('eval',sol,xq,tq,pdeFunc)
+   */
+  void evalSolution(int nlhs, mxArray *plhs[], int nrhs,
+    const mxArray *prhs[])
+  {
+    if (nrhs < 4 || nrhs > 5 || !mxIsStruct(prhs[1]))
+      pdeErrMsgIdAndTxt("pde1d:eval_args",
+        "Usage: [u,DuDx,flux] = pde1d('eval',sol,xq,tq,pdeFunc)");
+    if (nlhs > 3)
+      pdeErrMsgIdAndTxt("pde1d:nlhs",
+        "pde1d('eval',...) returns at most three matrices.");
+    if (nlhs > 2 && (nrhs < 5 || !mxIsFunctionHandle(prhs[4])))
+      pdeErrMsgIdAndTxt("pde1d:eval_args",
+        "The pde function handle is required to calculate the flux.");
+    for (int i = 2; i < 4; i++)
+      if (!mxIsDouble(prhs[i]) || mxIsComplex(prhs[i]))
+        pdeErrMsgIdAndTxt("pde1d:eval_args",
+          "The query points and times must be real vectors.");
+    const mxArray *sol = prhs[1];
+    const mxArray *uSol = getSolutionField(sol, "u");
+    const int numPde = mxGetNumberOfDimensions(uSol) > 2 ?
+      (int)mxGetDimensions(uSol)[2] : 1;
+    const RealVector mesh =
+      MexInterface::fromMxArrayVec(getSolutionField(sol, "mesh"));
+    const int polyOrder =
+      (int)mxGetScalar(getSolutionField(sol, "polyOrder"));
+    // the integrator history, in the struct or a file, when it was
+    // recorded and otherwise the coefficients at the output times
+    const mxArray *hist = mxGetField(sol, 0, "history");
+    std::unique_ptr<PDEDenseOutput> dense;
+    std::unique_ptr<PDESolutionQuery> queryPtr;
+    if (hist && mxIsChar(hist))
+      dense.reset(new PDEDenseOutput(MexInterface::getString(hist)));
+    else if (hist && mxIsStruct(hist))
+      dense.reset(new PDEDenseOutput(
+        MexInterface::fromMxArrayVec(getSolutionField(hist, "t")),
+        MexInterface::fromMxArrayVec(getSolutionField(hist, "h")),
+        MexInterface::fromMxArrayVec(getSolutionField(hist, "order")),
+        MexInterface::fromMxArray(getSolutionField(hist, "coefficients"))));
+    if (dense)
+      queryPtr.reset(new PDESolutionQuery(mesh, polyOrder, numPde, *dense));
+    else {
+      const mxArray *uOde = mxGetField(sol, 0, "uOde");
+      queryPtr.reset(new PDESolutionQuery(mesh, polyOrder, numPde,
+        MexInterface::fromMxArrayVec(getSolutionField(sol, "t")),
+        MexInterface::fromMxArray(getSolutionField(sol, "coefficients")),
+        uOde ? MexInterface::fromMxArray(uOde) : RealMatrix()));
+    }
+    const PDESolutionQuery &query = *queryPtr;
+    const RealVector xq = MexInterface::fromMxArrayVec(prhs[2]);
+    const RealVector tq = MexInterface::fromMxArrayVec(prhs[3]);
+    const size_t nx = xq.size(), nt = tq.size();
+    RealMatrix u, DuDx;
+    query.eval(xq, tq, u, DuDx);
+    plhs[0] = solutionArray(nt, numPde, nx,
+      [&u](size_t i) { return u.col(i).data(); });
+    if (nlhs > 1)
+      plhs[1] = solutionArray(nt, numPde, nx,
+        [&DuDx](size_t i) { return DuDx.col(i).data(); });
+    if (nlhs < 3)
+      return;
+    // the flux is calculated by calling the pde function at each point
+    RealMatrix flux(u.rows(), nt);
+    RealVector v, vDot;
+    const int nargin = query.numODE() ? 7 : 5;
+    mxArray *inArgs[7], *outArgs[3];
+    inArgs[0] = const_cast<mxArray*>(prhs[4]);
+    for (size_t i = 0; i < nt; i++) {
+      query.evalODE(tq[i], v, vDot);
+      for (size_t j = 0; j < nx; j++) {
+        inArgs[1] = mxCreateDoubleScalar(xq[j]);
+        inArgs[2] = mxCreateDoubleScalar(tq[i]);
+        inArgs[3] = MexInterface::toMxArray(
+          RealVector(u.col(i).segment(numPde*j, numPde)));
+        inArgs[4] = MexInterface::toMxArray(
+          RealVector(DuDx.col(i).segment(numPde*j, numPde)));
+        if (nargin == 7) {
+          inArgs[5] = MexInterface::toMxArray(v);
+          inArgs[6] = MexInterface::toMxArray(vDot);
+        }
+        mxArray *ex = mexCallMATLABWithTrap(3, outArgs, nargin, inArgs,
+          "feval");
+        for (int k = 1; k < nargin; k++)
+          mxDestroyArray(inArgs[k]);
+        if (ex) {
+          mxDestroyArray(ex);
+          pdeErrMsgIdAndTxt("pde1d:eval_flux",
+            "An error occurred in the call to the pde function.");
+        }
+        if (!mxIsDouble(outArgs[1]) ||
+          mxGetNumberOfElements(outArgs[1]) != numPde) {
+          for (int k = 0; k < 3; k++)
+            mxDestroyArray(outArgs[k]);
+          pdeErrMsgIdAndTxt("pde1d:eval_flux",
+            "The flux returned by the pde function must have one value "
+            "for each PDE.");
+        }
+        std::copy_n(mxGetPr(outArgs[1]), numPde,
+          flux.col(i).data() + numPde*j);
+        for (int k = 0; k < 3; k++)
+          mxDestroyArray(outArgs[k]);
       }
     }
+    plhs[2] = solutionArray(nt, numPde, nx,
+      [&flux](size_t i) { return flux.col(i).data(); });
+  }
+
+  // the history itself or the name of the file it was written to
+  mxArray *historyStruct(const PDEDenseOutput &dense,
+    const std::string &fileName)
+  {
+    if (!fileName.empty())
+      return mxCreateString(fileName.c_str());
+    const char *fields[] = { "t", "h", "order", "coefficients" };
+    mxArray *hist = mxCreateStructMatrix(1, 1, 4, fields);
+    const size_t ns = dense.numSteps();
+    mxArray *t = mxCreateDoubleMatrix(1, ns, mxREAL),
+      *h = mxCreateDoubleMatrix(1, ns, mxREAL),
+      *order = mxCreateDoubleMatrix(1, ns, mxREAL);
+    for (size_t i = 0; i < ns; i++) {
+      mxGetPr(t)[i] = dense.stepTimes()[i];
+      mxGetPr(h)[i] = dense.stepSizes()[i];
+      mxGetPr(order)[i] = dense.orders()[i];
+    }
+    mxSetField(hist, 0, "t", t);
+    mxSetField(hist, 0, "h", h);
+    mxSetField(hist, 0, "order", order);
+    mxSetField(hist, 0, "coefficients",
+      MexInterface::toMxArray(RealMatrix(dense.coefficients())));
+    return hist;
+  }
+
+  mxArray *profilerStats(const PDE1dProfiler &prof)
+  {
+    // one field for each category with calls, points, and time
+    const char *catFields[] = { "calls", "points", "time" };
+    const int numCat = PDE1dProfiler::NumCategories;
+    const char *names[numCat];
+    for (int i = 0; i < numCat; i++)
+      names[i] = PDE1dProfiler::name((PDE1dProfiler::Category)i);
+    mxArray *stats = mxCreateStructMatrix(1, 1, numCat, names);
+    for (int i = 0; i < numCat; i++) {
+      const PDE1dProfiler::Counter &c =
+        prof.get((PDE1dProfiler::Category)i);
+      mxArray *ci = mxCreateStructMatrix(1, 1, 3, catFields);
+      mxSetFieldByNumber(ci, 0, 0, mxCreateDoubleScalar((double)c.calls));
+      mxSetFieldByNumber(ci, 0, 1, mxCreateDoubleScalar((double)c.points));
+      mxSetFieldByNumber(ci, 0, 2, mxCreateDoubleScalar(c.seconds));
+      mxSetFieldByNumber(stats, 0, i, ci);
+    }
+    return stats;
   }
 }
 
-void PDE1dWarningMsg(const char *id, const char *msg) {
-  mexWarnMsgIdAndTxt(id, msg);
+namespace {
+
+  // matlab mex connects cout to console but not printf
+  void mexPrint(const char *msg)
+  {
+    mexPrintf("%s", msg);
+  }
+
+  void mexWarning(const char *id, const char *msg)
+  {
+    mexWarnMsgIdAndTxt(id, "%s", msg);
+  }
+
 }
 
 /*
@@ -175,74 +359,96 @@ void PDE1dWarningMsg(const char *id, const char *msg) {
    solution = pde1d(m,pdeFunc,icFunc,bcFunc,meshPts,timePts,options)
    solution = pde1d(m,pdeFunc,icFunc,bcFunc,meshPts,timePts,
       odefun,odeIcFunc,odeMesh)
+   h = pde1d('init',m,pdeFunc,icFunc,bcFunc,meshPts,timePts,...)
+   [u,uOde,t] = pde1d('advance',h,tNext)
+   solution = pde1d(m,libPath,meshPts,timePts)
+   solution = pde1d(m,libPath,meshPts,timePts,options)
+   solution = pde1d(m,defnStruct,meshPts,timePts)
+   solution = pde1d(m,defnStruct,meshPts,timePts,options)
 */
 
 void mexFunction(int nlhs, mxArray*
   plhs[], int nrhs, const mxArray *prhs[])
 {
+  setPDE1dPrintSink(mexPrint);
+  setPDE1dWarningSink(mexWarning);
   try {
     //printf("nlhs=%d, nrhs=%d\n", nlhs, nrhs); return;
-    // options struct is always the last argument in the
-    // function call
-    int optsArg = -1;
-    if (nrhs == 7)
-      optsArg = 6;
-    else if (nrhs == 10)
-      optsArg = 9;
-    else if (nrhs != 6 && nrhs != 9)
-      pdeErrMsgIdAndTxt("pde1d:nrhs",
-        "Illegal number of input arguments passed to " FUNC_NAME);
-
-    const bool hasODE = nrhs > 7;
-
-    const mxArray *pM = prhs[0];
-    if (!mxIsNumeric(pM) || mxGetNumberOfElements(pM) != 1) {
-      pdeErrMsgIdAndTxt("pde1d:invalid_m_type",
-        "First argument must be an integer scalar.");
-    }
-
-    int m = (int)mxGetScalar(pM);
-    if (m != 0 && m != 1 && m != 2)
-      pdeErrMsgIdAndTxt("pde1d:invalid_m_val",
-      "First argument must be either 0, 1, or 2");
-
-    for (int i = 1; i < 4; i++) {
-      if (!mxIsFunctionHandle(prhs[i])) {
-        char msg[80];
-        sprintf(msg, "Argument %d is not a function handle.", i + 1);
-        pdeErrMsgIdAndTxt("pde1d:arg_not_func", msg);
-      }
+    // session commands for incremental solution are
+    // identified by a string as the first argument
+    if (nrhs > 0 && mxIsChar(prhs[0])) {
+      const std::string cmd = MexInterface::getString(prhs[0]);
+      if (boost::iequals(cmd, "read"))
+        readSolutionFile(nlhs, plhs, nrhs, prhs);
+      else if (boost::iequals(cmd, "eval"))
+        evalSolution(nlhs, plhs, nrhs, prhs);
+      else
+        pde1dSessionCommand(nlhs, plhs, nrhs, prhs);
+      return;
     }
 
-    const mxArray *pX = prhs[4];
-    const mxArray *pT = prhs[5];
-    if (!mxIsNumeric(pX) || mxIsComplex(pX))
-      pdeErrMsgIdAndTxt("pde1d:mesh_type",
-      "Argument \"meshPts\" must be a real vector.");
-    if (mxGetNumberOfElements(pX) < 2)
-      pdeErrMsgIdAndTxt("pde1d:mesh_length",
-      "Length of argument \"meshPts\", must be at least two.");
-
-    if (!mxIsNumeric(pT) || mxIsComplex(pT))
-      pdeErrMsgIdAndTxt("pde1d:time_type",
-      "Argument \"timePts\" must be a real vector.");
-    if (mxGetNumberOfElements(pT) < 3)
-      pdeErrMsgIdAndTxt("pde1d:time_length",
-      "Length of argument \"timePts\", must be at least three.");
-
     PDE1dOptions opts;
     mxArray *eventsFunc = 0;
-    if (optsArg > 0)
-      getOptions(prhs[optsArg], opts, eventsFunc);
+    std::unique_ptr<PDE1dDefn> pdeDefn;
+    if (nrhs > 1 && mxIsChar(prhs[1])) {
+      // problem definition compiled into a shared library
+      int optsArg = checkPluginArgs(nrhs, prhs);
+      if (optsArg > 0)
+        getOptions(prhs[optsArg], opts, eventsFunc);
+      if (eventsFunc)
+        pdeErrMsgIdAndTxt("pde1d:plugin_events",
+          "The \"Events\" option can not be used with a compiled problem "
+          "definition;\nevents must be defined in the library.");
+      // the library functions are always evaluated at all points at once
+      opts.setVectorized(true);
+      int m = (int)mxGetScalar(prhs[0]);
+      std::string libPath = MexInterface::getString(prhs[1]);
+      pdeDefn = std::unique_ptr<PDE1dDefn>(new PDE1dPluginDefn(
+        libPath.c_str(), m, MexInterface::fromMxArrayVec(prhs[2]),
+        MexInterface::fromMxArrayVec(prhs[3])));
+      pdeDefn->applyEventsMeshPoints(opts);
+    }
+    else if (nrhs > 1 && mxIsStruct(prhs[1])) {
+      // coefficients defined by expressions
+      int optsArg = checkPluginArgs(nrhs, prhs);
+      if (optsArg > 0)
+        getOptions(prhs[optsArg], opts, eventsFunc);
+      if (eventsFunc)
+        pdeErrMsgIdAndTxt("pde1d:expression_events",
+          "The \"Events\" option can not be used with a problem "
+          "defined by expressions.");
+      opts.setVectorized(true);
+      int m = (int)mxGetScalar(prhs[0]);
+      PDE1dExprDefn::Expressions exprs;
+      PDEExpression::ParamMap params;
+      PDETable::TableMap tables;
+      getExpressionDefn(prhs[1], exprs, params, tables);
+      pdeDefn = std::unique_ptr<PDE1dDefn>(new PDE1dExprDefn(m,
+        MexInterface::fromMxArrayVec(prhs[2]),
+        MexInterface::fromMxArrayVec(prhs[3]), exprs, params, tables));
+      pdeDefn->applyEventsMeshPoints(opts);
+    }
+    else {
+      int optsArg = checkPDEArgs(nrhs, prhs);
+      int m = (int)mxGetScalar(prhs[0]);
+      if (optsArg > 0)
+        getOptions(prhs[optsArg], opts, eventsFunc);
+      PDE1dMexInt *mexDefn = new PDE1dMexInt(m, prhs[1], prhs[2], prhs[3],
+        prhs[4], prhs[5]);
+      pdeDefn = std::unique_ptr<PDE1dDefn>(mexDefn);
+      mexDefn->applyEventsMeshPoints(opts);
+      mexDefn->setEventsFunction(eventsFunc);
+      if (nrhs > 7)
+        mexDefn->setODEDefn(prhs[6], prhs[7], prhs[8]);
+    }
+    PDE1dDefn &pde = *pdeDefn;
+    const bool hasODE = pde.getNumODE() > 0;
+    const bool hasEvents = pde.getNumEvents() > 0;
 
     std::fill_n(plhs, nlhs, nullptr);
 
-    PDE1dMexInt pde(m, prhs[1], prhs[2], prhs[3],
-      prhs[4], prhs[5]);
-    pde.setEventsFunction(eventsFunc);
     if (hasODE) {
-      pde.setODEDefn(prhs[6], prhs[7], prhs[8]);
-      if (eventsFunc) {
+      if (hasEvents) {
         if (nlhs > 6)
           pdeErrMsgIdAndTxt("pde1d:nlhs",
             "pde1d returns six or fewer matrices when "
@@ -256,7 +462,7 @@ void mexFunction(int nlhs, mxArray*
     }
     else {
       // no ODE
-      if (eventsFunc) {
+      if (hasEvents) {
         if (nlhs > 5)
           pdeErrMsgIdAndTxt("pde1d:nlhs",
             "pde1d returns five or fewer matrices when "
@@ -270,55 +476,115 @@ void mexFunction(int nlhs, mxArray*
     }
     int numPde = pde.getNumPDE();
     int numOde = pde.getNumODE();
-    PDE1dImpl pdeImpl(pde, opts);
+    PDE1dDriver driver(pde, opts);
+    PDESolution &pdeSol = driver.getSolution();
+    const PDEDenseOutput *dense = driver.getDenseOutput();
     int viewMesh = opts.getViewMesh();
-    PDESolution pdeSol(pde, pdeImpl.getModel(), viewMesh);
-    int err = pdeImpl.solveTransient(pdeSol);
-    if (err)
+    // the solution is written directly into the returned array when
+    // it is sized for all of the requested times
+    const mwSize numPts = pdeSol.numSpatialPoints();
+    mwSize dims[] = { (mwSize)pde.getTimeSpan().size(), numPts,
+      (mwSize)numPde };
+    const mwSize ndims = numPde > 1 ? 3 : 2;
+    mxArray *sol = 0;
+    if (driver.canUseOutputBuffer()) {
+      sol = mxCreateNumericArray(ndims, dims, mxDOUBLE_CLASS, mxREAL);
+      pdeSol.setOutputBuffer(mxGetPr(sol));
+    }
+    const int derived = opts.getDerivedOutputs();
+    if (driver.solve())
       return;
+    const bool outProfile = opts.getProfile();
+    if (driver.hasOutputFile()) {
+      // the solution is read from the file with pde1d('read',...)
+      for (int i = 0; i < nlhs; i++)
+        plhs[i] = mxCreateDoubleMatrix(0, 0, mxREAL);
+      if (outProfile) {
+        const char *profField = "profile";
+        mxDestroyArray(plhs[0]);
+        plhs[0] = mxCreateStructMatrix(1, 1, 1, &profField);
+        mxSetField(plhs[0], 0, "profile",
+          profilerStats(driver.getImpl().getProfiler()));
+      }
+      return;
+    }
 
-    int numTimes = pdeSol.numTimePoints();
-    int numPts = pdeSol.numSpatialPoints();
-#if 0
-    mexPrintf("numTimes=%d, numPde=%d, numPts=%d\n",
-    numTimes, numPde, numPts);
-    pdeSol.print();
-#endif
-    mxArray *sol;
-    if (numPde > 1) {
-      mwSize ndims, dims[] = { (mwSize) numTimes, (mwSize) numPts, (mwSize) numPde };
-      ndims = 3;
-      typedef boost::const_multi_array_ref<double, 3> Matrix3;
-      boost::array<Matrix3::index, 3> shape =
-      { { numTimes, numPde, numPts } };
-      Matrix3 sol3(pdeSol.getSolution().data(), shape, boost::fortran_storage_order());
+    // close has packed the values for the times actually calculated
+    if (!sol) {
+      dims[0] = pdeSol.numTimePoints();
       sol = mxCreateNumericArray(ndims, dims, mxDOUBLE_CLASS, mxREAL);
-      double *p = mxGetPr(sol);
-      for (int k = 0; k < numPde; k++) {
-        for (int j = 0; j < numPts; j++) {
-          for (int i = 0; i < numTimes; i++) {
-            *p++ = sol3[i][k][j];
-          }
-        }
-      }
+      pdeSol.decodeSolution(mxGetPr(sol));
     }
-    else {
-      sol = mxCreateDoubleMatrix(numTimes, numPts, mxREAL);
-      std::copy_n(pdeSol.getSolution().data(), numTimes*numPts*numPde, mxGetPr(sol));
+    else if (dims[0] != (mwSize)pdeSol.numTimePoints()) {
+      dims[0] = pdeSol.numTimePoints();
+      mxSetDimensions(sol, dims, ndims);
     }
 
     int lhsIndex = 1;
-    if (viewMesh > 1) {
-      // return struct for results on a view mesh
-      const char *fieldNames[] = { "x", "u", "uOde" };
-      int numFields = 2;
-      if (numOde)
-        numFields++;
-      mxArray *solStruc = mxCreateStructMatrix(1, 1, numFields, &fieldNames[0]);
+    const bool outCoeffs = opts.getOutputCoefficients();
+    const bool outTimes = outCoeffs || opts.getOutputChangeTol() > 0;
+    const bool outMesh = outCoeffs || dense;
+    if ((viewMesh > 1 && opts.getOutputX().empty()) || outTimes ||
+      outMesh || derived || outProfile) {
+      // return struct for results on a view mesh, with the coefficients,
+      // at times chosen by the solution changes, with derived outputs,
+      // or with the profiling stats
+      const char *fieldNames[] = { "x", "u", "uOde", "t", "mesh",
+        "polyOrder", "coefficients", "dudx", "flux", "integrals",
+        "history", "profile" };
+      mxArray *solStruc = mxCreateStructMatrix(1, 1, 2, &fieldNames[0]);
       mxSetField(solStruc, 0, "x", MexInterface::toMxArray(pdeSol.getX().transpose()));
       mxSetField(solStruc, 0, "u", sol);
-      if (numOde)
+      if (numOde) {
+        mxAddField(solStruc, "uOde");
         mxSetField(solStruc, 0, "uOde", MexInterface::toMxArray(pdeSol.uOde));
+      }
+      if (outTimes) {
+        mxAddField(solStruc, "t");
+        mxSetField(solStruc, 0, "t",
+          MexInterface::toMxArray(pdeSol.getOutputTimes()));
+      }
+      if (outMesh) {
+        mxAddField(solStruc, "mesh");
+        mxAddField(solStruc, "polyOrder");
+        mxSetField(solStruc, 0, "mesh",
+          MexInterface::toMxArray(pde.getMesh().transpose()));
+        mxSetField(solStruc, 0, "polyOrder",
+          mxCreateDoubleScalar(opts.getPolyOrder()));
+      }
+      if (dense) {
+        mxAddField(solStruc, "history");
+        mxSetField(solStruc, 0, "history", historyStruct(*dense,
+          opts.getDenseOutputFile()));
+      }
+      if (outCoeffs) {
+        mxAddField(solStruc, "coefficients");
+        mxSetField(solStruc, 0, "coefficients",
+          MexInterface::toMxArray(pdeSol.getCoefficients()));
+      }
+      const size_t numTimes = pdeSol.numTimePoints();
+      if (derived & PDE1dOptions::DerivedDuDx) {
+        const RealMatrix &duDx = pdeSol.getDuDx();
+        mxAddField(solStruc, "dudx");
+        mxSetField(solStruc, 0, "dudx", solutionArray(numTimes, numPde,
+          numPts, [&duDx](size_t i) { return duDx.col(i).data(); }));
+      }
+      if (derived & PDE1dOptions::DerivedFlux) {
+        const RealMatrix &flux = pdeSol.getFlux();
+        mxAddField(solStruc, "flux");
+        mxSetField(solStruc, 0, "flux", solutionArray(numTimes, numPde,
+          numPts, [&flux](size_t i) { return flux.col(i).data(); }));
+      }
+      if (derived & PDE1dOptions::DerivedIntegrals) {
+        mxAddField(solStruc, "integrals");
+        mxSetField(solStruc, 0, "integrals",
+          MexInterface::toMxArray(pdeSol.getIntegrals().transpose()));
+      }
+      if (outProfile) {
+        mxAddField(solStruc, "profile");
+        mxSetField(solStruc, 0, "profile",
+          profilerStats(driver.getImpl().getProfiler()));
+      }
       plhs[0] = solStruc;
     }
     else {
@@ -329,7 +595,7 @@ void mexFunction(int nlhs, mxArray*
     }
 
     // if we have events, more outputs are possible
-    if (eventsFunc) {
+    if (hasEvents) {
       if (lhsIndex < nlhs) {
         // tsol
         plhs[lhsIndex++] = MexInterface::toMxArray(pdeSol.getOutputTimes());
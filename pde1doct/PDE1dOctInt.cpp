@@ -0,0 +1,390 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <cstdarg>
+#include <algorithm>
+
+#include <octave/oct.h>
+#include <octave/parse.h>
+#include <octave/interpreter.h>
+#include <octave/quit.h>
+#include <octave/version.h>
+
+#include "PDE1dOctInt.h"
+#include "PDE1dException.h"
+#include "PDE1dProfiler.h"
+
+namespace {
+
+  RealVector toVector(const octave_value &a)
+  {
+    const NDArray v = a.array_value();
+    return Eigen::Map<const RealVector>(v.data(), v.numel());
+  }
+
+}
+
+PDE1dOctInt::PDE1dOctInt(int m, const octave_value &pdefun,
+  const octave_value &icfun, const octave_value &bcfun,
+  const octave_value &xmesh, const octave_value &tspan) :
+  mCoord(m), pdefun(pdefun), icfun(icfun), bcfun(bcfun), xmesh(xmesh)
+{
+  mesh = toVector(xmesh);
+  tSpan = toVector(tspan);
+  numODE = numEvents = 0;
+  eventsX = xmesh;
+  setNumPde();
+}
+
+void PDE1dOctInt::setODEDefn(const octave_value &odeFun,
+  const octave_value &icFun, const octave_value &odemesh)
+{
+  odefun = odeFun;
+  odeIcFun = icFun;
+  odeMeshVal = odemesh;
+  odeMesh = toVector(odemesh);
+  setNumOde();
+}
+
+void PDE1dOctInt::setEventsFunction(const octave_value &eventsFun)
+{
+  if (eventsFun.is_undefined()) return;
+  this->eventsFun = eventsFun;
+  setNumEvents();
+}
+
+void PDE1dOctInt::setEventsMeshPoints(const std::vector<int> &pts)
+{
+  PDE1dDefn::setEventsMeshPoints(pts);
+  if (pts.empty()) {
+    eventsX = xmesh;
+    return;
+  }
+  Matrix x(1, pts.size());
+  for (size_t i = 0; i < pts.size(); i++)
+    x(0, i) = mesh(pts[i]);
+  eventsX = x;
+}
+
+void PDE1dOctInt::evalIC(double x, RealVector &ic)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::ICFunc);
+  octave_value_list args(1);
+  args(0) = x;
+  RealVector *outArgs[] = { &ic };
+  callOctave(icfun, args, outArgs, 1);
+}
+
+void PDE1dOctInt::evalODEIC(RealVector &ic)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::ODEICFunc);
+  RealVector *outArgs[] = { &ic };
+  callOctave(odeIcFun, octave_value_list(), outArgs, 1);
+}
+
+void PDE1dOctInt::evalBC(double xl, const RealVector &ul,
+  double xr, const RealVector &ur, double t,
+  const RealVector &v, const RealVector &vDot, BC &bc)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::BCFunc, 2);
+  octave_value_list args(numODE ? 7 : 5);
+  args(0) = xl;
+  args(1) = setArray(ul, u1);
+  args(2) = xr;
+  args(3) = setArray(ur, u2);
+  args(4) = t;
+  if (numODE) {
+    args(5) = setArray(v, v1);
+    args(6) = setArray(vDot, vDot1);
+  }
+  RealVector *outArgs[] = { &bc.pl, &bc.ql, &bc.pr, &bc.qr };
+  callOctave(bcfun, args, outArgs, 4);
+}
+
+void PDE1dOctInt::evalPDE(double x, double t,
+  const RealVector &u, const RealVector &DuDx,
+  const RealVector &v, const RealVector &vDot, PDECoeff &pde)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::PDEFunc);
+  // [c,f,s] = pdefun(x,t,u,DuDx)
+  octave_value_list args(numODE ? 6 : 4);
+  args(0) = x;
+  args(1) = t;
+  args(2) = setArray(u, u1);
+  args(3) = setArray(DuDx, du1);
+  if (numODE) {
+    args(4) = setArray(v, v1);
+    args(5) = setArray(vDot, vDot1);
+  }
+  octave_value_list ret = callOctave(pdefun, args, 3);
+  const octave_value &c = ret(0);
+  if (c.rows() == numPDE && c.columns() == numPDE)
+    pde.c.resize(numPDE, numPDE); // handle optional coupled mass matrix
+  processReturnedArg(pdefun, 0, c, &pde.c);
+  processReturnedArg(pdefun, 1, ret(1), &pde.f);
+  processReturnedArg(pdefun, 2, ret(2), &pde.s);
+}
+
+void PDE1dOctInt::evalPDE(const RealVector &x, double t,
+  const RealMatrix &u, const RealMatrix &DuDx,
+  const RealVector &v, const RealVector &vDot, PDECoeff &pde)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::PDEFunc, x.size());
+  // coefficients at all x-locations
+  octave_value_list args(numODE ? 6 : 4);
+  args(0) = setArray(x.transpose(), x1);
+  args(1) = t;
+  args(2) = setArray(u, u1);
+  args(3) = setArray(DuDx, du1);
+  if (numODE) {
+    args(4) = setArray(v, v1);
+    args(5) = setArray(vDot, vDot1);
+  }
+  RealMatrix *outArgs[] = { &pde.c, &pde.f, &pde.s };
+  callOctave(pdefun, args, outArgs, 3);
+}
+
+bool PDE1dOctInt::getPDEArgBuffers(size_t numPts, double *&x, double *&u,
+  double *&DuDx)
+{
+  if (x1.rows() != 1 || x1.cols() != numPts)
+    x1.resize(dim_vector(1, numPts));
+  if (u1.rows() != numPDE || u1.cols() != numPts)
+    u1.resize(dim_vector(numPDE, numPts));
+  if (du1.rows() != numPDE || du1.cols() != numPts)
+    du1.resize(dim_vector(numPDE, numPts));
+  x = x1.fortran_vec();
+  u = u1.fortran_vec();
+  DuDx = du1.fortran_vec();
+  return true;
+}
+
+void PDE1dOctInt::evalPDEBuffers(double t, const RealVector &v,
+  const RealVector &vDot, PDECoeffView &pde)
+{
+  const size_t numPts = x1.cols();
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::PDEFunc, numPts);
+  octave_value_list args(numODE ? 6 : 4);
+  args(0) = x1;
+  args(1) = t;
+  args(2) = u1;
+  args(3) = du1;
+  if (numODE) {
+    args(4) = setArray(v, v1);
+    args(5) = setArray(vDot, vDot1);
+  }
+  // release the previous results so that their data is not shared
+  pdeC = pdeF = pdeS = NDArray();
+  octave_value_list ret = callOctave(pdefun, args, 3);
+  pdeC = checkReturnedArg(pdefun, 0, ret(0), numPDE, numPts);
+  pdeF = checkReturnedArg(pdefun, 1, ret(1), numPDE, numPts);
+  pdeS = checkReturnedArg(pdefun, 2, ret(2), numPDE, numPts);
+  pde.c = pdeC.data();
+  pde.f = pdeF.data();
+  pde.s = pdeS.data();
+}
+
+void PDE1dOctInt::evalODE(double t, const RealVector &v,
+  const RealVector &vdot, const RealMatrix &u, const RealMatrix &DuDx,
+  const RealMatrix &R, const RealMatrix &duDt,
+  const RealMatrix &du2DxDt, RealVector &f)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::ODEFunc, u.cols());
+  // odeFunc(t,v,vdot,x,u,DuDx,flux,dudt,du2dxdt)
+  octave_value_list args(9);
+  args(0) = t;
+  args(1) = setArray(v, v1);
+  args(2) = setArray(vdot, vDot1);
+  args(3) = odeMeshVal;
+  args(4) = setArray(u, odeU);
+  args(5) = setArray(DuDx, odeDuDx);
+  args(6) = setArray(R, odeR);
+  args(7) = setArray(duDt, odeDuDt);
+  args(8) = setArray(du2DxDt, odeDuDxDt);
+  RealVector *outArgs[] = { &f };
+  callOctave(odefun, args, outArgs, 1);
+}
+
+void PDE1dOctInt::evalEvents(double t, const RealMatrix &u,
+  RealVector &eventsVal, RealVector &eventsIsTerminal,
+  RealVector &eventsDirection)
+{
+  PDE1dProfiler::Scope prof(profiler, PDE1dProfiler::EventsFunc,
+    u.size() / numPDE);
+  // [value,isterminal,direction] = events(m,t,xmesh,umesh)
+  eventsIsTerminal.setZero();
+  eventsDirection.setZero();
+  octave_value_list args(4);
+  args(0) = mCoord;
+  args(1) = t;
+  args(2) = eventsX;
+  args(3) = setArray(u, eventsU);
+  RealVector *outArgs[] = { &eventsVal, &eventsIsTerminal, &eventsDirection };
+  callOctave(eventsFun, args, outArgs, 3);
+}
+
+octave_value_list PDE1dOctInt::callOctave(const octave_value &fcn,
+  const octave_value_list &args, int nargout)
+{
+  octave_value_list ret;
+  try {
+    ret = octave::feval(fcn, args, nargout);
+  }
+  catch (const octave::execution_exception &ee) {
+    recoverFromOctaveError();
+    char msg[1024];
+    std::string funcName = getFuncName(fcn);
+#if OCTAVE_MAJOR_VERSION >= 6
+    sprintf(msg, "An error occurred in the call to user-defined function:\n"
+      "\"%s\".\n%s", funcName.c_str(), ee.message().c_str());
+#else
+    sprintf(msg, "An error occurred in the call to user-defined function:\n"
+      "\"%s\".", funcName.c_str());
+#endif
+    pdeErrMsgIdAndTxt("pde1d:feval:err", msg);
+  }
+  if (ret.length() < nargout) {
+    char msg[1024];
+    std::string funcName = getFuncName(fcn);
+    sprintf(msg, "User-defined function \"%s\" returned %d values but %d "
+      "were expected.", funcName.c_str(), (int)ret.length(), nargout);
+    pdeErrMsgIdAndTxt("pde1d:feval:nargout", msg);
+  }
+  return ret;
+}
+
+template<typename T>
+void PDE1dOctInt::callOctave(const octave_value &fcn,
+  const octave_value_list &args, T *outArgs[], int nargout)
+{
+  octave_value_list ret = callOctave(fcn, args, nargout);
+  for (int i = 0; i < nargout; i++)
+    processReturnedArg(fcn, i, ret(i), outArgs[i]);
+}
+
+NDArray PDE1dOctInt::checkReturnedArg(const octave_value &fcn,
+  int argNum, const octave_value &retArg, size_t exRows, size_t exCols)
+{
+  char msg[1024];
+  if (!retArg.is_double_type()) {
+    std::string funcName = getFuncName(fcn);
+    sprintf(msg, "In the call to user-defined function, \"%s\",\n"
+      "returned entry %d was not a double-precision, floating-point array.",
+      funcName.c_str(), argNum + 1);
+    pdeErrMsgIdAndTxt("pde1d:feval:argNotNumeric", msg);
+  }
+  if (retArg.iscomplex()) {
+    std::string funcName = getFuncName(fcn);
+    sprintf(msg, "In the call to user-defined function, \"%s\",\n"
+      "returned entry %d was complex.\n"
+      "Complex equations are not currently supported by pde1d.",
+      funcName.c_str(), argNum + 1);
+    pdeErrMsgIdAndTxt("pde1d:feval:argIsComplex", msg);
+  }
+  // shares the data of the returned value
+  const NDArray a = retArg.array_value();
+  size_t retRows = a.rows(), retCols = a.cols();
+  bool dimsOK = a.ndims() == 2;
+  if (exCols == 1)
+    dimsOK = dimsOK && (retRows == 1 || retCols == 1) &&
+      retRows * retCols == exRows * exCols;
+  else
+    dimsOK = dimsOK && retRows == exRows && retCols == exCols;
+  if (!dimsOK) {
+    std::string funcName = getFuncName(fcn);
+    sprintf(msg, "In the call to user-defined function:\n\"%s\"\n"
+      "returned entry %d had size (%zd x %zd) but a matrix of size (%zd x %zd)"
+      " was expected.", funcName.c_str(), argNum + 1, retRows, retCols,
+      exRows, exCols);
+    pdeErrMsgIdAndTxt("pde1d:feval:arglen", msg);
+  }
+  return a;
+}
+
+template<typename T>
+void PDE1dOctInt::processReturnedArg(const octave_value &fcn,
+  int argNum, const octave_value &retArg, T *outArg)
+{
+  const NDArray a = checkReturnedArg(fcn, argNum, retArg, outArg->rows(),
+    outArg->cols());
+  std::copy_n(a.data(), outArg->size(), outArg->data());
+}
+
+std::string PDE1dOctInt::getFuncName(const octave_value &fcn)
+{
+  octave_value_list ret = octave::feval("func2str", octave_value_list(fcn), 1);
+  if (ret.length() && ret(0).is_string())
+    return ret(0).string_value();
+  return "unknown";
+}
+
+void PDE1dOctInt::setNumPde()
+{
+  octave_value_list args(1);
+  args(0) = mesh(0);
+  octave_value_list ret = callOctave(icfun, args, 1);
+  numPDE = (int)ret(0).numel();
+  if (numPDE <= 0) {
+    char msg[1024];
+    std::string funcName = getFuncName(icfun);
+    sprintf(msg, "An error occurred in the call to user-defined function, \"%s\"."
+      "Returned matrix had zero-length.", funcName.c_str());
+    pdeErrMsgIdAndTxt("pde1d:icFuncIllegal", msg);
+  }
+}
+
+void PDE1dOctInt::setNumOde()
+{
+  octave_value_list ret = callOctave(odeIcFun, octave_value_list(), 1);
+  numODE = (int)ret(0).numel();
+}
+
+void PDE1dOctInt::setNumEvents()
+{
+  const std::vector<int> &pts = getEventsMeshPoints();
+  const size_t numPts = pts.empty() ? mesh.size() : pts.size();
+  RealMatrix u(numPDE, numPts);
+  RealVector ui(numPDE);
+  for (size_t i = 0; i < numPts; i++) {
+    evalIC(mesh(pts.empty() ? i : pts[i]), ui);
+    u.col(i) = ui;
+  }
+  octave_value_list args(4);
+  args(0) = mCoord;
+  args(1) = tSpan(0);
+  args(2) = eventsX;
+  args(3) = setArray(u, eventsU);
+  octave_value_list ret = callOctave(eventsFun, args, 1);
+  numEvents = (int)ret(0).numel();
+  for (int i = 1; i < ret.length() && i < 3; i++) {
+    if (ret(i).is_defined() && ret(i).numel() != numEvents) {
+      char msg[1024];
+      std::string funcName = getFuncName(eventsFun);
+      sprintf(msg, "The lengths of all vectors returned from events function \"%s\""
+        " must be the same.", funcName.c_str());
+      pdeErrMsgIdAndTxt("pde1d:eventsFuncIllegal", msg);
+    }
+  }
+}
+
+void recoverFromOctaveError()
+{
+#if OCTAVE_MAJOR_VERSION >= 6
+  octave::interpreter::the_interpreter()->recover_from_exception();
+#else
+  recover_from_exception();
+#endif
+}
@@ -0,0 +1,115 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PDE1dOctInt_h
+#define PDE1dOctInt_h
+
+#include <string>
+
+#include <octave/oct.h>
+
+#include <PDE1dDefn.h>
+
+/*
+ * PDE definition with user-defined functions called through the native
+ * Octave interface. The inputs are copied into preallocated arrays and
+ * passed to the functions without conversion to mxArray; the returned
+ * values are copied directly from the Octave arrays.
+ */
+class PDE1dOctInt : public PDE1dDefn
+{
+public:
+  PDE1dOctInt(int m, const octave_value &pdefun, const octave_value &icfun,
+    const octave_value &bcfun, const octave_value &xmesh,
+    const octave_value &tspan);
+  virtual int getCoordSystem() const {
+    return mCoord;
+  }
+  virtual void evalIC(double x, RealVector &ic);
+  virtual void evalODEIC(RealVector &ic);
+  virtual void evalBC(double xl, const RealVector &ul,
+    double xr, const RealVector &ur, double t,
+    const RealVector &v, const RealVector &vDot, BC &bc);
+  virtual void evalPDE(double x, double t,
+    const RealVector &u, const RealVector &DuDx,
+    const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual bool hasVectorPDEEval() const { return true; }
+  virtual void evalPDE(const RealVector &x, double t,
+    const RealMatrix &u, const RealMatrix &DuDx,
+    const RealVector &v, const RealVector &vDot, PDECoeff &pde);
+  virtual bool getPDEArgBuffers(size_t numPts, double *&x, double *&u,
+    double *&DuDx);
+  virtual void evalPDEBuffers(double t, const RealVector &v,
+    const RealVector &vDot, PDECoeffView &pde);
+  virtual const RealVector &getMesh() const { return mesh; }
+  virtual const RealVector &getODEMesh() { return odeMesh; }
+  virtual const RealVector &getTimeSpan() const { return tSpan; }
+  void setODEDefn(const octave_value &odeFun, const octave_value &icFun,
+    const octave_value &odeMesh);
+  virtual int getNumODE() const { return numODE; }
+  virtual int getNumPDE() const { return numPDE; }
+  virtual void evalODE(double t, const RealVector &v,
+    const RealVector &vdot,
+    const RealMatrix &u, const RealMatrix &DuDx, const RealMatrix &R,
+    const RealMatrix &odeDuDt, const RealMatrix &odeDuDxDt,
+    RealVector &f);
+  void setEventsFunction(const octave_value &eventsFun);
+  virtual void setEventsMeshPoints(const std::vector<int> &pts);
+  virtual int getNumEvents() const { return numEvents; }
+  virtual void evalEvents(double t, const RealMatrix &u,
+    RealVector &eventsVal, RealVector &eventsIsTerminal,
+    RealVector &eventsDirection);
+private:
+  // copy to a preallocated array; the array data is only reallocated
+  // when the size changes or the user function kept a reference to it
+  template<class T>
+  static const NDArray &setArray(const T &ea, NDArray &a) {
+    if (a.rows() != ea.rows() || a.cols() != ea.cols())
+      a.resize(dim_vector(ea.rows(), ea.cols()));
+    std::copy_n(ea.data(), ea.size(), a.fortran_vec());
+    return a;
+  }
+  octave_value_list callOctave(const octave_value &fcn,
+    const octave_value_list &args, int nargout);
+  template<typename T>
+  void callOctave(const octave_value &fcn, const octave_value_list &args,
+    T *outArgs[], int nargout);
+  NDArray checkReturnedArg(const octave_value &fcn, int argNum,
+    const octave_value &retArg, size_t exRows, size_t exCols);
+  template<typename T>
+  void processReturnedArg(const octave_value &fcn, int argNum,
+    const octave_value &retArg, T *outArg);
+  static std::string getFuncName(const octave_value &fcn);
+  void setNumPde();
+  void setNumOde();
+  void setNumEvents();
+  int mCoord, numPDE, numODE, numEvents;
+  RealVector mesh, tSpan, odeMesh;
+  octave_value pdefun, icfun, bcfun, odefun, odeIcFun, eventsFun;
+  octave_value xmesh, odeMeshVal;
+  octave_value eventsX; // x at the events mesh points
+  NDArray x1, u1, u2, du1, v1, vDot1, eventsU;
+  NDArray odeU, odeDuDx, odeR, odeDuDt, odeDuDxDt;
+  // c, f, s returned from the vectorized pde function
+  NDArray pdeC, pdeF, pdeS;
+};
+
+/*
+ * Clears the interpreter error state after catching an
+ * octave::execution_exception that is not rethrown.
+ */
+void recoverFromOctaveError();
+
+#endif
@@ -0,0 +1,593 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <iostream>
+#include <memory>
+
+#include <boost/algorithm/string.hpp>
+
+#include <octave/oct.h>
+#include <octave/ov-struct.h>
+#include <octave/version.h>
+
+#include "PDE1dOctInt.h"
+#include "PDE1dMexArgs.h"
+#include "PDE1dPluginDefn.h"
+#include "PDE1dExprDefn.h"
+#include "PDE1dDriver.h"
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDESolutionFile.h"
+#include "PDESolutionQuery.h"
+#include "PDEDenseOutput.h"
+#include "PDE1dException.h"
+#include "PDE1dMessages.h"
+#include "PDE1dProfiler.h"
+
+namespace {
+
+  class scoped_redirect_cout
+  {
+  public:
+    scoped_redirect_cout() {
+      old_buf = std::cout.rdbuf(octave_stdout.rdbuf());
+    }
+    ~scoped_redirect_cout() { std::cout.rdbuf(old_buf); }
+  private:
+    std::streambuf* old_buf;
+  };
+
+  template<class T>
+  Matrix toMatrix(const T &a)
+  {
+    Matrix m(a.rows(), a.cols());
+    std::copy_n(a.data(), a.size(), m.fortran_vec());
+    return m;
+  }
+
+  // The options and expression structs are only read once so they are
+  // converted to mxArray and parsed by the same functions as the mex file.
+  mxArray *toMxArray(const octave_value &a)
+  {
+#if OCTAVE_MAJOR_VERSION >= 7
+    return a.as_mxArray(false);
+#else
+    return a.as_mxArray();
+#endif
+  }
+
+  void getOctOptions(const octave_value &optsVal, PDE1dOptions &opts,
+    octave_value &eventsFunc)
+  {
+    if (!optsVal.isstruct())
+      pdeErrMsgIdAndTxt("pde1d:optionsNotStruct",
+        "The options argument must be a struct.");
+    mxArray *mxOpts = toMxArray(optsVal);
+    mxArray *mxEvents = 0;
+    try {
+      getOptions(mxOpts, opts, mxEvents);
+    }
+    catch (...) {
+      mxDestroyArray(mxOpts);
+      throw;
+    }
+    mxDestroyArray(mxOpts);
+    if (!mxEvents) return;
+    const octave_scalar_map m = optsVal.scalar_map_value();
+    for (auto it = m.begin(); it != m.end(); ++it) {
+      if (boost::iequals(m.key(it), "events"))
+        eventsFunc = m.contents(it);
+    }
+  }
+
+  void checkCoordSys(const octave_value &m)
+  {
+    if (!m.isnumeric() || m.numel() != 1)
+      pdeErrMsgIdAndTxt("pde1d:invalid_m_type",
+        "First argument must be an integer scalar.");
+    int mi = m.int_value();
+    if (mi != 0 && mi != 1 && mi != 2)
+      pdeErrMsgIdAndTxt("pde1d:invalid_m_val",
+        "First argument must be either 0, 1, or 2");
+  }
+
+  void checkMeshAndTimes(const octave_value &x, const octave_value &t)
+  {
+    if (!x.isnumeric() || x.iscomplex())
+      pdeErrMsgIdAndTxt("pde1d:mesh_type",
+        "Argument \"meshPts\" must be a real vector.");
+    if (x.numel() < 2)
+      pdeErrMsgIdAndTxt("pde1d:mesh_length",
+        "Length of argument \"meshPts\", must be at least two.");
+    if (!t.isnumeric() || t.iscomplex())
+      pdeErrMsgIdAndTxt("pde1d:time_type",
+        "Argument \"timePts\" must be a real vector.");
+    if (t.numel() < 3)
+      pdeErrMsgIdAndTxt("pde1d:time_length",
+        "Length of argument \"timePts\", must be at least 3.");
+  }
+
+  RealVector toVector(const octave_value &a)
+  {
+    const NDArray v = a.array_value();
+    return Eigen::Map<const RealVector>(v.data(), v.numel());
+  }
+
+  octave_scalar_map profilerStats(const PDE1dProfiler &prof)
+  {
+    octave_scalar_map stats;
+    for (int i = 0; i < PDE1dProfiler::NumCategories; i++) {
+      PDE1dProfiler::Category cat = (PDE1dProfiler::Category)i;
+      const PDE1dProfiler::Counter &c = prof.get(cat);
+      octave_scalar_map ci;
+      ci.assign("calls", (double)c.calls);
+      ci.assign("points", (double)c.points);
+      ci.assign("time", c.seconds);
+      stats.assign(PDE1dProfiler::name(cat), ci);
+    }
+    return stats;
+  }
+
+  // numRows solutions from a solution file in the form returned by pde1d
+  template<class F>
+  NDArray solutionArray(size_t numRows, int numPde, size_t numPts,
+    F rowData)
+  {
+    NDArray sol(dim_vector(numRows, numPts, numPde));
+    double *p = sol.fortran_vec();
+    for (size_t i = 0; i < numRows; i++) {
+      const double *ui = rowData(i);
+      for (int k = 0; k < numPde; k++)
+        for (size_t j = 0; j < numPts; j++)
+          p[i + numRows*(j + numPts*k)] = ui[k + numPde*j];
+    }
+    return sol;
+  }
+
+  octave_value_list readSolutionFile(const octave_value_list &args,
+    int nargout)
+  {
+    const int nrhs = args.length();
+    if (nrhs < 2 || nrhs > 3 || !args(1).is_string())
+      pdeErrMsgIdAndTxt("pde1d:read_args",
+        "Usage: info = pde1d('read',fileName) or "
+        "[u,uOde] = pde1d('read',fileName,timeIndices)");
+    PDESolutionReader sf(args(1).string_value());
+    const int numPde = sf.numPDE(), numOde = sf.numODE();
+    const size_t numPts = sf.numPts();
+    octave_value_list retval;
+    if (nrhs == 2) {
+      if (nargout > 1)
+        pdeErrMsgIdAndTxt("pde1d:nlhs",
+          "pde1d('read',fileName) returns a single struct.");
+      Matrix x(1, numPts);
+      std::copy_n(sf.x(), numPts, x.fortran_vec());
+      Matrix t(sf.numTimes(), 1);
+      for (size_t i = 0; i < sf.numTimes(); i++)
+        t(i, 0) = sf.time(i);
+      const size_t numEvents = sf.numEvents();
+      Matrix te(numEvents, 1), ie(numEvents, 1);
+      for (size_t i = 0; i < numEvents; i++) {
+        te(i, 0) = sf.eventTime(i);
+        ie(i, 0) = sf.eventIndex(i);
+      }
+      octave_scalar_map info;
+      info.assign("x", x);
+      info.assign("t", t);
+      info.assign("numPDE", numPde);
+      info.assign("numODE", numOde);
+      info.assign("te", te);
+      info.assign("ue", solutionArray(numEvents, numPde, numPts,
+        [&sf](size_t i) { return sf.eventU(i); }));
+      info.assign("ie", ie);
+      retval(0) = info;
+      return retval;
+    }
+    if (nargout > 2)
+      pdeErrMsgIdAndTxt("pde1d:nlhs",
+        "pde1d('read',fileName,timeIndices) returns at most two matrices.");
+    if (!args(2).isnumeric() || args(2).iscomplex())
+      pdeErrMsgIdAndTxt("pde1d:read_args",
+        "The time indices must be a real vector.");
+    const NDArray ti = args(2).array_value();
+    const size_t n = ti.numel();
+    std::vector<size_t> rows(n);
+    for (size_t i = 0; i < n; i++) {
+      if (ti(i) < 1 || ti(i) > sf.numTimes() || ti(i) != (size_t)ti(i)) {
+        char msg[1024];
+        sprintf(msg, "Time index %g is not an integer from 1 to %d.", ti(i),
+          (int)sf.numTimes());
+        pdeErrMsgIdAndTxt("pde1d:read_args", msg);
+      }
+      rows[i] = (size_t)ti(i) - 1;
+    }
+    std::vector<double> row(numPde*numPts);
+    retval(0) = solutionArray(n, numPde, numPts,
+      [&](size_t i) {
+        sf.u(rows[i], row.data());
+        return row.data();
+      });
+    if (nargout > 1) {
+      Matrix uOde(n, numOde);
+      for (size_t i = 0; i < n; i++)
+        for (int j = 0; j < numOde; j++)
+          uOde(i, j) = sf.v(rows[i])[j];
+      retval(1) = uOde;
+    }
+    return retval;
+  }
+
+  octave_value getSolutionField(const octave_scalar_map &sol,
+    const char *name)
+  {
+    if (!sol.isfield(name) || !sol.getfield(name).isnumeric() ||
+      sol.getfield(name).iscomplex()) {
+      char msg[1024];
+      sprintf(msg, "The solution struct has no real field \"%s\"; it "
+        "must be returned by pde1d with OutputCoefficients or DenseOutput "
+        "\"On\".", name);
+      pdeErrMsgIdAndTxt("pde1d:eval_args", msg);
+    }
+    return sol.getfield(name);
+  }
+
+  RealMatrix toRealMatrix(const octave_value &a)
+  {
+    const NDArray m = a.array_value();
+    return Eigen::Map<const RealMatrix>(m.data(), m.rows(), m.cols());
+  }
+
+  // [u,DuDx,flux] = pde1d('eval',sol,xq,tq,pdeFunc)
+  octave_value_list evalSolution(const octave_value_list &args,
+    int nargout)
+  {
+    const int nrhs = args.length();
+    if (nrhs < 4 || nrhs > 5 || !args(1).isstruct())
+      pdeErrMsgIdAndTxt("pde1d:eval_args",
+        "Usage: [u,DuDx,flux] = pde1d('eval',sol,xq,tq,pdeFunc)");
+    if (nargout > 3)
+      pdeErrMsgIdAndTxt("pde1d:nlhs",
+        "pde1d('eval',...) returns at most three matrices.");
+    if (nargout > 2 && (nrhs < 5 || !args(4).is_function_handle()))
+      pdeErrMsgIdAndTxt("pde1d:eval_args",
+        "The pde function handle is required to calculate the flux.");
+    for (int i = 2; i < 4; i++)
+      if (!args(i).isnumeric() || args(i).iscomplex())
+        pdeErrMsgIdAndTxt("pde1d:eval_args",
+          "The query points and times must be real vectors.");
+    const octave_scalar_map sol = args(1).scalar_map_value();
+    const octave_value uSol = getSolutionField(sol, "u");
+    const int numPde = uSol.ndims() > 2 ? (int)uSol.dims()(2) : 1;
+    const RealVector mesh = toVector(getSolutionField(sol, "mesh"));
+    const int polyOrder = getSolutionField(sol, "polyOrder").int_value();
+    // the integrator history, in the struct or a file, when it was
+    // recorded and otherwise the coefficients at the output times
+    std::unique_ptr<PDEDenseOutput> dense;
+    std::unique_ptr<PDESolutionQuery> queryPtr;
+    const octave_value hist = sol.isfield("history") ?
+      sol.getfield("history") : octave_value();
+    if (hist.is_string())
+      dense.reset(new PDEDenseOutput(hist.string_value()));
+    else if (hist.isstruct()) {
+      const octave_scalar_map h = hist.scalar_map_value();
+      dense.reset(new PDEDenseOutput(toVector(getSolutionField(h, "t")),
+        toVector(getSolutionField(h, "h")),
+        toVector(getSolutionField(h, "order")),
+        toRealMatrix(getSolutionField(h, "coefficients"))));
+    }
+    if (dense)
+      queryPtr.reset(new PDESolutionQuery(mesh, polyOrder, numPde, *dense));
+    else
+      queryPtr.reset(new PDESolutionQuery(mesh, polyOrder, numPde,
+        toVector(getSolutionField(sol, "t")),
+        toRealMatrix(getSolutionField(sol, "coefficients")),
+        sol.isfield("uOde") ? toRealMatrix(sol.getfield("uOde")) :
+        RealMatrix()));
+    const PDESolutionQuery &query = *queryPtr;
+    const RealVector xq = toVector(args(2)), tq = toVector(args(3));
+    const size_t nx = xq.size(), nt = tq.size();
+    RealMatrix u, DuDx;
+    query.eval(xq, tq, u, DuDx);
+    octave_value_list retval;
+    retval(0) = solutionArray(nt, numPde, nx,
+      [&u](size_t i) { return u.col(i).data(); });
+    if (nargout > 1)
+      retval(1) = solutionArray(nt, numPde, nx,
+        [&DuDx](size_t i) { return DuDx.col(i).data(); });
+    if (nargout < 3)
+      return retval;
+    // the flux is calculated by calling the pde function at each point
+    RealMatrix flux(u.rows(), nt);
+    RealVector v, vDot;
+    const bool hasODE = query.numODE() > 0;
+    octave_value_list fargs;
+    for (size_t i = 0; i < nt; i++) {
+      query.evalODE(tq[i], v, vDot);
+      for (size_t j = 0; j < nx; j++) {
+        fargs(0) = xq[j];
+        fargs(1) = tq[i];
+        fargs(2) = toMatrix(RealVector(u.col(i).segment(numPde*j, numPde)));
+        fargs(3) = toMatrix(RealVector(DuDx.col(i).segment(numPde*j,
+          numPde)));
+        if (hasODE) {
+          fargs(4) = toMatrix(v);
+          fargs(5) = toMatrix(vDot);
+        }
+        octave_value_list ret;
+        try {
+          ret = octave::feval(args(4), fargs, 3);
+        }
+        catch (const octave::execution_exception &) {
+          recoverFromOctaveError();
+          pdeErrMsgIdAndTxt("pde1d:eval_flux",
+            "An error occurred in the call to the pde function.");
+        }
+        if (ret.length() < 2 || ret(1).numel() != numPde)
+          pdeErrMsgIdAndTxt("pde1d:eval_flux",
+            "The flux returned by the pde function must have one value "
+            "for each PDE.");
+        const NDArray fj = ret(1).array_value();
+        std::copy_n(fj.data(), numPde, flux.col(i).data() + numPde*j);
+      }
+    }
+    retval(2) = solutionArray(nt, numPde, nx,
+      [&flux](size_t i) { return flux.col(i).data(); });
+    return retval;
+  }
+
+  octave_value_list solve(const octave_value_list &args, int nargout)
+  {
+    const int nrhs = args.length();
+    if (nrhs > 0 && args(0).is_string() &&
+      boost::iequals(args(0).string_value(), "eval"))
+      return evalSolution(args, nargout);
+    if (nrhs > 0 && args(0).is_string() &&
+      boost::iequals(args(0).string_value(), "read"))
+      return readSolutionFile(args, nargout);
+    if (nrhs > 0 && args(0).is_string())
+      pdeErrMsgIdAndTxt("pde1d:oct_session",
+        "The incremental solution commands are only available in the "
+        "mex-file version of pde1d.");
+    if (nrhs < 4)
+      pdeErrMsgIdAndTxt("pde1d:nrhs",
+        "Illegal number of input arguments passed to " FUNC_NAME);
+
+    PDE1dOptions opts;
+    octave_value eventsFunc;
+    std::unique_ptr<PDE1dDefn> pdeDefn;
+    checkCoordSys(args(0));
+    int m = args(0).int_value();
+    if (args(1).is_string() || args(1).isstruct()) {
+      if (nrhs != 4 && nrhs != 5)
+        pdeErrMsgIdAndTxt("pde1d:nrhs",
+          "Illegal number of input arguments passed to " FUNC_NAME);
+      checkMeshAndTimes(args(2), args(3));
+      if (nrhs == 5)
+        getOctOptions(args(4), opts, eventsFunc);
+      if (eventsFunc.is_defined())
+        pdeErrMsgIdAndTxt("pde1d:plugin_events",
+          "The \"Events\" option can not be used with a compiled problem "
+          "definition or one defined by expressions.");
+      opts.setVectorized(true);
+      if (args(1).is_string()) {
+        std::string libPath = args(1).string_value();
+        pdeDefn = std::unique_ptr<PDE1dDefn>(new PDE1dPluginDefn(
+          libPath.c_str(), m, toVector(args(2)), toVector(args(3))));
+        pdeDefn->applyEventsMeshPoints(opts);
+      }
+      else {
+        PDE1dExprDefn::Expressions exprs;
+        PDEExpression::ParamMap params;
+        PDETable::TableMap tables;
+        mxArray *mxDefn = toMxArray(args(1));
+        try {
+          getExpressionDefn(mxDefn, exprs, params, tables);
+        }
+        catch (...) {
+          mxDestroyArray(mxDefn);
+          throw;
+        }
+        mxDestroyArray(mxDefn);
+        pdeDefn = std::unique_ptr<PDE1dDefn>(new PDE1dExprDefn(m,
+          toVector(args(2)), toVector(args(3)), exprs, params, tables));
+        pdeDefn->applyEventsMeshPoints(opts);
+      }
+    }
+    else {
+      if (nrhs != 6 && nrhs != 7 && nrhs != 9 && nrhs != 10)
+        pdeErrMsgIdAndTxt("pde1d:nrhs",
+          "Illegal number of input arguments passed to " FUNC_NAME);
+      for (int i = 1; i < 4; i++) {
+        if (!args(i).is_function_handle()) {
+          char msg[80];
+          sprintf(msg, "Argument %d is not a function handle.", i + 1);
+          pdeErrMsgIdAndTxt("pde1d:arg_not_func", msg);
+        }
+      }
+      checkMeshAndTimes(args(4), args(5));
+      if (nrhs == 7 || nrhs == 10)
+        getOctOptions(args(nrhs - 1), opts, eventsFunc);
+      PDE1dOctInt *octDefn = new PDE1dOctInt(m, args(1), args(2), args(3),
+        args(4), args(5));
+      pdeDefn = std::unique_ptr<PDE1dDefn>(octDefn);
+      octDefn->applyEventsMeshPoints(opts);
+      octDefn->setEventsFunction(eventsFunc);
+      if (nrhs > 7)
+        octDefn->setODEDefn(args(6), args(7), args(8));
+    }
+    PDE1dDefn &pde = *pdeDefn;
+    const bool hasODE = pde.getNumODE() > 0;
+    const bool hasEvents = pde.getNumEvents() > 0;
+    int maxNargout = 1 + (hasODE ? 1 : 0) + (hasEvents ? 4 : 0);
+    if (nargout > maxNargout) {
+      char msg[80];
+      sprintf(msg, "pde1d returns at most %d matrices for this problem.",
+        maxNargout);
+      pdeErrMsgIdAndTxt("pde1d:nlhs", msg);
+    }
+
+    int numPde = pde.getNumPDE();
+    int numOde = pde.getNumODE();
+    PDE1dDriver driver(pde, opts);
+    PDESolution &pdeSol = driver.getSolution();
+    const PDEDenseOutput *dense = driver.getDenseOutput();
+    int viewMesh = opts.getViewMesh();
+    // the solution is written directly into the returned array when
+    // it is sized for all of the requested times
+    const int numPts = pdeSol.numSpatialPoints();
+    NDArray sol;
+    const bool preallocated = driver.canUseOutputBuffer();
+    if (preallocated) {
+      sol.resize(dim_vector(pde.getTimeSpan().size(), numPts, numPde));
+      pdeSol.setOutputBuffer(sol.fortran_vec());
+    }
+    const int derived = opts.getDerivedOutputs();
+    octave_value_list retval;
+    if (driver.solve())
+      return retval;
+    const bool outProfile = opts.getProfile();
+    if (driver.hasOutputFile()) {
+      // the solution is read from the file with pde1d('read',...)
+      retval.resize(nargout > 1 ? nargout : 1);
+      for (int i = 0; i < retval.length(); i++)
+        retval(i) = Matrix();
+      if (outProfile) {
+        octave_scalar_map profStruc;
+        profStruc.assign("profile",
+          profilerStats(driver.getImpl().getProfiler()));
+        retval(0) = profStruc;
+      }
+      return retval;
+    }
+
+    // close has packed the values for the times actually calculated at
+    // the start of the array
+    const int numTimes = pdeSol.numTimePoints();
+    if (!preallocated) {
+      sol.resize(dim_vector(numTimes, numPts, numPde));
+      pdeSol.decodeSolution(sol.fortran_vec());
+    }
+    else if (numTimes != sol.rows()) {
+      NDArray solPacked(dim_vector(numTimes, numPts, numPde));
+      std::copy_n(sol.data(), solPacked.numel(), solPacked.fortran_vec());
+      sol = solPacked;
+    }
+
+    const bool outCoeffs = opts.getOutputCoefficients();
+    const bool outTimes = outCoeffs || opts.getOutputChangeTol() > 0;
+    const bool outMesh = outCoeffs || dense;
+    if ((viewMesh > 1 && opts.getOutputX().empty()) || outTimes ||
+      outMesh || derived || outProfile) {
+      octave_scalar_map solStruc;
+      solStruc.assign("x", toMatrix(pdeSol.getX().transpose()));
+      solStruc.assign("u", sol);
+      if (numOde)
+        solStruc.assign("uOde", toMatrix(pdeSol.uOde));
+      if (outTimes)
+        solStruc.assign("t", toMatrix(pdeSol.getOutputTimes()));
+      if (outMesh) {
+        solStruc.assign("mesh", toMatrix(pde.getMesh().transpose()));
+        solStruc.assign("polyOrder", opts.getPolyOrder());
+      }
+      if (dense && !opts.getDenseOutputFile().empty())
+        solStruc.assign("history", opts.getDenseOutputFile());
+      else if (dense) {
+        // the history itself when it isn't in a file
+        const size_t ns = dense->numSteps();
+        octave_scalar_map hist;
+        hist.assign("t", toMatrix(ConstMapVec(dense->stepTimes().data(),
+          ns).transpose()));
+        hist.assign("h", toMatrix(ConstMapVec(dense->stepSizes().data(),
+          ns).transpose()));
+        hist.assign("order", toMatrix(Eigen::Map<const Eigen::VectorXi>(
+          dense->orders().data(), ns).cast<double>().transpose().eval()));
+        hist.assign("coefficients", toMatrix(dense->coefficients()));
+        solStruc.assign("history", hist);
+      }
+      if (outCoeffs) {
+        solStruc.assign("coefficients", toMatrix(pdeSol.getCoefficients()));
+      }
+      if (derived & PDE1dOptions::DerivedDuDx) {
+        const RealMatrix &duDx = pdeSol.getDuDx();
+        solStruc.assign("dudx", solutionArray(numTimes, numPde, numPts,
+          [&duDx](size_t i) { return duDx.col(i).data(); }));
+      }
+      if (derived & PDE1dOptions::DerivedFlux) {
+        const RealMatrix &flux = pdeSol.getFlux();
+        solStruc.assign("flux", solutionArray(numTimes, numPde, numPts,
+          [&flux](size_t i) { return flux.col(i).data(); }));
+      }
+      if (derived & PDE1dOptions::DerivedIntegrals)
+        solStruc.assign("integrals",
+          toMatrix(pdeSol.getIntegrals().transpose()));
+      if (outProfile)
+        solStruc.assign("profile",
+          profilerStats(driver.getImpl().getProfiler()));
+      retval(0) = solStruc;
+    }
+    else {
+      retval(0) = sol;
+      if (hasODE && nargout > 1)
+        retval(1) = toMatrix(pdeSol.uOde);
+    }
+    if (hasEvents && nargout > retval.length()) {
+      retval(retval.length()) = toMatrix(pdeSol.getOutputTimes());
+      retval(retval.length()) = toMatrix(pdeSol.getEventsSolution());
+      retval(retval.length()) = toMatrix(pdeSol.getEventsTimes());
+      retval(retval.length()) = toMatrix(pdeSol.getEventsIndex());
+    }
+    return retval;
+  }
+
+}
+
+namespace {
+
+  void octPrint(const char *msg)
+  {
+    octave_stdout << msg;
+  }
+
+  void octWarning(const char *id, const char *msg)
+  {
+    warning_with_id(id, "%s", msg);
+  }
+
+}
+
+DEFUN_DLD(pde1d, args, nargout,
+  "Solve systems of partial differential equations in one spatial\n"
+  "variable and time. See the help for pde1d.m for a description\n"
+  "of the arguments.")
+{
+  scoped_redirect_cout coutRedirect;
+  setPDE1dPrintSink(octPrint);
+  setPDE1dWarningSink(octWarning);
+  try {
+    return solve(args, nargout);
+  }
+  catch (const PDE1dException &ex) {
+    error_with_id(ex.getId(), "%s", ex.what());
+  }
+  catch (const octave::execution_exception &) {
+    throw;
+  }
+  catch (const std::exception &ex) {
+    error_with_id("pde1d:exception", "%s", ex.what());
+  }
+  return octave_value_list();
+}
@@ -0,0 +1,347 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Standalone driver that solves a problem defined in a compiled plugin
+ * (see PDE1dPlugin.h) without MATLAB or Octave. Run with no arguments
+ * for the usage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <chrono>
+
+#include <boost/algorithm/string.hpp>
+
+#include "PDE1dDriver.h"
+#include "PDE1dOptions.h"
+#include "PDE1dPluginDefn.h"
+#include "PDESolution.h"
+#include "PDE1dException.h"
+#include "util.h"
+
+namespace {
+
+  const char *usage =
+    "Usage: pde1drun [options] m libPath\n"
+    "  m                    coordinate system: 0, 1, or 2\n"
+    "  libPath              compiled problem definition\n"
+    "Options:\n"
+    "  --mesh a:b:n         n uniformly spaced mesh points from a to b\n"
+    "  --mesh-file file     mesh points read from a text file\n"
+    "  --times a:b:n        n uniformly spaced output times from a to b\n"
+    "  --times-file file    output times read from a text file\n"
+    "  -o file              write the solution to a binary file (see\n"
+    "                       PDESolutionFile.h) instead of text to stdout\n"
+    "  --timing             print the solution time to stderr\n"
+    "  Name=Value           solver option with the same name as in pde1d.m,\n"
+    "                       e.g. RelTol=1e-4 PolyOrder=2 ViewMesh=4 Stats=on\n";
+
+  void argError(const std::string &msg)
+  {
+    throw PDE1dException("pde1d:pde1drun", msg.c_str());
+  }
+
+  double toDouble(const std::string &s, const std::string &name)
+  {
+    char *end;
+    double d = strtod(s.c_str(), &end);
+    if (s.empty() || *end)
+      argError("Invalid value \"" + s + "\" for " + name + ".");
+    return d;
+  }
+
+  int toInt(const std::string &s, const std::string &name)
+  {
+    double d = toDouble(s, name);
+    if (d != (int)d)
+      argError("Value of " + name + " must be an integer.");
+    return (int)d;
+  }
+
+  double toPositive(const std::string &s, const std::string &name)
+  {
+    double d = toDouble(s, name);
+    if (!(d > 0))
+      argError("Value of " + name + " must be greater than zero.");
+    return d;
+  }
+
+  int toPositiveInt(const std::string &s, const std::string &name)
+  {
+    int i = toInt(s, name);
+    if (i < 1)
+      argError("Value of " + name + " must be at least one.");
+    return i;
+  }
+
+  bool toBool(const std::string &s, const std::string &name)
+  {
+    if (boost::iequals(s, "on") || s == "1" || boost::iequals(s, "true"))
+      return true;
+    if (boost::iequals(s, "off") || s == "0" || boost::iequals(s, "false"))
+      return false;
+    argError("Value of " + name + " must be \"On\" or \"Off\".");
+    return false;
+  }
+
+  // a:b:n
+  RealVector rangeArg(const std::string &s, const char *name)
+  {
+    std::vector<std::string> parts;
+    boost::split(parts, s, boost::is_any_of(":"));
+    if (parts.size() != 3)
+      argError(std::string("The value of ") + name +
+        " must have the form start:end:numPoints.");
+    int n = toInt(parts[2], name);
+    if (n < 2)
+      argError(std::string("At least two points are required for ") + name +
+        ".");
+    return linspace(toDouble(parts[0], name), toDouble(parts[1], name), n);
+  }
+
+  RealVector fileArg(const char *fileName)
+  {
+    std::ifstream in(fileName);
+    if (!in)
+      argError(std::string("Unable to open \"") + fileName + "\".");
+    std::vector<double> vals;
+    double d;
+    while (in >> d)
+      vals.push_back(d);
+    if (!in.eof())
+      argError(std::string("Invalid number in \"") + fileName + "\".");
+    return Eigen::Map<RealVector>(vals.data(), vals.size());
+  }
+
+  // comma-separated values
+  std::vector<double> listArg(const std::string &s, const std::string &name)
+  {
+    std::vector<std::string> parts;
+    boost::split(parts, s, boost::is_any_of(","));
+    std::vector<double> vals;
+    for (const std::string &p : parts)
+      vals.push_back(toDouble(p, name));
+    return vals;
+  }
+
+  void setOption(PDE1dOptions &opts, const std::string &name,
+    const std::string &val)
+  {
+    auto is = [&name](const char *n) { return boost::iequals(name, n); };
+    if (is("RelTol"))
+      opts.setRelTol(toDouble(val, name));
+    else if (is("AbsTol"))
+      opts.setAbsTol(toDouble(val, name));
+    else if (is("Vectorized")) {
+      if (boost::iequals(val, "auto"))
+        opts.setVectorizedAuto();
+      else
+        opts.setVectorized(toBool(val, name));
+    }
+    else if (is("MaxSteps"))
+      opts.setMaxSteps(toInt(val, name));
+    else if (is("Stats"))
+      opts.setPrintStats(toBool(val, name));
+    else if (is("ICMethod"))
+      opts.setICMethod(toInt(val, name));
+    else if (is("PolyOrder"))
+      opts.setPolyOrder(toInt(val, name));
+    else if (is("ViewMesh"))
+      opts.setViewMesh(toInt(val, name));
+    else if (is("DiagonalMassMatrix"))
+      opts.setDiagMassMat(toBool(val, name));
+    else if (is("MaxOrder")) {
+      int maxOrder = toInt(val, name);
+      if (maxOrder < 1 || maxOrder > 5)
+        argError("Value of " + name + " must be between 1 and 5.");
+      opts.setMaxOrder(maxOrder);
+    }
+    else if (is("InitialStep"))
+      opts.setInitialStep(toPositive(val, name));
+    else if (is("MaxStep"))
+      opts.setMaxStep(toPositive(val, name));
+    else if (is("MaxNonlinIters"))
+      opts.setMaxNonlinIters(toPositiveInt(val, name));
+    else if (is("MaxConvFails"))
+      opts.setMaxConvFails(toPositiveInt(val, name));
+    else if (is("MaxErrTestFails"))
+      opts.setMaxErrTestFails(toPositiveInt(val, name));
+    else if (is("AutoTune"))
+      opts.setAutoTune(toBool(val, name));
+    else if (is("BatchJacobian"))
+      opts.setBatchJacobian(toBool(val, name));
+    else if (is("Profile"))
+      opts.setProfile(toBool(val, name));
+    else if (is("SteadyState"))
+      opts.setSteadyState(toBool(val, name));
+    else if (is("Period"))
+      opts.setPeriod(toDouble(val, name));
+    else if (is("Breakpoints"))
+      opts.setBreakpoints(listArg(val, name));
+    else if (is("OutputPrecision")) {
+      if (boost::iequals(val, "double"))
+        opts.setOutputPrecision(PDE1dOptions::DoubleOutput);
+      else if (boost::iequals(val, "single"))
+        opts.setOutputPrecision(PDE1dOptions::SingleOutput);
+      else if (boost::iequals(val, "quantized"))
+        opts.setOutputPrecision(PDE1dOptions::QuantizedOutput);
+      else
+        argError("Value of " + name + " must be \"Double\", \"Single\", "
+          "or \"Quantized\".");
+    }
+    else if (is("QuantizationTol"))
+      opts.setQuantizationTol(toDouble(val, name));
+    else if (is("OutputCompression"))
+      opts.setOutputCompression(toBool(val, name));
+    else if (is("OutputChangeTol"))
+      opts.setOutputChangeTol(toDouble(val, name));
+    else if (is("OutputChangeNorm")) {
+      if (boost::iequals(val, "max"))
+        opts.setOutputChangeNorm(PDE1dOptions::MaxChangeNorm);
+      else if (boost::iequals(val, "rms"))
+        opts.setOutputChangeNorm(PDE1dOptions::RMSChangeNorm);
+      else
+        argError("Value of " + name + " must be \"Max\" or \"RMS\".");
+    }
+    else if (is("OutputThread"))
+      opts.setOutputThread(toBool(val, name));
+    else if (is("DenseOutputFile")) {
+      opts.setDenseOutputFile(val);
+      opts.setDenseOutput(true);
+    }
+    else if (is("OutputX"))
+      opts.setOutputX(listArg(val, name));
+    else if (is("EventsMeshPoints")) {
+      // one-based, as in pde1d.m
+      std::vector<std::string> parts;
+      boost::split(parts, val, boost::is_any_of(","));
+      std::vector<int> pts;
+      for (const std::string &p : parts)
+        pts.push_back(toInt(p, name) - 1);
+      opts.setEventsMeshPoints(pts);
+    }
+    else if (is("LinearSolver")) {
+      // the sparse linear solver is chosen when pde1d is built
+#if USE_EIGEN_LU
+      const char *built = "Eigen";
+#else
+      const char *built = "KLU";
+#endif
+      if (!boost::iequals(val, built))
+        argError(std::string("This executable was built with the ") + built +
+          " linear solver.");
+    }
+    else
+      argError("Unknown option \"" + name + "\".");
+  }
+
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3) {
+    fputs(usage, stderr);
+    return 1;
+  }
+  try {
+    PDE1dOptions opts;
+    RealVector mesh, tspan;
+    std::string outFile;
+    bool timing = false;
+    std::vector<const char*> posArgs;
+    for (int i = 1; i < argc; i++) {
+      const char *a = argv[i];
+      bool hasVal = i + 1 < argc;
+      if (!strcmp(a, "--mesh") && hasVal)
+        mesh = rangeArg(argv[++i], "--mesh");
+      else if (!strcmp(a, "--mesh-file") && hasVal)
+        mesh = fileArg(argv[++i]);
+      else if (!strcmp(a, "--times") && hasVal)
+        tspan = rangeArg(argv[++i], "--times");
+      else if (!strcmp(a, "--times-file") && hasVal)
+        tspan = fileArg(argv[++i]);
+      else if (!strcmp(a, "-o") && hasVal)
+        outFile = argv[++i];
+      else if (!strcmp(a, "--timing"))
+        timing = true;
+      else if (a[0] == '-' && !isdigit((unsigned char)a[1]))
+        argError(std::string("Unknown or incomplete argument \"") + a + "\".");
+      else if (strchr(a, '=')) {
+        const char *eq = strchr(a, '=');
+        setOption(opts, std::string(a, eq), eq + 1);
+      }
+      else
+        posArgs.push_back(a);
+    }
+    if (posArgs.size() != 2)
+      argError("The coordinate system, m, and the library path are "
+        "required.");
+    if (!mesh.size() || !tspan.size())
+      argError("The mesh and output times must be specified.");
+    int m = toInt(posArgs[0], "m");
+    PDE1dPluginDefn pde(posArgs[1], m, mesh, tspan);
+    pde.applyEventsMeshPoints(opts);
+    // the plugin functions are always evaluated at all points at once
+    opts.setVectorized(true);
+
+    // the solution is appended to the output file as it is calculated
+    // and the integrator history is only useful from a file here
+    if (!outFile.empty())
+      opts.setOutputFile(outFile);
+    opts.setDenseOutput(!opts.getDenseOutputFile().empty());
+
+    auto start = std::chrono::steady_clock::now();
+    PDE1dDriver driver(pde, opts);
+    int err = driver.solve();
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    if (err)
+      return 2;
+    if (timing)
+      fprintf(stderr, "Solution time = %.6f seconds.\n", elapsed.count());
+
+    if (driver.hasOutputFile())
+      return 0;
+    // text: one line per output time, t followed by u at each point
+    // for each PDE and then the ODE variables
+    PDESolution &pdeSol = driver.getSolution();
+    const int nt = pdeSol.numTimePoints(), np = pdeSol.numSpatialPoints();
+    const int numPde = pde.getNumPDE();
+    std::vector<double> u((size_t)nt*np*numPde);
+    pdeSol.decodeSolution(u.data());
+    const RealVector &t = pdeSol.getOutputTimes();
+    for (int i = 0; i < nt; i++) {
+      printf("%.17g", t(i));
+      for (int j = 0; j < np; j++)
+        for (int k = 0; k < numPde; k++)
+          printf(" %.17g", u[i + (size_t)nt*(j + (size_t)np*k)]);
+      for (int j = 0; j < pdeSol.uOde.cols(); j++)
+        printf(" %.17g", pdeSol.uOde(i, j));
+      printf("\n");
+    }
+  }
+  catch (const std::exception &ex) {
+    fprintf(stderr, "%s\n", ex.what());
+    return 1;
+  }
+  return 0;
+}
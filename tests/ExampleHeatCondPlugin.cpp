@@ -0,0 +1,66 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * The problem in ExampleHeatCond.h as a compiled problem definition.
+ * Usage: u = pde1d(0, 'path/to/exampleHeatCondPlugin.so', x, t)
+ */
+
+#include "PDE1dPlugin.h"
+
+namespace {
+
+  int ic(void *, int numPts, const double *x, double *u0)
+  {
+    for (int i = 0; i < numPts; i++)
+      u0[i] = 0;
+    return 0;
+  }
+
+  int pde(void *, int numPts, const double *x, double t,
+    const double *u, const double *dudx, const double *v, const double *vDot,
+    double *c, double *f, double *s)
+  {
+    for (int i = 0; i < numPts; i++) {
+      c[i] = 1;
+      f[i] = 10 * dudx[i];
+      s[i] = 0;
+    }
+    return 0;
+  }
+
+  int bc(void *, double xl, const double *ul, double xr,
+    const double *ur, double t, const double *v, const double *vDot,
+    double *pl, double *ql, double *pr, double *qr)
+  {
+    pl[0] = ul[0] - 10;
+    ql[0] = 0;
+    // insulated at rt end
+    pr[0] = 0;
+    qr[0] = 1;
+    return 0;
+  }
+
+}
+
+extern "C" PDE1D_PLUGIN_EXPORT int pde1dPluginInit(PDE1dPluginProblem *prob)
+{
+  prob->abiVersion = PDE1D_PLUGIN_ABI_VERSION;
+  prob->numPDE = 1;
+  prob->ic = ic;
+  prob->pde = pde;
+  prob->bc = bc;
+  return 0;
+}
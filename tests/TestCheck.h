@@ -0,0 +1,62 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+/*
+ * Minimal checks for the unit tests. A failed check prints its location
+ * and is counted; the test returns testResult() from main.
+ */
+namespace {
+
+  int numFailures = 0;
+
+  bool checkImpl(bool ok, const char *expr, const char *file, int line)
+  {
+    if (!ok) {
+      printf("%s:%d: check failed: %s\n", file, line, expr);
+      numFailures++;
+    }
+    return ok;
+  }
+
+  bool isClose(double a, double b, double tol)
+  {
+    return std::abs(a - b) <= tol*(1 + std::abs(b));
+  }
+
+  int testResult()
+  {
+    if (numFailures)
+      printf("%d check(s) failed\n", numFailures);
+    else
+      printf("all checks passed\n");
+    return numFailures ? 1 : 0;
+  }
+
+}
+
+#define CHECK(cond) checkImpl((cond), #cond, __FILE__, __LINE__)
+#define CHECK_CLOSE(a, b, tol) \
+  checkImpl(isClose((a), (b), (tol)), #a " == " #b, __FILE__, __LINE__)
+// the statement must throw a PDE1dException
+#define CHECK_THROWS(stmt) do { \
+    bool thrown = false; \
+    try { stmt; } catch (const PDE1dException &) { thrown = true; } \
+    checkImpl(thrown, #stmt " throws", __FILE__, __LINE__); \
+  } while (0)
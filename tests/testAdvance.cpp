@@ -0,0 +1,112 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests that a solution advanced incrementally in time is the same as
+ * one calculated in a single call.
+ */
+
+#include <cmath>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+#include "PDEModel.h"
+#include "PDESolution.h"
+#include "SunVector.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  // u_t = u_xx, u(x,0) = sin(pi*x), u(0) = u(1) = 0
+  class DecayDefn : public PDE1dTestDefn {
+  public:
+    DecayDefn() : PDE1dTestDefn(1, 20, .2, 3) {}
+    virtual void evalIC(double x, RealVector &ic) {
+      ic(0) = std::sin(pi*x);
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0);
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = 0;
+    }
+  };
+
+  void setOptions(PDE1dOptions &opts)
+  {
+    opts.setRelTol(1e-6);
+    opts.setAbsTol(1e-8);
+  }
+
+  // the current solution at the mesh points
+  RealVector currentSolution(const PDE1dImpl &pdeImpl, const PDE1dDefn &pde)
+  {
+    const SunVector &u = pdeImpl.getCurrentSolution();
+    RealMatrix uMesh(1, pde.getMesh().size());
+    pdeImpl.getModel().globalToMeshVec(u, uMesh);
+    return uMesh.row(0).transpose();
+  }
+
+}
+
+int main()
+{
+  DecayDefn pde;
+  PDE1dOptions opts;
+  setOptions(opts);
+
+  // one-shot solution at the output times 0, .1, .2
+  PDE1dImpl oneShot(pde, opts);
+  PDESolution sol(pde, oneShot.getModel(), 1);
+  oneShot.solveTransient(sol);
+  const RealMatrix &uOneShot = sol.getSolution();
+  CHECK(sol.numTimePoints() == 3);
+
+  PDE1dImpl pdeImpl(pde, opts);
+  pdeImpl.initTransient();
+  CHECK(pdeImpl.getCurrentTime() == 0);
+  for (int i = 1; i < 3; i++) {
+    double t = .1*i;
+    pdeImpl.advance(t);
+    CHECK(pdeImpl.getCurrentTime() == t);
+    RealVector u = currentSolution(pdeImpl, pde);
+    CHECK(u.size() == uOneShot.cols());
+    for (int j = 0; j < u.size(); j++)
+      CHECK_CLOSE(u(j), uOneShot(i, j), 1e-8);
+  }
+
+  // the solution can not be advanced to the current or an earlier time
+  CHECK_THROWS(pdeImpl.advance(.2));
+  CHECK_THROWS(pdeImpl.advance(.1));
+  CHECK(pdeImpl.getCurrentTime() == .2);
+
+  // nor before it has been initialized
+  PDE1dImpl notInit(pde, opts);
+  CHECK_THROWS(notInit.advance(.1));
+  return testResult();
+}
@@ -0,0 +1,149 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the integrator controls chosen by AutoTune and of the
+ * checks on the controls set by the user.
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+#include "PDESolution.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  // u_t = u_xx, u(x,0) = sin(pi*x), u(0) = u(1) = 0
+  class DecayDefn : public PDE1dTestDefn {
+  public:
+    DecayDefn() : PDE1dTestDefn(1, 20, .5, 6) {}
+    virtual void evalIC(double x, RealVector &ic) {
+      ic(0) = std::sin(pi*x);
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0);
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = 0;
+    }
+  };
+
+  // solve with AutoTune and return the profile it found
+  std::string solveTuned(PDE1dOptions &opts)
+  {
+    DecayDefn pde;
+    opts.setAutoTune(true);
+    PDE1dImpl pdeImpl(pde, opts);
+    PDESolution sol(pde, pdeImpl.getModel(), 1);
+    pdeImpl.solveTransient(sol);
+    const RealMatrix &u = sol.getSolution();
+    CHECK(sol.numTimePoints() == 6);
+    // the center value decays as exp(-pi^2*t)
+    CHECK_CLOSE(u(5, 10), std::exp(-pi*pi*.5), 1e-2);
+    return pdeImpl.getAutoTuneProfile();
+  }
+
+  bool isRejected(PDE1dOptions &opts)
+  {
+    DecayDefn pde;
+    bool rejected = false;
+    try {
+      PDE1dImpl pdeImpl(pde, opts);
+    }
+    catch (const PDE1dException &) {
+      rejected = true;
+    }
+    return rejected;
+  }
+
+}
+
+int main()
+{
+  // no profile without AutoTune
+  {
+    DecayDefn pde;
+    PDE1dOptions opts;
+    PDE1dImpl pdeImpl(pde, opts);
+    PDESolution sol(pde, pdeImpl.getModel(), 1);
+    pdeImpl.solveTransient(sol);
+    CHECK(pdeImpl.getAutoTuneProfile().empty());
+  }
+
+  // the controls are chosen and reported but MaxStep is never limited
+  {
+    PDE1dOptions opts;
+    std::string profile = solveTuned(opts);
+    CHECK(profile == "smooth" || profile == "rough" ||
+      profile == "nonlinear" || profile == "rough, nonlinear");
+    CHECK(opts.getInitialStep() > 0);
+    CHECK(opts.getMaxStep() == 0);
+  }
+
+  // controls set by the user are kept
+  {
+    PDE1dOptions opts;
+    opts.setMaxStep(.01);
+    opts.setInitialStep(1e-5);
+    opts.setMaxOrder(3);
+    solveTuned(opts);
+    CHECK(opts.getMaxStep() == .01);
+    CHECK(opts.getInitialStep() == 1e-5);
+    CHECK(opts.getMaxOrder() == 3);
+  }
+
+  // invalid controls are rejected; zero selects the default
+  {
+    PDE1dOptions opts;
+    CHECK(!isRejected(opts));
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (double h : { -1., nan }) {
+      PDE1dOptions opts1, opts2;
+      opts1.setMaxStep(h);
+      CHECK(isRejected(opts1));
+      opts2.setInitialStep(h);
+      CHECK(isRejected(opts2));
+    }
+    for (int order : { -1, 6 }) {
+      PDE1dOptions opts1;
+      opts1.setMaxOrder(order);
+      CHECK(isRejected(opts1));
+    }
+    PDE1dOptions opts1, opts2, opts3;
+    opts1.setMaxNonlinIters(-1);
+    CHECK(isRejected(opts1));
+    opts2.setMaxConvFails(-1);
+    CHECK(isRejected(opts2));
+    opts3.setMaxErrTestFails(-1);
+    CHECK(isRejected(opts3));
+  }
+  return testResult();
+}
@@ -0,0 +1,145 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests that the finite difference Jacobian calculated with all
+ * perturbations in a single vectorized residual evaluation is the same
+ * as the one calculated with a residual evaluation for each group.
+ */
+
+#include <cmath>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "SunVector.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  // two coupled nonlinear equations with nonlinear boundary conditions
+  // so that perturbing an end node changes the boundary residuals
+  class CoupledDefn : public PDE1dTestDefn {
+  public:
+    CoupledDefn(int nel) : PDE1dTestDefn(1, nel, 1, 2, 2) {
+      numBCCalls = 0;
+    }
+    virtual void evalIC(double x, RealVector &ic) {
+      ic(0) = 1 + x;
+      ic(1) = 2 - x*x;
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      numBCCalls++;
+      bc.pl(0) = ul(0)*ul(0) - ul(1);
+      bc.ql(0) = 0;
+      bc.pl(1) = 0;
+      bc.ql(1) = 1;
+      bc.pr(0) = ur(0)*ur(1);
+      bc.qr(0) = 1;
+      bc.pr(1) = ur(1)*ur(1)*ur(1) - 2;
+      bc.qr(1) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.c(1) = 1 + u(0)*u(0);
+      pde.f(0) = (1 + u(0)*u(0))*DuDx(0);
+      pde.f(1) = DuDx(1) + u(0)*u(1);
+      pde.s(0) = u(0)*u(1) + x;
+      pde.s(1) = -u(1)*u(1)*u(1)*t + DuDx(0);
+    }
+    virtual bool hasVectorPDEEval() const { return true; }
+    virtual void evalPDE(const RealVector &x, double t,
+      const RealMatrix &u, const RealMatrix &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      RealVector ui(2), dudxi(2);
+      PDECoeff pc;
+      pc.c.resize(2, 1);
+      pc.f.resize(2, 1);
+      pc.s.resize(2, 1);
+      for (int i = 0; i < x.size(); i++) {
+        ui = u.col(i);
+        dudxi = DuDx.col(i);
+        evalPDE(x(i), t, ui, dudxi, v, vDot, pc);
+        pde.c.col(i) = pc.c.col(0);
+        pde.f.col(i) = pc.f.col(0);
+        pde.s.col(i) = pc.s.col(0);
+      }
+    }
+    int numBCCalls;
+  };
+
+  double maxAbs(const SparseMat &a)
+  {
+    double m = 0;
+    for (int k = 0; k < a.outerSize(); ++k)
+      for (SparseMat::InnerIterator it(a, k); it; ++it)
+        m = std::max(m, std::abs(it.value()));
+    return m;
+  }
+
+  void testJacobian(int polyOrder)
+  {
+    const int nel = 6;
+    const size_t n = 2 * (nel*polyOrder + 1);
+    CoupledDefn pde(nel), pdeBatch(nel);
+    PDE1dOptions opts, optsBatch;
+    opts.setVectorized(true);
+    opts.setPolyOrder(polyOrder);
+    optsBatch = opts;
+    optsBatch.setBatchJacobian(true);
+    PDE1dImpl impl(pde, opts), implBatch(pdeBatch, optsBatch);
+
+    SunVector u(n), up(n), r(n);
+    for (size_t i = 0; i < n; i++) {
+      u[i] = 1 + 0.3*std::sin(1.7*i);
+      up[i] = 0.2*std::cos(0.9*i);
+    }
+    const double t = 0.5, cj = 20;
+    // DfDu, DfDuDot, and the iteration matrix
+    const double coeffs[3][2] = { { 1, 0 }, { 0, 1 }, { 1, cj } };
+    for (int i = 0; i < 3; i++) {
+      SparseMat jac(n, n), jacBatch(n, n);
+      pde.numBCCalls = pdeBatch.numBCCalls = 0;
+      impl.calcJacobian(t, coeffs[i][0], coeffs[i][1], u, up, r, jac);
+      implBatch.calcJacobian(t, coeffs[i][0], coeffs[i][1], u, up, r,
+        jacBatch);
+      // the groups perturbing the end values of u need their own
+      // boundary conditions but the others reuse the unperturbed ones
+      if (coeffs[i][0]) {
+        CHECK(pdeBatch.numBCCalls > 1);
+        CHECK(pdeBatch.numBCCalls < pde.numBCCalls);
+      }
+      else
+        CHECK(pdeBatch.numBCCalls == 1);
+      CHECK(jac.nonZeros() == jacBatch.nonZeros());
+      // the residuals are summed in a different order so the
+      // differences agree only to their rounding divided by the step
+      const double tol = 1e-5*maxAbs(jac);
+      CHECK(maxAbs(jac - jacBatch) <= tol);
+    }
+  }
+
+}
+
+int main()
+{
+  for (int polyOrder = 1; polyOrder <= 3; polyOrder++)
+    testJacobian(polyOrder);
+  return testResult();
+}
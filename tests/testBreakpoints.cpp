@@ -0,0 +1,141 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the restart at a breakpoint where the source term switches on,
+ * both when the solution still satisfies the equations after it and when
+ * consistent initial conditions must be recalculated.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "SunVector.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double tBreak = 1;
+
+  // u_t = u_xx + s(t) with zero flux at both ends and u(x,0) = 0 so that
+  // u(x,t) is the integral of s. s is zero before the breakpoint and
+  // afterwards either jumps to 1 or rises continuously as t - tBreak.
+  class SwitchDefn : public PDE1dTestDefn {
+  public:
+    SwitchDefn(bool jump) : PDE1dTestDefn(1, 10, 2, 5), jump(jump) {
+      numBCCallsAfter = 0;
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      // the residual evaluations just past the breakpoint
+      if (t > tBreak && t < tBreak + 1e-12)
+        numBCCallsAfter++;
+      bc.pl(0) = 0;
+      bc.ql(0) = 1;
+      bc.pr(0) = 0;
+      bc.qr(0) = 1;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = t > tBreak ? (jump ? 1 : t - tBreak) : 0;
+    }
+    double exact(double t) const {
+      if (t <= tBreak)
+        return 0;
+      double dt = t - tBreak;
+      return jump ? dt : dt*dt / 2;
+    }
+    double exactDot(double t) const {
+      if (t < tBreak)
+        return 0;
+      return jump ? 1 : t - tBreak;
+    }
+    int numBCCallsAfter;
+  private:
+    bool jump;
+  };
+
+  void setOptions(PDE1dOptions &opts)
+  {
+    opts.setRelTol(1e-6);
+    opts.setAbsTol(1e-8);
+    opts.setBreakpoints(std::vector<double>(1, tBreak));
+  }
+
+  void testSolve(bool jump)
+  {
+    SwitchDefn pde(jump);
+    PDE1dOptions opts;
+    setOptions(opts);
+    PDE1dImpl pdeImpl(pde, opts);
+    PDESolution sol(pde, pdeImpl.getModel(), 1);
+    pdeImpl.solveTransient(sol);
+    const RealVector &t = sol.getOutputTimes();
+    const RealMatrix &u = sol.getSolution();
+    CHECK(sol.numTimePoints() == 5);
+    for (int i = 0; i < sol.numTimePoints(); i++)
+      for (int j = 0; j < u.cols(); j++)
+        CHECK_CLOSE(u(i, j), pde.exact(t(i)), 1e-5);
+  }
+
+  void testRestart(bool jump)
+  {
+    SwitchDefn pde(jump);
+    PDE1dOptions opts;
+    setOptions(opts);
+    PDE1dImpl pdeImpl(pde, opts);
+    pdeImpl.initTransient();
+    pdeImpl.advance(tBreak);
+    CHECK(pdeImpl.getCurrentTime() == tBreak);
+    if (jump) {
+      // the time derivative jumps so the residual test fails and
+      // consistent initial conditions are calculated after the switch
+      CHECK(pde.numBCCallsAfter > 1);
+    }
+    else {
+      // the solution is consistent so the integrator is only
+      // re-initialized; the single call is the residual test
+      CHECK(pde.numBCCallsAfter == 1);
+    }
+    const SunVector &u = pdeImpl.getCurrentSolution();
+    const SunVector &up = pdeImpl.getCurrentSolutionDot();
+    // to the accuracy of the initial condition calculation
+    for (int i = 0; i < u.size(); i++) {
+      CHECK_CLOSE(u[i], 0, 1e-6);
+      CHECK_CLOSE(up[i], pde.exactDot(tBreak), 1e-5);
+    }
+    pdeImpl.advance(2);
+    for (int i = 0; i < u.size(); i++)
+      CHECK_CLOSE(u[i], pde.exact(2), 1e-5);
+  }
+
+}
+
+int main()
+{
+  for (bool jump : { false, true }) {
+    testSolve(jump);
+    testRestart(jump);
+  }
+  return testResult();
+}
@@ -0,0 +1,132 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the integrator history recorded with the DenseOutput option:
+ * recording the steps must not change the outputs or events, and the
+ * history must reproduce the solution at the output times.
+ */
+
+#include <cmath>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDEDenseOutput.h"
+#include "PDE1dException.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  // u_t = u_xx, u(x,0) = sin(pi*x), u(0) = u(1) = 0, with non-terminal
+  // events when u at the center falls to 1/2 and 1/4
+  class DecayDefn : public PDE1dTestDefn {
+  public:
+    DecayDefn() : PDE1dTestDefn(1, 20, .2, 11) {}
+    virtual void evalIC(double x, RealVector &ic) {
+      ic(0) = std::sin(pi*x);
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0);
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = 0;
+    }
+    virtual int getNumEvents() const { return 2; }
+    virtual void evalEvents(double t, const RealMatrix &u,
+      RealVector &eventsVal, RealVector &eventsIsTerminal,
+      RealVector &eventsDirection) {
+      double uc = u(0, u.cols() / 2);
+      eventsVal(0) = uc - .5;
+      eventsVal(1) = uc - .25;
+      eventsIsTerminal.setZero();
+      eventsDirection.setConstant(-1);
+    }
+  };
+
+  struct Result {
+    Result(PDE1dDefn &pde, bool dense) {
+      opts.setRelTol(1e-6);
+      opts.setAbsTol(1e-8);
+      opts.setDenseOutput(dense);
+      PDE1dImpl pdeImpl(pde, opts);
+      PDESolution s(pde, pdeImpl.getModel(), 1);
+      s.setStoreCoefficients(true);
+      if (dense)
+        pdeImpl.setDenseOutput(&history);
+      pdeImpl.solveTransient(s);
+      t = s.getOutputTimes();
+      u = s.getSolution();
+      coeffs = s.getCoefficients();
+      eventsT = s.getEventsTimes();
+      eventsIndex = s.getEventsIndex();
+    }
+    PDE1dOptions opts;
+    PDEDenseOutput history;
+    RealVector t, eventsT;
+    RealMatrix u, coeffs;
+    IntVector eventsIndex;
+  };
+
+}
+
+int main()
+{
+  DecayDefn pde;
+  Result off(pde, false), on(pde, true);
+  const double tol = 1e-4;
+
+  // the same outputs at the requested times and the same events
+  CHECK(on.t.size() == 11 && off.t.size() == 11);
+  CHECK(on.t == off.t);
+  CHECK(on.u.rows() == off.u.rows() && on.u.cols() == off.u.cols());
+  for (int i = 0; i < on.u.rows(); i++)
+    for (int j = 0; j < on.u.cols(); j++)
+      CHECK_CLOSE(on.u(i, j), off.u(i, j), tol);
+  CHECK(on.eventsT.size() == 2 && off.eventsT.size() == 2);
+  CHECK(on.eventsIndex == off.eventsIndex);
+  for (int i = 0; i < on.eventsT.size() && i < off.eventsT.size(); i++)
+    CHECK_CLOSE(on.eventsT(i), off.eventsT(i), tol);
+  // the exact event times are log(2)/pi^2 and log(4)/pi^2
+  if (on.eventsT.size() == 2) {
+    CHECK_CLOSE(on.eventsT(0), std::log(2.) / (pi*pi), 1e-3);
+    CHECK_CLOSE(on.eventsT(1), std::log(4.) / (pi*pi), 1e-3);
+  }
+
+  // the history evaluated at the output times reproduces the solution
+  // that the integrator interpolated at those times
+  CHECK(on.history.numSteps() > 0);
+  CHECK_CLOSE(on.history.startTime(), 0, 1e-12);
+  CHECK_CLOSE(on.history.endTime(), .2, 1e-12);
+  RealMatrix y, yDot;
+  on.history.eval(on.t, y, &yDot);
+  for (int j = 0; j < on.t.size(); j++)
+    for (int i = 0; i < on.coeffs.rows(); i++)
+      CHECK_CLOSE(y(i, j), on.coeffs(i, j), 1e-10);
+
+  return testResult();
+}
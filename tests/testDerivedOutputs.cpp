@@ -0,0 +1,133 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the DuDx, flux, and integral outputs calculated by
+ * PDESolution with solutions that are linear in x.
+ */
+
+#include "PDESolution.h"
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDEModel.h"
+#include "ShapeFunctionManager.h"
+#include "PDE1dException.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  // u_t = (2*u_x)_x in cartesian or cylindrical coordinates; the
+  // initial u = 1 + 3*x satisfies the equation and the boundary
+  // conditions so it is the solution at all times when m = 0
+  class LinearDefn : public PDE1dTestDefn {
+  public:
+    LinearDefn(int m) : PDE1dTestDefn(1, 5, 1, 4), m(m) {}
+    virtual int getCoordSystem() const { return m; }
+    virtual void evalIC(double x, RealVector &ic) { ic(0) = 1 + 3*x; }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0) - 1;
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0) - 4;
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = 2*DuDx(0);
+      pde.s(0) = 0;
+    }
+  private:
+    int m;
+  };
+
+  // u at the mesh nodes at time t is (1 + t)*(1 + 3*x); the
+  // hierarchical coefficients are zero
+  RealVector linearSolution(const RealVector &mesh, const PDEModel &model,
+    double t)
+  {
+    RealVector u = RealVector::Zero(model.numNodesFEEqns());
+    int node = 0;
+    for (int i = 0; i < mesh.size(); i++) {
+      u(node) = (1 + t)*(1 + 3*mesh(i));
+      if (i < mesh.size() - 1)
+        node += model.element(i).numNodes() - 1;
+    }
+    return u;
+  }
+
+}
+
+int main()
+{
+  const double tol = 1e-12;
+  const int flags = PDE1dOptions::DerivedDuDx |
+    PDE1dOptions::DerivedIntegrals;
+
+  // gradients and integrals stored by PDESolution, with and without the
+  // output thread and at output points that are not mesh points
+  for (int m = 0; m <= 1; m++) {
+    for (int thread = 0; thread <= 1; thread++) {
+      LinearDefn pde(m);
+      ShapeFunctionManager sfm;
+      PDEModel model(pde.getMesh(), 2, 1, sfm);
+      PDESolution sol(pde, model, 1, { 0, .33, .5, 1 });
+      sol.setDerivedOutputs(flags);
+      sol.setOutputThread(thread != 0);
+      const RealVector &t = pde.getTimeSpan();
+      for (int j = 0; j < t.size(); j++)
+        sol.setSolutionVector(j, t(j),
+          linearSolution(pde.getMesh(), model, t(j)));
+      sol.close();
+      const RealMatrix &dudx = sol.getDuDx(), &integ = sol.getIntegrals();
+      CHECK(dudx.rows() == 4 && dudx.cols() == t.size());
+      CHECK(integ.rows() == 1 && integ.cols() == t.size());
+      CHECK(sol.getFlux().size() == 0);
+      for (int j = 0; j < t.size(); j++) {
+        for (int i = 0; i < 4; i++)
+          CHECK_CLOSE(dudx(i, j), 3*(1 + t(j)), tol);
+        // integral of x^m*(1 + 3*x) over [0, 1]
+        double exact = m == 0 ? 2.5 : 1.5;
+        CHECK_CLOSE(integ(0, j), (1 + t(j))*exact, tol);
+      }
+    }
+  }
+
+  // the flux from the pde coefficients during a solution
+  {
+    LinearDefn pde(0);
+    PDE1dOptions opts;
+    opts.setDerivedOutputs(flags | PDE1dOptions::DerivedFlux);
+    PDE1dImpl impl(pde, opts);
+    PDESolution sol(pde, impl.getModel(), 2);
+    sol.setDerivedOutputs(opts.getDerivedOutputs());
+    impl.solveTransient(sol);
+    const RealMatrix &flux = sol.getFlux(), &dudx = sol.getDuDx();
+    CHECK(flux.rows() == sol.numSpatialPoints());
+    CHECK(flux.cols() == sol.numTimePoints());
+    for (int j = 0; j < flux.cols(); j++) {
+      for (int i = 0; i < flux.rows(); i++) {
+        CHECK_CLOSE(dudx(i, j), 3, 1e-6);
+        CHECK_CLOSE(flux(i, j), 6, 1e-6);
+      }
+      CHECK_CLOSE(sol.getIntegrals()(0, j), 2.5, 1e-6);
+    }
+  }
+
+  return testResult();
+}
@@ -0,0 +1,138 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the output placed where the solution changes by
+ * OutputChangeTol rather than at the times in tspan.
+ */
+
+#include <cmath>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  // u_t = u_xx, u(x,0) = sin(pi*x), u(0) = u(1) = 0, optionally with a
+  // terminal event when u at the center falls to 1/2
+  class DecayDefn : public PDE1dTestDefn {
+  public:
+    DecayDefn(bool terminal) : PDE1dTestDefn(1, 20, .5, 3),
+      terminal(terminal) {}
+    virtual void evalIC(double x, RealVector &ic) {
+      ic(0) = std::sin(pi*x);
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0);
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = 0;
+    }
+    virtual int getNumEvents() const { return terminal ? 1 : 0; }
+    virtual void evalEvents(double t, const RealMatrix &u,
+      RealVector &eventsVal, RealVector &eventsIsTerminal,
+      RealVector &eventsDirection) {
+      eventsVal(0) = u(0, u.cols() / 2) - .5;
+      eventsIsTerminal(0) = 1;
+      eventsDirection(0) = -1;
+    }
+  private:
+    bool terminal;
+  };
+
+  double change(const RealMatrix &coeffs, int j,
+    PDE1dOptions::ChangeNorm norm)
+  {
+    RealVector d = coeffs.col(j) - coeffs.col(j - 1);
+    if (norm == PDE1dOptions::RMSChangeNorm)
+      return d.norm() / std::sqrt((double)d.size());
+    return d.lpNorm<Eigen::Infinity>();
+  }
+
+  void testChanges(PDE1dOptions::ChangeNorm norm, bool terminal)
+  {
+    const double tol = .05;
+    DecayDefn pde(terminal);
+    PDE1dOptions opts;
+    opts.setRelTol(1e-6);
+    opts.setAbsTol(1e-8);
+    opts.setOutputChangeTol(tol);
+    opts.setOutputChangeNorm(norm);
+    PDE1dImpl pdeImpl(pde, opts);
+    PDESolution sol(pde, pdeImpl.getModel(), 1);
+    sol.setStoreCoefficients(true);
+    pdeImpl.solveTransient(sol);
+    const RealVector &t = sol.getOutputTimes();
+    const RealMatrix &coeffs = sol.getCoefficients();
+    const int nt = sol.numTimePoints();
+    CHECK(nt > 3);
+    CHECK(coeffs.cols() == nt);
+    if (nt < 2 || coeffs.cols() != nt)
+      return;
+    CHECK(t(0) == 0);
+    // successive outputs differ by at most the tolerance and, except
+    // for the last one, are placed where the change reaches it
+    for (int j = 1; j < nt; j++) {
+      CHECK(t(j) > t(j - 1));
+      double d = change(coeffs, j, norm);
+      CHECK(d <= tol);
+      if (j < nt - 1)
+        CHECK(d > .99*tol);
+    }
+
+    if (!terminal) {
+      // the final time is always output
+      CHECK(t(nt - 1) == .5);
+      CHECK(sol.getEventsTimes().size() == 0);
+      return;
+    }
+    // the output ends at the terminal event, log(2)/pi^2, with the
+    // solution found there
+    const RealVector &eventsT = sol.getEventsTimes();
+    CHECK(eventsT.size() == 1);
+    if (eventsT.size() != 1)
+      return;
+    CHECK_CLOSE(eventsT(0), std::log(2.) / (pi*pi), 1e-3);
+    CHECK(t(nt - 1) == eventsT(0));
+    const RealMatrix &eventsU = sol.getEventsSolution();
+    for (int i = 0; i < coeffs.rows(); i++)
+      CHECK(eventsU(0, i) == coeffs(i, nt - 1));
+  }
+
+}
+
+int main()
+{
+  for (auto norm : { PDE1dOptions::MaxChangeNorm,
+    PDE1dOptions::RMSChangeNorm }) {
+    testChanges(norm, false);
+    testChanges(norm, true);
+  }
+  return testResult();
+}
@@ -0,0 +1,130 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests that the solution processed in the output thread is identical
+ * to the one processed by the integrator thread, including the ODE
+ * variables and the events.
+ */
+
+#include <cmath>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  // u_t = u_xx, u(x,0) = sin(pi*x), u(0) = u(1) = 0 with an ODE
+  // v' = u(1/2,t) and events when u(1/2,t) falls to .8 and, terminating
+  // the solution, to .5
+  class DecayODEDefn : public PDE1dTestDefn {
+  public:
+    DecayODEDefn() : PDE1dTestDefn(1, 20, .5, 41, 1, 1, 1) {
+      odeMesh(0) = .5;
+    }
+    virtual void evalIC(double x, RealVector &ic) {
+      ic(0) = std::sin(pi*x);
+    }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0);
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = 0;
+    }
+    virtual void evalODE(double t, const RealVector &v,
+      const RealVector &vdot,
+      const RealMatrix &u, const RealMatrix &DuDx,
+      const RealMatrix &odeR, const RealMatrix &odeDuDt,
+      const RealMatrix &odeDuDxDt, RealVector &f) {
+      f(0) = vdot(0) - u(0, 0);
+    }
+    virtual int getNumEvents() const { return 2; }
+    virtual void evalEvents(double t, const RealMatrix &u,
+      RealVector &eventsVal, RealVector &eventsIsTerminal,
+      RealVector &eventsDirection) {
+      const double uc = u(0, u.cols() / 2);
+      eventsVal(0) = uc - .8;
+      eventsVal(1) = uc - .5;
+      eventsIsTerminal(0) = 0;
+      eventsIsTerminal(1) = 1;
+      eventsDirection.setConstant(-1);
+    }
+  };
+
+  struct Result {
+    RealVector t;
+    RealMatrix u, uOde, eventsU;
+    RealVector eventsT;
+    IntVector eventsIndex;
+  };
+
+  Result solve(bool useThread)
+  {
+    DecayODEDefn pde;
+    PDE1dOptions opts;
+    opts.setRelTol(1e-6);
+    opts.setAbsTol(1e-8);
+    PDE1dImpl pdeImpl(pde, opts);
+    PDESolution sol(pde, pdeImpl.getModel(), 1);
+    // a short queue so the integrator also waits for the output thread
+    sol.setOutputThread(useThread, 2);
+    pdeImpl.solveTransient(sol);
+    Result r;
+    r.t = sol.getOutputTimes();
+    r.u = sol.getSolution();
+    r.uOde = sol.uOde;
+    r.eventsU = sol.getEventsSolution();
+    r.eventsT = sol.getEventsTimes();
+    r.eventsIndex = sol.getEventsIndex();
+    return r;
+  }
+
+  template<class T>
+  bool equal(const T &a, const T &b)
+  {
+    return a.rows() == b.rows() && a.cols() == b.cols() && a == b;
+  }
+
+}
+
+int main()
+{
+  Result r = solve(false), rt = solve(true);
+  // the terminal event at log(2)/pi^2 ends the solution before .5
+  CHECK(r.eventsT.size() == 2);
+  CHECK(r.t.size() > 2 && r.t.size() < 41);
+  CHECK(r.uOde.rows() == r.t.size() && r.uOde.cols() == 1);
+  CHECK(equal(r.t, rt.t));
+  CHECK(equal(r.u, rt.u));
+  CHECK(equal(r.uOde, rt.uOde));
+  CHECK(equal(r.eventsU, rt.eventsU));
+  CHECK(equal(r.eventsT, rt.eventsT));
+  CHECK(equal(r.eventsIndex, rt.eventsIndex));
+  return testResult();
+}
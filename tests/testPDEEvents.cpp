@@ -0,0 +1,112 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the events evaluation in PDEEvents.h: the solution passed to
+ * the events function at a subset of the mesh points and the reuse of
+ * the values for the same time and solution.
+ */
+
+#include "PDEEvents.h"
+#include "PDEModel.h"
+#include "ShapeFunctionManager.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  // one events function of two PDE that records its arguments
+  class EventsDefn : public PDE1dTestDefn {
+  public:
+    EventsDefn() : PDE1dTestDefn(1, 4, 1, 2, 2), numCalls(0) {}
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {}
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {}
+    virtual int getNumEvents() const { return 1; }
+    virtual void evalEvents(double t, const RealMatrix &u,
+      RealVector &eventsVal, RealVector &eventsIsTerminal,
+      RealVector &eventsDirection) {
+      numCalls++;
+      lastU = u;
+      eventsVal(0) = u.sum() - t;
+      eventsIsTerminal(0) = 1;
+      eventsDirection(0) = 0;
+    }
+    int numCalls;
+    RealMatrix lastU;
+  };
+
+}
+
+int main()
+{
+  for (int polyOrder = 1; polyOrder <= 3; polyOrder++) {
+    EventsDefn pde;
+    PDE1dOptions opts;
+    opts.setEventsMeshPoints({ 4, 1, 2 });
+    pde.applyEventsMeshPoints(opts);
+    ShapeFunctionManager sfm;
+    PDEModel model(pde.getMesh(), polyOrder, pde.getNumPDE(), sfm);
+    PDEEvents events(pde, model);
+    RealVector u = RealVector::Random(pde.getNumPDE()*
+      model.numNodesFEEqns());
+    RealMatrix uMesh(pde.getNumPDE(), pde.getMesh().size());
+    model.globalToMeshVec(u, uMesh);
+
+    // the solution at the chosen mesh points, in their order
+    double g;
+    events.calcEvents(.5, u, &g);
+    CHECK(pde.numCalls == 1);
+    CHECK(pde.lastU.cols() == 3);
+    CHECK(pde.lastU.col(0) == uMesh.col(4));
+    CHECK(pde.lastU.col(1) == uMesh.col(1));
+    CHECK(pde.lastU.col(2) == uMesh.col(2));
+    CHECK_CLOSE(g, pde.lastU.sum() - .5, 1e-14);
+
+    // the terminal test at the root reuses the values
+    IntVector found(1);
+    found(0) = 1;
+    CHECK(events.isTerminalEvent(.5, u, found));
+    CHECK(pde.numCalls == 1);
+
+    // a different time or solution at the chosen points calls the
+    // function again; the solution at other points is not compared
+    events.calcEvents(.6, u, &g);
+    CHECK(pde.numCalls == 2);
+    u(0) += 1;
+    events.calcEvents(.6, u, &g);
+    CHECK(pde.numCalls == 2);
+    u.setRandom();
+    events.calcEvents(.6, u, &g);
+    CHECK(pde.numCalls == 3);
+  }
+
+  // an empty option keeps the points set with the problem
+  {
+    EventsDefn pde;
+    pde.setEventsMeshPoints({ 0, 3 });
+    pde.applyEventsMeshPoints(PDE1dOptions());
+    CHECK(pde.getEventsMeshPoints().size() == 2);
+    CHECK_THROWS(pde.setEventsMeshPoints({ 5 }));
+    CHECK_THROWS(pde.setEventsMeshPoints({ -1 }));
+  }
+
+  return testResult();
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the expression parser and evaluator in PDEExpression.h.
+ */
+
+#include <string>
+
+#include "PDEExpression.h"
+#include "PDE1dException.h"
+#include "TestCheck.h"
+
+namespace {
+
+  // value of an expression of the variables x and u at one point
+  double evalAt(const std::string &expr, double x = 0, double u = 0)
+  {
+    PDEExpression::VarMap vars;
+    vars["x"] = 0;
+    vars["u"] = 1;
+    PDEExpression::ParamMap params;
+    params["k"] = 3;
+    PDEExpression e(expr, vars, params);
+    PDEExpression::Var v[] = { { &x, 0 }, { &u, 0 } };
+    double out;
+    e.eval(v, 1, &out);
+    return out;
+  }
+
+}
+
+int main()
+{
+  const double tol = 1e-14;
+
+  // precedence
+  CHECK_CLOSE(evalAt("1+2*3"), 7, tol);
+  CHECK_CLOSE(evalAt("(1+2)*3"), 9, tol);
+  CHECK_CLOSE(evalAt("2*3^2"), 18, tol);
+  CHECK_CLOSE(evalAt("1+2 < 4"), 1, tol);
+  CHECK_CLOSE(evalAt("2*3 == 6"), 1, tol);
+  CHECK_CLOSE(evalAt("1 ~= 1"), 0, tol);
+
+  // associativity; all binary operators are left associative in MATLAB
+  CHECK_CLOSE(evalAt("2^3^2"), 64, tol);
+  CHECK_CLOSE(evalAt("2.^3.^2"), 64, tol);
+  CHECK_CLOSE(evalAt("8/2/2"), 2, tol);
+  CHECK_CLOSE(evalAt("5-2-1"), 2, tol);
+
+  // unary minus binds less tightly than ^ on its left but may be the
+  // sign of an exponent
+  CHECK_CLOSE(evalAt("-2^2"), -4, tol);
+  CHECK_CLOSE(evalAt("2^-1"), .5, tol);
+  CHECK_CLOSE(evalAt("2^-2^2"), .0625, tol);
+  CHECK_CLOSE(evalAt("--3"), 3, tol);
+  CHECK_CLOSE(evalAt("-x*u", 2, 5), -10, tol);
+  CHECK_CLOSE(evalAt("3 - -2"), 5, tol);
+
+  // variables, parameters, constants, and functions
+  CHECK_CLOSE(evalAt("k*x + u", 2, 1), 7, tol);
+  CHECK_CLOSE(evalAt("cos(pi)"), -1, tol);
+  CHECK_CLOSE(evalAt("log(e)"), 1, tol);
+  CHECK_CLOSE(evalAt("max(x, u) + atan2(0, 1)", 2, 5), 5, tol);
+
+  // evaluation at several points with strided and constant variables
+  {
+    PDEExpression::VarMap vars;
+    vars["x"] = 0;
+    vars["u"] = 1;
+    PDEExpression e("x.^2 + u", vars, PDEExpression::ParamMap());
+    double x[] = { 1, 9, 2, 9, 3, 9 }, u = 10, out[3];
+    PDEExpression::Var v[] = { { x, 2 }, { &u, 0 } };
+    e.eval(v, 3, out);
+    CHECK_CLOSE(out[0], 11, tol);
+    CHECK_CLOSE(out[1], 14, tol);
+    CHECK_CLOSE(out[2], 19, tol);
+  }
+
+  // syntax errors
+  CHECK_THROWS(evalAt("1+"));
+  CHECK_THROWS(evalAt("(1+2"));
+  CHECK_THROWS(evalAt("1 2"));
+  CHECK_THROWS(evalAt("2^"));
+  CHECK_THROWS(evalAt("y + 1"));
+  CHECK_THROWS(evalAt("foo(1)"));
+  CHECK_THROWS(evalAt("atan2(1)"));
+  CHECK_THROWS(evalAt(""));
+
+  return testResult();
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the sparse interpolation and integration operators in
+ * PDEOutputOperator.h with finite element solutions that represent
+ * linear functions exactly.
+ */
+
+#include "PDEOutputOperator.h"
+#include "PDEModel.h"
+#include "ShapeFunctionManager.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const int numPDE = 2;
+  // u_k = a_k + b_k*x
+  const double a[numPDE] = { 1, -2 }, b[numPDE] = { 3, .5 };
+
+  // coefficients of the linear functions; the higher-order hierarchical
+  // coefficients are zero
+  RealVector linearSolution(const RealVector &mesh, const PDEModel &model)
+  {
+    RealMatrix u = RealMatrix::Zero(numPDE, model.numNodesFEEqns());
+    int node = 0;
+    for (int i = 0; i < mesh.size(); i++) {
+      for (int k = 0; k < numPDE; k++)
+        u(k, node) = a[k] + b[k]*mesh(i);
+      if (i < mesh.size() - 1)
+        node += model.element(i).numNodes() - 1;
+    }
+    return Eigen::Map<RealVector>(u.data(), u.size());
+  }
+
+}
+
+int main()
+{
+  const double tol = 1e-13;
+  RealVector mesh(5);
+  mesh << 0, .1, .35, .7, 1;
+  RealVector xOut(6);
+  xOut << 0, .05, .35, .5, .99, 1;
+  for (int polyOrder = 1; polyOrder <= 3; polyOrder++) {
+    ShapeFunctionManager sfm;
+    PDEModel model(mesh, polyOrder, numPDE, sfm);
+    RealVector uFE = linearSolution(mesh, model);
+
+    // values and derivatives at points inside elements, at mesh points,
+    // and at the ends
+    PDEOutputOperator interp(mesh, model, numPDE, xOut);
+    PDEOutputOperator deriv(mesh, model, numPDE, xOut, true);
+    CHECK(interp.matrix().rows() == numPDE*xOut.size());
+    CHECK(interp.matrix().cols() == (int)uFE.size());
+    RealVector uOut(numPDE*xOut.size()), duOut(numPDE*xOut.size());
+    interp.apply(uFE, uOut);
+    deriv.apply(uFE, duOut);
+    for (int j = 0; j < xOut.size(); j++) {
+      for (int k = 0; k < numPDE; k++) {
+        CHECK_CLOSE(uOut(j*numPDE + k), a[k] + b[k]*xOut(j), tol);
+        CHECK_CLOSE(duOut(j*numPDE + k), b[k], tol);
+      }
+    }
+    // each value depends only on the coefficients of one element
+    CHECK(interp.matrix().nonZeros() <= numPDE*xOut.size()*(polyOrder + 1));
+
+    // integrals of u and x*u over [0, 1]
+    RealVector integ(numPDE);
+    PDEOutputOperator::integrals(mesh, model, numPDE, 0).apply(uFE, integ);
+    for (int k = 0; k < numPDE; k++)
+      CHECK_CLOSE(integ(k), a[k] + b[k] / 2, tol);
+    PDEOutputOperator::integrals(mesh, model, numPDE, 1).apply(uFE, integ);
+    for (int k = 0; k < numPDE; k++)
+      CHECK_CLOSE(integ(k), a[k] / 2 + b[k] / 3, tol);
+  }
+
+  return testResult();
+}
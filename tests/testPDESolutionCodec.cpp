@@ -0,0 +1,190 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Round trips of rows through the encodings in PDESolutionCodec.h.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "PDESolutionCodec.h"
+#include "PDE1dException.h"
+#include "TestCheck.h"
+
+namespace {
+
+  typedef std::vector<double> Row;
+  typedef std::vector<unsigned char> Bytes;
+
+  // smoothly varying rows with some exact zeros and repeated values
+  std::vector<Row> makeRows(size_t numRows, size_t n)
+  {
+    std::vector<Row> rows(numRows, Row(n));
+    for (size_t j = 0; j < numRows; j++)
+      for (size_t i = 0; i < n; i++)
+        rows[j][i] = i % 7 == 0 ? 0 : i % 5 == 0 ? 1.5 :
+          std::sin(.1*i + .05*j)*std::exp(-.01*j) * 100;
+    return rows;
+  }
+
+  // encode the rows as a writer does, restarting the sequence every
+  // keyInterval rows, and return the encoded rows
+  std::vector<Bytes> encodeRows(PDESolutionCodec &codec,
+    const std::vector<Row> &rows)
+  {
+    std::vector<Bytes> enc(rows.size());
+    for (size_t j = 0; j < rows.size(); j++) {
+      if (j % PDESolutionCodec::keyInterval == 0)
+        codec.reset();
+      codec.encode(rows[j].data(), enc[j]);
+    }
+    return enc;
+  }
+
+  // decode rows first to last with a new codec starting at a key row;
+  // returns the largest error
+  double decodeRows(PDESolutionCodec &codec, const std::vector<Bytes> &enc,
+    const std::vector<Row> &rows, size_t first, size_t last)
+  {
+    const size_t n = rows[0].size();
+    Row row(n);
+    double maxErr = 0;
+    for (size_t j = first; j <= last; j++) {
+      if (j % PDESolutionCodec::keyInterval == 0)
+        codec.reset();
+      codec.decode(enc[j].data(), enc[j].size(), row.data());
+      for (size_t i = 0; i < n; i++)
+        maxErr = std::max(maxErr, std::abs(row[i] - rows[j][i]));
+    }
+    return maxErr;
+  }
+
+  void roundTrip(PDESolutionCodec::Precision prec, double quantTol,
+    bool compress, double tol)
+  {
+    const size_t n = 300, numRows = 100;
+    std::vector<Row> rows = makeRows(numRows, n);
+    PDESolutionCodec enc(n, prec, quantTol, compress);
+    std::vector<Bytes> bytes = encodeRows(enc, rows);
+    // from the start and from the key rows of the second and third
+    // sequences, where the preceding rows are not decoded
+    PDESolutionCodec dec(n, prec, quantTol, compress);
+    CHECK(decodeRows(dec, bytes, rows, 0, numRows - 1) <= tol);
+    size_t k = PDESolutionCodec::keyInterval;
+    PDESolutionCodec dec2(n, prec, quantTol, compress);
+    CHECK(decodeRows(dec2, bytes, rows, k, 2*k + 5) <= tol);
+    PDESolutionCodec dec3(n, prec, quantTol, compress);
+    CHECK(decodeRows(dec3, bytes, rows, 2*k, numRows - 1) <= tol);
+    if (compress) {
+      // rows after the first of a sequence are much smaller
+      CHECK(bytes[1].size() < bytes[0].size());
+    }
+    else {
+      const size_t wordSize = prec == PDESolutionCodec::Double ? 8 : 4;
+      for (const Bytes &b : bytes)
+        CHECK(b.size() == n*wordSize);
+    }
+  }
+
+}
+
+int main()
+{
+  using C = PDESolutionCodec;
+  for (bool compress : { false, true }) {
+    roundTrip(C::Double, 0, compress, 0);
+    // float32 rounding of values of magnitude up to 100
+    roundTrip(C::Single, 0, compress, 100 * 6e-8);
+    roundTrip(C::Quantized, 1e-4, compress, 1e-4*(1 + 1e-12));
+  }
+  CHECK(C(10).isIdentity());
+  CHECK(!C(10, C::Double, 0, true).isIdentity());
+
+  // runs of zeros longer than a single length byte, and rows that are
+  // the same as the previous one
+  for (C::Precision prec : { C::Double, C::Single, C::Quantized }) {
+    const size_t n = 5000;
+    Row zero(n, 0.), row(n);
+    C enc(n, prec, .5, true), dec(n, prec, .5, true);
+    Bytes b0, b1;
+    enc.encode(zero.data(), b0);
+    enc.encode(zero.data(), b1);
+    CHECK(b0.size() <= 4 && b1.size() <= 4);
+    row[0] = 1;
+    dec.decode(b0.data(), b0.size(), row.data());
+    CHECK(row == zero);
+    dec.decode(b1.data(), b1.size(), row.data());
+    CHECK(row == zero);
+  }
+
+  // the range of the quantized values is that of int32
+  {
+    const double tol = .5, vmax = 2147483647.;
+    Row r = { vmax, -vmax, 0, 1, -1 }, d(5);
+    for (bool compress : { false, true }) {
+      C enc(5, C::Quantized, tol, compress), dec(5, C::Quantized, tol,
+        compress);
+      Bytes b;
+      enc.encode(r.data(), b);
+      dec.decode(b.data(), b.size(), d.data());
+      CHECK(d == r);
+      // a second row with the largest differences in both directions
+      Row r2 = { -vmax, vmax, vmax, -vmax, 0 };
+      b.clear();
+      enc.encode(r2.data(), b);
+      dec.decode(b.data(), b.size(), d.data());
+      CHECK(d == r2);
+    }
+    C enc(1, C::Quantized, tol, false);
+    Bytes b;
+    double big = vmax + 1;
+    CHECK_THROWS(enc.encode(&big, b));
+    big = -vmax - 1;
+    CHECK_THROWS(enc.encode(&big, b));
+    // nor can values that are not finite
+    for (double bad : { (double)NAN, (double)INFINITY, -(double)INFINITY })
+      CHECK_THROWS(enc.encode(&bad, b));
+    CHECK_THROWS(C(1, C::Quantized, 0, false));
+  }
+
+  // float32 overflow and NaN pass through the single precision encoding
+  {
+    Row r = { 1e300, -1e300, NAN }, d(3);
+    C enc(3, C::Single, 0, true), dec(3, C::Single, 0, true);
+    Bytes b;
+    enc.encode(r.data(), b);
+    dec.decode(b.data(), b.size(), d.data());
+    CHECK(std::isinf(d[0]) && d[0] > 0);
+    CHECK(std::isinf(d[1]) && d[1] < 0);
+    CHECK(std::isnan(d[2]));
+  }
+
+  // truncated or extra bytes are reported
+  {
+    Row r = makeRows(1, 50)[0], d(50);
+    for (bool compress : { false, true }) {
+      C enc(50, C::Double, 0, compress), dec(50, C::Double, 0, compress);
+      Bytes b;
+      enc.encode(r.data(), b);
+      CHECK_THROWS(dec.decode(b.data(), b.size() - 1, d.data()));
+      dec.reset();
+      b.push_back(7);
+      CHECK_THROWS(dec.decode(b.data(), b.size(), d.data()));
+    }
+  }
+
+  return testResult();
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Solutions written with PDESolutionFile and read back with the memory
+ * mapped PDESolutionReader.
+ */
+
+#include <stdio.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "PDESolutionFile.h"
+#include "PDE1dException.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const int numPDE = 2, numODE = 1, numPts = 7, numTimes = 75;
+
+  double uVal(int j, int i) { return std::cos(.3*i + .1*j) + j; }
+
+  // write the test solution with the codec and compare the values read
+  // back, within tol, in order and in reverse order
+  void roundTrip(const std::string &fileName, const PDESolutionCodec &codec,
+    double tol)
+  {
+    const int numU = numPDE*numPts;
+    RealVector x(numPts);
+    for (int i = 0; i < numPts; i++)
+      x(i) = i*i / 36.;
+    std::vector<double> u(numU);
+    {
+      PDESolutionFile file(fileName, x, numPDE, numODE, codec);
+      for (int j = 0; j < numTimes; j++) {
+        for (int i = 0; i < numU; i++)
+          u[i] = uVal(j, i);
+        double v = 10. * j;
+        file.append(.01*j, u.data(), &v);
+        if (j == 20)
+          file.appendEvent(.205, 1, u.data());
+      }
+      file.close();
+    }
+    PDESolutionReader r(fileName);
+    CHECK(r.numPDE() == numPDE);
+    CHECK(r.numODE() == numODE);
+    CHECK(r.numPts() == (size_t)numPts);
+    CHECK(r.numTimes() == (size_t)numTimes);
+    for (int i = 0; i < numPts; i++)
+      CHECK(r.x()[i] == x(i));
+    double maxErr = 0;
+    for (int k = 0; k < 2*numTimes; k++) {
+      // forward, then backward across the key rows
+      int j = k < numTimes ? k : 2*numTimes - 1 - k;
+      CHECK(r.time(j) == .01*j);
+      CHECK(r.v(j)[0] == 10. * j);
+      r.u(j, u.data());
+      for (int i = 0; i < numU; i++)
+        maxErr = std::max(maxErr, std::abs(u[i] - uVal(j, i)));
+    }
+    CHECK(maxErr <= tol);
+    CHECK(r.numEvents() == 1);
+    if (r.numEvents() == 1) {
+      CHECK(r.eventTime(0) == .205);
+      CHECK(r.eventIndex(0) == 1);
+      for (int i = 0; i < numU; i++)
+        CHECK(r.eventU(0)[i] == uVal(20, i));
+    }
+  }
+
+}
+
+int main()
+{
+  const std::string fileName = "testPDESolutionFile.sol";
+  typedef PDESolutionCodec C;
+  roundTrip(fileName, C(), 0);
+  roundTrip(fileName, C(0, C::Double, 0, true), 0);
+  // float32 rounding of values up to 75
+  roundTrip(fileName, C(0, C::Single, 0, true), 75 * 6e-8);
+  roundTrip(fileName, C(0, C::Quantized, 1e-5, true), 1e-5*(1 + 1e-10));
+
+  // files that are missing or not solution files
+  CHECK_THROWS(PDESolutionReader("testPDESolutionFile.missing"));
+  FILE *fp = fopen(fileName.c_str(), "wb");
+  fputs("not a solution file", fp);
+  fclose(fp);
+  CHECK_THROWS(PDESolutionReader r(fileName));
+  remove(fileName.c_str());
+
+  return testResult();
+}
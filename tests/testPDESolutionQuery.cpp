@@ -0,0 +1,165 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of PDESolutionQuery evaluating a solution from the stored
+ * coefficients and from the integrator history.
+ */
+
+#include <vector>
+
+#include "PDESolutionQuery.h"
+#include "PDEDenseOutput.h"
+#include "PDEModel.h"
+#include "ShapeFunctionManager.h"
+#include "PDE1dException.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const int numPDE = 2, polyOrder = 2;
+
+  // u_k(x, t) = p_k(t) + q_k(t)*x; the coefficients for the mesh are
+  // p_k at the nodes and q_k times the node x, with zero hierarchical
+  // coefficients
+  struct Linear {
+    virtual double p(int k, double t) const = 0;
+    virtual double q(int k, double t) const = 0;
+    virtual double pDot(int k, double t) const = 0;
+    virtual double qDot(int k, double t) const = 0;
+    double u(int k, double x, double t) const { return p(k, t) + q(k, t)*x; }
+  };
+
+  struct LinearInT : Linear {
+    double p(int k, double t) const { return 1 + k + 2*t; }
+    double q(int k, double t) const { return k - 3*t; }
+    double pDot(int k, double t) const { return 2; }
+    double qDot(int k, double t) const { return -3; }
+  };
+
+  struct QuadraticInT : Linear {
+    double p(int k, double t) const { return k + t*t; }
+    double q(int k, double t) const { return 1 - k*t*t; }
+    double pDot(int k, double t) const { return 2*t; }
+    double qDot(int k, double t) const { return -2*k*t; }
+  };
+
+  // coefficients, or their time derivatives, at time t
+  RealVector coeffs(const RealVector &mesh, const PDEModel &model,
+    const Linear &f, double t, bool deriv = false)
+  {
+    RealMatrix c = RealMatrix::Zero(numPDE, model.numNodesFEEqns());
+    int node = 0;
+    for (int i = 0; i < mesh.size(); i++) {
+      for (int k = 0; k < numPDE; k++)
+        c(k, node) = deriv ? f.pDot(k, t) + f.qDot(k, t)*mesh(i) :
+          f.u(k, mesh(i), t);
+      if (i < mesh.size() - 1)
+        node += model.element(i).numNodes() - 1;
+    }
+    return Eigen::Map<RealVector>(c.data(), c.size());
+  }
+
+  void checkValues(const PDESolutionQuery &query, const Linear &f,
+    const RealVector &xq, const RealVector &tq)
+  {
+    RealMatrix u, dudx;
+    query.eval(xq, tq, u, dudx);
+    CHECK(u.rows() == numPDE*xq.size() && u.cols() == tq.size());
+    for (int j = 0; j < tq.size(); j++)
+      for (int i = 0; i < xq.size(); i++)
+        for (int k = 0; k < numPDE; k++) {
+          CHECK_CLOSE(u(i*numPDE + k, j), f.u(k, xq(i), tq(j)), 1e-13);
+          CHECK_CLOSE(dudx(i*numPDE + k, j), f.q(k, tq(j)), 1e-13);
+        }
+  }
+
+}
+
+int main()
+{
+  RealVector mesh(4), xq(4), tq(4);
+  mesh << 0, .2, .6, 1;
+  xq << 0, .1, .6, .95;
+  ShapeFunctionManager sfm;
+  PDEModel model(mesh, polyOrder, numPDE, sfm);
+  const int numFE = numPDE*(int)model.numNodesFEEqns();
+
+  // linear interpolation of the coefficients between output times is
+  // exact for a solution that is linear in time
+  {
+    LinearInT f;
+    RealVector t(3);
+    t << 0, .5, 2;
+    RealMatrix c(numFE, 3), uOde(3, 1);
+    for (int j = 0; j < 3; j++) {
+      c.col(j) = coeffs(mesh, model, f, t(j));
+      uOde(j, 0) = 3*t(j);
+    }
+    PDESolutionQuery query(mesh, polyOrder, numPDE, t, c, uOde);
+    CHECK(query.numODE() == 1);
+    tq << 0, .25, .5, 2;
+    checkValues(query, f, xq, tq);
+    RealVector v, vDot;
+    query.evalODE(1.2, v, vDot);
+    CHECK_CLOSE(v(0), 3.6, 1e-14);
+    CHECK_CLOSE(vDot(0), 3, 1e-14);
+    RealMatrix u, dudx;
+    CHECK_THROWS(query.eval(xq, RealVector::Constant(1, 2.1), u, dudx));
+    CHECK_THROWS(query.eval(xq, RealVector::Constant(1, -.1), u, dudx));
+    CHECK_THROWS(PDESolutionQuery(mesh, polyOrder, numPDE, t,
+      c.topRows(numFE - 1)));
+    CHECK_THROWS(PDESolutionQuery(mesh, polyOrder, numPDE, t,
+      c.leftCols(2)));
+  }
+
+  // the history of second-order steps represents a solution quadratic in
+  // time, and an ODE variable t^2, exactly
+  {
+    QuadraticInT f;
+    PDEDenseOutput history(numFE + 1);
+    const double tn[] = { .1, .3, .8 }, h[] = { .1, .2, .5 };
+    std::vector<double> taylor(3*(numFE + 1));
+    for (int s = 0; s < 3; s++) {
+      const double t = tn[s];
+      Eigen::Map<RealMatrix> c(taylor.data(), numFE + 1, 3);
+      c.col(0).head(numFE) = coeffs(mesh, model, f, t);
+      c.col(1).head(numFE) = coeffs(mesh, model, f, t, true);
+      // c''/2 = c(1) - c(0) - c'(0) for a quadratic
+      c.col(2).head(numFE) = (coeffs(mesh, model, f, 1) -
+        coeffs(mesh, model, f, 0)) - coeffs(mesh, model, f, 0, true);
+      c(numFE, 0) = t*t;
+      c(numFE, 1) = 2*t;
+      c(numFE, 2) = 1;
+      history.addStep(t, h[s], 2, taylor.data());
+    }
+    PDESolutionQuery query(mesh, polyOrder, numPDE, history);
+    CHECK(query.numODE() == 1);
+    tq << 0, .05, .3, .71;
+    checkValues(query, f, xq, tq);
+    RealVector v, vDot;
+    query.evalODE(.45, v, vDot);
+    CHECK_CLOSE(v(0), .45*.45, 1e-14);
+    CHECK_CLOSE(vDot(0), .9, 1e-14);
+    RealMatrix u, dudx;
+    CHECK_THROWS(query.eval(xq, RealVector::Constant(1, .9), u, dudx));
+    PDEDenseOutput small(numFE - 1);
+    std::vector<double> y(numFE - 1);
+    small.addStep(1, 1, 0, y.data());
+    CHECK_THROWS(PDESolutionQuery(mesh, polyOrder, numPDE, small));
+  }
+
+  return testResult();
+}
@@ -0,0 +1,136 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the interpolation and extrapolation in PDETable.h.
+ */
+
+#include <limits>
+
+#include "PDETable.h"
+#include "PDE1dException.h"
+#include "TestCheck.h"
+
+namespace {
+
+  double eval1(const PDETable &t, double x)
+  {
+    double out;
+    t.eval(&x, 1, &out);
+    return out;
+  }
+
+  double eval2(const PDETable &t, double x, double y)
+  {
+    double out;
+    t.eval(&x, &y, 1, &out);
+    return out;
+  }
+
+  RealVector vec(std::initializer_list<double> v)
+  {
+    RealVector r(v.size());
+    int i = 0;
+    for (double vi : v)
+      r(i++) = vi;
+    return r;
+  }
+
+}
+
+int main()
+{
+  const double tol = 1e-14;
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+
+  // linear on uniform and non-uniform grids, including the grid points
+  // and extrapolation by the values at the ends
+  RealVector xu = vec({ 0, 1, 2, 3 }), xn = vec({ 0, .5, 2, 3 });
+  RealVector v = vec({ 1, 3, 2, 6 });
+  for (const RealVector *x : { &xu, &xn }) {
+    PDETable t(*x, v, PDETable::Linear);
+    for (int i = 0; i < 4; i++)
+      CHECK_CLOSE(eval1(t, (*x)(i)), v(i), tol);
+    double xm = ((*x)(1) + (*x)(2)) / 2;
+    CHECK_CLOSE(eval1(t, xm), 2.5, tol);
+    CHECK_CLOSE(eval1(t, -1), 1, tol);
+    CHECK_CLOSE(eval1(t, 10), 6, tol);
+    CHECK_CLOSE(eval1(t, -inf), 1, tol);
+    CHECK_CLOSE(eval1(t, inf), 6, tol);
+    CHECK(std::isnan(eval1(t, nan)));
+  }
+
+  // pchip reproduces a linear function, preserves monotonicity, and
+  // has no overshoot at a local extremum
+  {
+    PDETable t(xn, 2*xn + vec({ 1, 1, 1, 1 }), PDETable::PCHIP);
+    CHECK_CLOSE(eval1(t, 1.3), 3.6, tol);
+    CHECK_CLOSE(eval1(t, 2.7), 6.4, tol);
+    PDETable m(xu, vec({ 0, 0, 1, 1 }), PDETable::PCHIP);
+    double prev = 0;
+    for (int i = 0; i <= 30; i++) {
+      double vi = eval1(m, i*.1);
+      CHECK(vi >= prev - tol && vi <= 1 + tol);
+      prev = vi;
+    }
+    PDETable p(xu, v, PDETable::PCHIP);
+    CHECK(eval1(p, 1.2) <= 3 + tol);
+    CHECK_CLOSE(eval1(p, 5), 6, tol);
+    CHECK(std::isnan(eval1(p, nan)));
+  }
+
+  // bilinear and bicubic tables of a bilinear function
+  {
+    RealVector x = vec({ 0, 1, 3 }), y = vec({ -1, 0, 1, 2 });
+    RealMatrix f(3, 4);
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 4; j++)
+        f(i, j) = 1 + x(i) + 2*y(j) + x(i)*y(j);
+    auto exact = [](double x, double y) { return 1 + x + 2*y + x*y; };
+    PDETable t(x, y, f, PDETable::Linear);
+    CHECK_CLOSE(eval2(t, .5, .5), exact(.5, .5), tol);
+    CHECK_CLOSE(eval2(t, 2, 1.5), exact(2, 1.5), tol);
+    CHECK_CLOSE(eval2(t, -5, 1.5), exact(0, 1.5), tol);
+    CHECK_CLOSE(eval2(t, 2, 9), exact(2, 2), tol);
+    CHECK(std::isnan(eval2(t, nan, 0)));
+    CHECK(std::isnan(eval2(t, 0, nan)));
+    PDETable c(x, y, f, PDETable::PCHIP);
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 4; j++)
+        CHECK_CLOSE(eval2(c, x(i), y(j)), f(i, j), tol);
+    CHECK_CLOSE(eval2(c, 4, -2), exact(3, -1), tol);
+  }
+
+  // evaluation in place at several points
+  {
+    PDETable t(xu, v, PDETable::Linear);
+    double x[] = { .5, 1.5, 2.5 };
+    t.eval(x, 3, x);
+    CHECK_CLOSE(x[0], 2, tol);
+    CHECK_CLOSE(x[1], 2.5, tol);
+    CHECK_CLOSE(x[2], 4, tol);
+  }
+
+  // invalid grids and values
+  CHECK_THROWS(PDETable(vec({ 0 }), vec({ 1 }), PDETable::Linear));
+  CHECK_THROWS(PDETable(vec({ 0, 1, 1 }), vec({ 1, 2, 3 }),
+    PDETable::Linear));
+  CHECK_THROWS(PDETable(vec({ 0, 1 }), vec({ 1, 2, 3 }), PDETable::PCHIP));
+  CHECK_THROWS(PDETable(vec({ 0, 1 }), vec({ 0, 1 }), RealMatrix(2, 3),
+    PDETable::Linear));
+
+  return testResult();
+}
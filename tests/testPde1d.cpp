@@ -9,22 +9,6 @@
 #include "PDEModel.h"
 #include "SunVector.h"
 
-void pdePrintf(const char* format, ...)
-{
-  va_list ap;
-  va_start(ap, format);
-  char msg[4096];
-  vsprintf(msg, format, ap);
-  va_end(ap);
-  // matlab mex connects cout to console but not printf
-  //std::cout << msg;
-  printf(msg);
-}
-
-void PDE1dWarningMsg(const char *id, const char *msg) {
-  printf("Warning: %s, %s\n", id, msg);
-}
-
 int main()
 {
   double L=1, tFinal=.05;
@@ -0,0 +1,97 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the periodic solver with forcing whose periodic response is
+ * known exactly.
+ */
+
+#include <cmath>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDE1dException.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  const double pi = 3.14159265358979323846, w = 2*pi;
+
+  // u_t = u_xx - u + cos(w*t) with zero flux at both ends; the periodic
+  // response, the same at all x, is (cos(w*t) + w*sin(w*t))/(1 + w^2).
+  // It is reached from u = 0 only after several periods.
+  class ForcedDefn : public PDE1dTestDefn {
+  public:
+    ForcedDefn() : PDE1dTestDefn(1, 4, 1, 9) {}
+    virtual void evalIC(double x, RealVector &ic) { ic(0) = 0; }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = 0;
+      bc.ql(0) = 1;
+      bc.pr(0) = 0;
+      bc.qr(0) = 1;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = -u(0) + std::cos(w*t);
+    }
+  };
+
+  double exact(double t)
+  {
+    return (std::cos(w*t) + w*std::sin(w*t)) / (1 + w*w);
+  }
+
+}
+
+int main()
+{
+  ForcedDefn pde;
+  {
+    PDE1dOptions opts;
+    opts.setPeriod(1);
+    opts.setRelTol(1e-6);
+    opts.setAbsTol(1e-8);
+    PDE1dImpl impl(pde, opts);
+    PDESolution sol(pde, impl.getModel(), 1);
+    impl.solvePeriodic(sol);
+    const RealVector &t = sol.getOutputTimes();
+    const RealMatrix &u = sol.getSolution();
+    CHECK(t.size() == 9);
+    for (int j = 0; j < t.size(); j++)
+      for (int i = 0; i < u.cols(); i++)
+        CHECK_CLOSE(u(j, i), exact(t(j)), 1e-4);
+    // the solution at the end of the period is the initial solution
+    for (int i = 0; i < u.cols(); i++)
+      CHECK_CLOSE(u(t.size() - 1, i), u(0, i), 1e-5);
+  }
+
+  // the output times must be within one period
+  {
+    PDE1dOptions opts;
+    opts.setPeriod(.5);
+    PDE1dImpl impl(pde, opts);
+    PDESolution sol(pde, impl.getModel(), 1);
+    CHECK_THROWS(impl.solvePeriodic(sol));
+  }
+
+  return testResult();
+}
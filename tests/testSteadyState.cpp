@@ -0,0 +1,90 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the steady-state solver with a problem whose finite element
+ * solution is exact at the nodes.
+ */
+
+#include <string>
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDESolution.h"
+#include "PDE1dException.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  // u_t = u_xx + 2 + k*(u - x*(1 - x))^3 with u(0) = u(1) = 0 has the
+  // steady solution x*(1 - x); the cubic term makes it nonlinear. The
+  // initial conditions are far from the steady solution.
+  class SteadyDefn : public PDE1dTestDefn {
+  public:
+    SteadyDefn(double k) : PDE1dTestDefn(1, 10, 1, 2), k(k) {}
+    virtual void evalIC(double x, RealVector &ic) { ic(0) = 0; }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0);
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      double d = u(0) - x*(1 - x);
+      pde.c(0) = 1;
+      pde.f(0) = DuDx(0);
+      pde.s(0) = 2 - k*d*d*d;
+    }
+  private:
+    double k;
+  };
+
+}
+
+int main()
+{
+  for (double k : { 0., 10. }) {
+    for (int polyOrder = 1; polyOrder <= 2; polyOrder++) {
+      SteadyDefn pde(k);
+      PDE1dOptions opts;
+      opts.setSteadyState(true);
+      opts.setPolyOrder(polyOrder);
+      PDE1dImpl impl(pde, opts);
+      PDESolution sol(pde, impl.getModel(), 1);
+      try {
+        impl.solveSteadyState(sol);
+      }
+      catch (const PDE1dException &ex) {
+        if (std::string(ex.getId()) == "pde1d:steady_state_unavailable") {
+          printf("%s\n", ex.what());
+          return 0;
+        }
+        throw;
+      }
+      // a single output at the final time
+      CHECK(sol.numTimePoints() == 1);
+      CHECK(sol.getOutputTimes()(0) == 1);
+      const RealVector &x = sol.getX();
+      for (int i = 0; i < x.size(); i++)
+        CHECK_CLOSE(sol.getSolution()(0, i), x(i)*(1 - x(i)), 1e-6);
+    }
+  }
+  return testResult();
+}
@@ -0,0 +1,125 @@
+// Copyright (C) 2016-2017 William H. Greene
+//
+// This program is free software; you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 3 of the License, or (at your option) any later
+// version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// this program; if not, see <http://www.gnu.org/licenses/>.
+
+/*
+ * Tests of the choice between the vectorized and pointwise pde
+ * evaluation when Vectorized is "Auto".
+ */
+
+#include "PDE1dImpl.h"
+#include "PDE1dOptions.h"
+#include "PDE1dException.h"
+#include "PDE1dTestDefn.h"
+#include "TestCheck.h"
+
+namespace {
+
+  // u_t = (a(x, u)*u_x)_x + u*DuDx with a = 1 + x*u
+  class VecDefn : public PDE1dTestDefn {
+  public:
+    enum Mode { Vectorized, FirstColumn, Throws };
+    VecDefn(Mode mode) : PDE1dTestDefn(1, 4, 1, 2), mode(mode) {
+      numVecCalls = 0;
+    }
+    virtual void evalIC(double x, RealVector &ic) { ic(0) = x; }
+    virtual void evalBC(double xl, const RealVector &ul,
+      double xr, const RealVector &ur, double t,
+      const RealVector &v, const RealVector &vDot, BC &bc) {
+      bc.pl(0) = ul(0);
+      bc.ql(0) = 0;
+      bc.pr(0) = ur(0) - 1;
+      bc.qr(0) = 0;
+    }
+    virtual void evalPDE(double x, double t,
+      const RealVector &u, const RealVector &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      pde.c(0) = 1;
+      pde.f(0) = (1 + x*u(0))*DuDx(0);
+      pde.s(0) = u(0)*DuDx(0);
+    }
+    virtual bool hasVectorPDEEval() const { return true; }
+    virtual void evalPDE(const RealVector &x, double t,
+      const RealMatrix &u, const RealMatrix &DuDx,
+      const RealVector &v, const RealVector &vDot, PDECoeff &pde) {
+      numVecCalls++;
+      if (mode == Throws)
+        throw PDE1dException("pde1d:test", "not vectorized");
+      for (int i = 0; i < x.size(); i++) {
+        // a scalar function that accepts vectors by using its first
+        // point and broadcasting the result
+        int k = mode == FirstColumn ? 0 : i;
+        pde.c(0, i) = 1;
+        pde.f(0, i) = (1 + x(k)*u(0, k))*DuDx(0, k);
+        pde.s(0, i) = u(0, k)*DuDx(0, k);
+      }
+    }
+    int numVecCalls;
+  private:
+    Mode mode;
+  };
+
+}
+
+int main()
+{
+  // the probe is opt-in; by default pdeFunc is not called at setup
+  {
+    VecDefn pde(VecDefn::Vectorized);
+    PDE1dOptions opts;
+    CHECK(!opts.isVectorizedAuto());
+    PDE1dImpl impl(pde, opts);
+    CHECK(pde.numVecCalls == 0);
+    CHECK(!opts.isVectorized());
+  }
+
+  // a vectorized function is detected
+  {
+    VecDefn pde(VecDefn::Vectorized);
+    PDE1dOptions opts;
+    opts.setVectorizedAuto();
+    PDE1dImpl impl(pde, opts);
+    CHECK(pde.numVecCalls == 1);
+    CHECK(opts.isVectorized());
+  }
+
+  // a function that only uses its first column is not
+  {
+    VecDefn pde(VecDefn::FirstColumn);
+    PDE1dOptions opts;
+    opts.setVectorizedAuto();
+    PDE1dImpl impl(pde, opts);
+    CHECK(pde.numVecCalls == 1);
+    CHECK(!opts.isVectorized());
+  }
+
+  // nor is one that fails when called with vectors
+  {
+    VecDefn pde(VecDefn::Throws);
+    PDE1dOptions opts;
+    opts.setVectorizedAuto();
+    PDE1dImpl impl(pde, opts);
+    CHECK(!opts.isVectorized());
+  }
+
+  // an explicit setting skips the probe
+  {
+    VecDefn pde(VecDefn::FirstColumn);
+    PDE1dOptions opts;
+    opts.setVectorized(false);
+    PDE1dImpl impl(pde, opts);
+    CHECK(pde.numVecCalls == 0);
+  }
+  return testResult();
+}